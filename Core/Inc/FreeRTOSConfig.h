@@ -50,6 +50,18 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
   #include <stdint.h>
   extern uint32_t SystemCoreClock;
+  void PreSleepProcessing(uint32_t ulExpectedIdleTime);
+  void PostSleepProcessing(uint32_t ulExpectedIdleTime);
+/* USER CODE BEGIN 0 */
+  extern void configureTimerForRunTimeStats(void);
+  extern unsigned long getRunTimeCounterValue(void);
+  extern void cpu_stats_switched_in(unsigned int number);
+  extern void power_ticks_skipped(uint32_t ticks);
+  #include "trace.h"
+#ifdef HOST_SIM
+  extern void sim_assert_failed(const char *file, int line);
+#endif
+/* USER CODE END 0 */
 #endif
 #ifndef CMSIS_device_header
 #define CMSIS_device_header "stm32f1xx.h"
@@ -64,15 +76,17 @@
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
 #define configMAX_PRIORITIES                     ( 56 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
-#define configTOTAL_HEAP_SIZE                    ((size_t)10240)
+#define configTOTAL_HEAP_SIZE                    ((size_t)1024)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
-#define configQUEUE_REGISTRY_SIZE                8
+#define configQUEUE_REGISTRY_SIZE                16
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configUSE_COUNTING_SEMAPHORES            1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_TICKLESS_IDLE                  1
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                    0
@@ -80,9 +94,9 @@
 
 /* Software timer definitions. */
 #define configUSE_TIMERS                         1
-#define configTIMER_TASK_PRIORITY                ( 2 )
+#define configTIMER_TASK_PRIORITY                ( 25 )
 #define configTIMER_QUEUE_LENGTH                 10
-#define configTIMER_TASK_STACK_DEPTH             256
+#define configTIMER_TASK_STACK_DEPTH             128
 
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
@@ -134,7 +148,11 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 /* Normal assert() semantics without relying on the provision of an assert.h
 header file. */
 /* USER CODE BEGIN 1 */
+#ifdef HOST_SIM
+#define configASSERT( x ) if ((x) == 0) {sim_assert_failed(__FILE__, __LINE__);}
+#else
 #define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); for( ;; );}
+#endif
 /* USER CODE END 1 */
 
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
@@ -146,8 +164,51 @@ standard names. */
 
 #define USE_CUSTOM_SYSTICK_HANDLER_IMPLEMENTATION 0
 
+/* USER CODE BEGIN 2 */
+/* Definitions needed when configGENERATE_RUN_TIME_STATS is on */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS configureTimerForRunTimeStats
+#define portGET_RUN_TIME_COUNTER_VALUE getRunTimeCounterValue
+/* USER CODE END 2 */
+
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+// 任务切入计数（见cpu_stats.c），该宏只在tasks.c中展开，pxCurrentTCB在那里可见
+#if TRACE_ENABLE
+// 事件跟踪（见trace.c）：队列类宏只在queue.c中展开，Queue_t的成员在那里可见
+#define traceTASK_SWITCHED_IN()                                          \
+    do {                                                                 \
+        cpu_stats_switched_in(pxCurrentTCB->uxTCBNumber);                \
+        trace_event(TRACE_EV_TASK_IN, pxCurrentTCB->uxTCBNumber, 0);     \
+    } while (0)
+#define traceTASK_SWITCHED_OUT() trace_event(TRACE_EV_TASK_OUT, pxCurrentTCB->uxTCBNumber, 0)
+#define traceQUEUE_CREATE(q) ((q)->uxQueueNumber = trace_queue_created((q), (q)->ucQueueType))
+#define traceQUEUE_SEND(q) trace_event(TRACE_EV_SEND, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(q) trace_event(TRACE_EV_SEND_ISR, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE(q) trace_event(TRACE_EV_RECV, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(q) trace_event(TRACE_EV_RECV_ISR, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceBLOCKING_ON_QUEUE_SEND(q) trace_event(TRACE_EV_BLOCK_SEND, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(q) trace_event(TRACE_EV_BLOCK_RECV, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FAILED(q) trace_event(TRACE_EV_FAIL, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FAILED(q) trace_event(TRACE_EV_FAIL, (q)->uxQueueNumber, (q)->uxMessagesWaiting)
+#else
+#define traceTASK_SWITCHED_IN() cpu_stats_switched_in(pxCurrentTCB->uxTCBNumber)
+#endif
+// 无节拍空闲醒来后被跳过的节拍数（见power.c）
+#define traceINCREASE_TICK_COUNT(x) power_ticks_skipped(x)
+// 栈水位监视需要取得IDLE与定时器服务任务的句柄（见stack_mon.c）
+#define INCLUDE_xTaskGetIdleTaskHandle           1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle   1
+// 主机仿真构建（HOST_SIM）：POSIX移植不支持无节拍空闲，改由空闲钩子让出主机CPU（见HostSim/Src/sim_core.c）
+#ifdef HOST_SIM
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                  0
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK                      1
+#endif
+#if configUSE_TICKLESS_IDLE == 1
+#define configPRE_SLEEP_PROCESSING                        PreSleepProcessing
+#define configPOST_SLEEP_PROCESSING                       PostSleepProcessing
+#endif /* configUSE_TICKLESS_IDLE == 1 */
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
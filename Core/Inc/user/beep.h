@@ -16,7 +16,6 @@ typedef enum
 }BEEP_Control_MOD;
 
 
-void StartBeepWorkTaskFunction(void *argument);
 
 #endif
 
@@ -0,0 +1,38 @@
+#ifndef __BENCH_H
+#define __BENCH_H
+
+// 每个测量项默认的测量次数（BENCH_CASE.runs为0时），也是单项测量次数的上限
+#define BENCH_RUNS 32
+
+// BENCH_CASE.flags
+#define BENCH_F_IRQ_OFF 0x01 //!< 每次测量在临界区内执行（任务切换与优先级不高于5的中断不会计入）
+#define BENCH_F_ATOMIC  0x02 //!< setup、全部测量与teardown在同一个临界区内执行（借用中断状态的测量项）
+
+/**
+ * @brief  一个微基准测量项
+ * @note   setup/teardown在整组测量前后各调用一次，prepare在每次测量前调用，三者都不计时；
+ *         带BENCH_F_ATOMIC的测量项中这三个函数与run都不能调用会阻塞的接口。
+ */
+typedef struct {
+    const char *name;           //!< BENCH命令中的名称（不区分大小写）
+    int (*setup)(void);         //!< 返回非0表示当前不能测量（打印busy），此时不调用teardown；可为NULL
+    void (*prepare)(void);      //!< 每次测量前恢复被测代码的输入状态；可为NULL
+    void (*run)(void);          //!< 被测代码
+    void (*teardown)(void);     //!< 可为NULL
+    unsigned char runs;         //!< 测量次数，0表示BENCH_RUNS
+    unsigned char flags;
+} BENCH_CASE;
+
+/**
+ * @brief  一个测量项的结果（CPU周期，已扣除读周期计数器的开销）
+ */
+typedef struct {
+    unsigned int runs;
+    unsigned int min, med, max;
+} BENCH_RESULT;
+
+const BENCH_CASE *bench_find(const char *name);
+int bench_measure(const BENCH_CASE *c, BENCH_RESULT *r);
+void bench_command(const char *arg);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __BOOT_H
+#define __BOOT_H
+
+/**
+ * @brief  启动阶段
+ * @note   BOOT_RESET~BOOT_SCHED是串行的里程碑（前一个结束即后一个开始），在main与MX_FREERTOS_Init中标记；
+ *         之后是调度器启动后由各任务并行执行的阶段，依赖关系见boot.c中的boot_deps
+ */
+typedef enum {
+    BOOT_RESET = 0, //!< 复位向量（SystemInit清零DWT周期计数器，时间原点）
+    BOOT_MAIN,      //!< 启动代码：复制.data/.ramfunc、清零.bss，进入main
+    BOOT_CLOCK,     //!< HAL_Init与SystemClock_Config（此前运行在HSI 8MHz）
+    BOOT_PERIPH,    //!< MX_xxx_Init外设初始化
+    BOOT_RTOS,      //!< osKernelInitialize与MX_FREERTOS_Init（创建内核对象与任务）
+    BOOT_SCHED,     //!< osKernelStart到第一个并行阶段开始
+    BOOT_REMOTE,    //!< 红外接收初始化（定时器服务任务）
+    BOOT_CMD,       //!< 指令处理任务发布上电默认的LED/蜂鸣器分区
+    BOOT_ROBOT,     //!< 控制任务发布机械臂分区并启动控制周期
+    BOOT_LCD,       //!< LCD控制器初始化与清屏（LCD任务）
+    BOOT_FRAME,     //!< LCD第一帧画完
+    BOOT_NUM
+} BOOT_STAGE;
+
+#define BOOT_BIT(stage) (1U << (stage))
+
+void boot_start(void);
+void boot_mark(BOOT_STAGE stage);
+void boot_init(void);
+void boot_begin(BOOT_STAGE stage);
+void boot_end(BOOT_STAGE stage);
+void boot_report(void);
+
+#endif
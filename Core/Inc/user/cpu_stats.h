@@ -0,0 +1,46 @@
+#ifndef __CPU_STATS_H
+#define __CPU_STATS_H
+
+// 统计的最大任务数（按FreeRTOS任务编号索引，编号从1开始，含IDLE与定时器服务任务）
+#define CPU_STATS_MAX_TASKS 16
+// 统计窗口（ms）：每个窗口结束时由软件定时器采样一次，STATS命令与LCD统计页显示最近一个完整窗口
+#define CPU_STATS_WINDOW_MS 1000
+// 运行时间计数器 = DWT周期计数扩展到64位后右移CPU_STATS_SHIFT位
+// 72MHz下为1.125MHz（分辨率约0.9us），32位计数约63分钟回绕；窗口内按差值计算，不受回绕影响
+#define CPU_STATS_SHIFT     6
+
+/**
+ * @brief  单个任务在一个统计窗口内的数据
+ */
+typedef struct {
+    char name[16];               //!< 任务名（configMAX_TASK_NAME_LEN）
+    unsigned char number;        //!< FreeRTOS任务编号
+    unsigned char state;         //!< 状态字符：X运行 R就绪 B阻塞 S挂起 D删除
+    unsigned char prio;          //!< 当前优先级
+    unsigned short permille;     //!< 窗口内CPU占用（0.1%）
+    unsigned short stack_free;   //!< 栈历史最低剩余（字）
+    unsigned int switches;       //!< 窗口内被切入次数
+    unsigned int switches_total; //!< 累计被切入次数
+} CPU_STATS_TASK;
+
+/**
+ * @brief  一个统计窗口的全部数据
+ */
+typedef struct {
+    unsigned int seq;             //!< 窗口序号（0表示还没有完整窗口）
+    unsigned int window_us;       //!< 窗口实际长度（us）
+    unsigned int switches;        //!< 窗口内任务切换总数
+    unsigned short busy_permille; //!< 窗口内CPU占用（除IDLE外，0.1%）
+    unsigned char num;            //!< 有效任务数
+    CPU_STATS_TASK task[CPU_STATS_MAX_TASKS];
+} CPU_STATS_VIEW;
+
+void cpu_stats_init(void);
+void cpu_stats_switched_in(unsigned int number);
+void cpu_stats_add_sleep(unsigned int cycles);
+unsigned int cpu_stats_cycles(void);
+void cpu_stats_get(CPU_STATS_VIEW *dst);
+void cpu_stats_report(void);
+void cpu_stats_heap_report(void);
+
+#endif
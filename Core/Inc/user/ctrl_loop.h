@@ -0,0 +1,37 @@
+#ifndef __CTRL_LOOP_H
+#define __CTRL_LOOP_H
+
+// 控制周期频率范围与上电默认值（Hz），CTRL_RATE命令可在范围内修改
+#define CTRL_LOOP_HZ_MIN     500
+#define CTRL_LOOP_HZ_MAX     5000
+#define CTRL_LOOP_HZ_DEFAULT 1000
+// 单个周期的执行时间预算（周期的百分比），即周期监视的截止期限，超出计入over
+#define CTRL_LOOP_BUDGET_PCT 50
+// 释放控制周期的线程标志（控制任务自己的低位事件，分区发布事件SYS_EVT从第8位开始）
+#define CTRL_LOOP_EVT        0x01U
+// TIM7计数频率（Hz）：72MHz经72分频，ARR = 1MHz / 控制频率 - 1
+#define CTRL_LOOP_TIM_HZ     1000000U
+
+/**
+ * @brief  控制周期的释放统计（时间单位为DWT周期，打印时换算为us）
+ * @note   lat : 定时器更新中断打时间戳到控制任务开始本周期的延迟（释放延迟）
+ *         miss: 释放时上一周期还没有结束、或多次释放被合并成一次的周期数
+ *         抖动、执行时间与超预算（over）由周期监视统计（period_mon，名称robot）
+ */
+typedef struct {
+    unsigned int cycles;
+    unsigned int miss;
+    unsigned int lat_min, lat_max;
+    unsigned long long lat_sum;
+} CTRL_LOOP_STAT;
+
+void ctrl_loop_init(void);
+void ctrl_loop_start(void);
+void ctrl_loop_stop(void);
+void ctrl_loop_wait(void);
+unsigned int ctrl_loop_hz(void);
+int ctrl_loop_set_rate(unsigned int hz);
+void ctrl_loop_isr(void);
+void ctrl_loop_report(void);
+
+#endif
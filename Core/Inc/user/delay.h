@@ -4,7 +4,7 @@
  * @author      ԭŶ(ALIENTEK)
  * @version     V1.0
  * @date        2020-04-17
- * @brief       ʹSysTickͨģʽӳٽй(֧ucosii)
+ * @brief       usʱ׼ʱ(TIM5+TIM132λɼ)
  *              ṩdelay_initʼ delay_usdelay_msʱ
  * @license     Copyright (c) 2020-2032, ӿƼ޹˾
  ****************************************************************************************************
@@ -19,6 +19,8 @@
  * ޸˵
  * V1.0 20211103
  * һη
+ * V1.1 20261019
+ * ʹSysTick(FreeRTOSֲ), TIM5+TIM1ʱ; ʱȴȽж, ʱ
  *
  ****************************************************************************************************
  */
@@ -32,42 +34,14 @@
 #include "usart.h"
 #include "gpio.h"
 
+/* Ϊ0ʱʱæ(Ķ֮ǰΪ), ±DELAYԱCPUռ */
+#define DELAY_BLOCK_ENABLE  1
 
-void delay_init(uint16_t sysclk);       /* ʼӳٺ */
+void delay_init(void);                  /* usʱ׼ */
+uint32_t delay_now_us(void);            /* ȡusʱ׼(32λ, Լ71ӻ) */
 void delay_ms(uint16_t nms);            /* ʱnms */
 void delay_us(uint32_t nus);            /* ʱnus */
+void HAL_Delay(uint32_t Delay);         /* HALʱHALڲõ */
+void delay_report(void);                /* DELAY */
 
-#if (!SYS_SUPPORT_OS)                   /* ֧OS */
-    void HAL_Delay(uint32_t Delay);     /* HALʱHALڲõ */
 #endif
-
-#endif
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -0,0 +1,67 @@
+#ifndef __JOURNAL_H
+#define __JOURNAL_H
+
+#include <stdint.h>
+
+// 保留的事件条数（2的幂），最新的JOURNAL_CAP条可由JOURNAL命令读出
+#define JOURNAL_CAP 128
+
+// 放在复位时不清零的RAM区（.noinit，链接脚本与分散加载文件中单独成段）；主机仿真构建中为普通静态变量
+#ifdef HOST_SIM
+#define NOINIT
+#elif defined(__CC_ARM)
+#define NOINIT __attribute__((section(".noinit"), zero_init))
+#else
+#define NOINIT __attribute__((section(".noinit")))
+#endif
+
+// 调用者的返回地址（JOURNAL_FAULT_HAL记录出错的调用位置）
+#if defined(__CC_ARM)
+#define JOURNAL_CALLER() ((uint32_t)__return_address())
+#else
+#define JOURNAL_CALLER() ((uint32_t)(uintptr_t)__builtin_return_address(0))
+#endif
+
+/**
+ * @brief  事件类型（JOURNAL_REC.type）与参数含义
+ */
+typedef enum {
+    JOURNAL_BOOT = 1, //!< 上电/复位：a=1表示之前的记录保留了下来，b=复位时的RCC->CSR
+    JOURNAL_MODE,     //!< 机械臂模式切换：a=新的Motor_Mod，b=原来的Motor_Mod
+    JOURNAL_CMD,      //!< 收到一条命令：a=长度，b=前4个字符
+    JOURNAL_FAULT,    //!< 故障：a=JOURNAL_FAULT_xxx，b=见各类故障
+    JOURNAL_DEADLINE, //!< 周期任务错过截止期限（第1、2、4、8……次）：a=登记序号（PERIODS命令中的行），b=响应时间（CPU周期）
+    JOURNAL_TYPE_NUM
+} JOURNAL_TYPE;
+
+/**
+ * @brief  JOURNAL_FAULT的种类（JOURNAL_REC.a）
+ */
+typedef enum {
+    JOURNAL_FAULT_HARD = 0, //!< HardFault，b=SCB->HFSR
+    JOURNAL_FAULT_MEM,      //!< MemManage，b=SCB->CFSR
+    JOURNAL_FAULT_BUS,      //!< BusFault，b=SCB->CFSR
+    JOURNAL_FAULT_USAGE,    //!< UsageFault，b=SCB->CFSR
+    JOURNAL_FAULT_HAL,      //!< Error_Handler，b=调用者的返回地址
+    JOURNAL_FAULT_UART_OVR, //!< 命令口接收环被覆盖，b=累计次数
+    JOURNAL_FAULT_CMD_DROP, //!< 命令队列满丢弃命令，b=累计次数
+    JOURNAL_FAULT_NUM
+} JOURNAL_FAULT_KIND;
+
+/**
+ * @brief  一条事件记录（12字节）
+ */
+typedef struct {
+    uint32_t t;    //!< 时刻（delay_now_us，本次启动以来的us，约71分钟回绕）
+    uint8_t type;  //!< JOURNAL_TYPE
+    uint8_t boot;  //!< 写入时的启动次数（低8位），区分不同次启动的记录
+    uint16_t a;
+    uint32_t b;
+} JOURNAL_REC;
+
+void journal_init(void);
+void journal_log(uint8_t type, uint16_t a, uint32_t b);
+void journal_report(void);
+void journal_clear(void);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __LATENCY_H
+#define __LATENCY_H
+
+// 端到端延迟测量开关：为0时所有探针展开为空，命令帧也不携带时间戳
+#define LAT_ENABLE     1
+// 直方图：每个2倍区间分为2^LAT_SUB_BITS个桶（分辨率约19%），小于2^(LAT_SUB_BITS+1)us的值每us一个桶
+#define LAT_SUB_BITS   2
+// 桶数：覆盖0~2^21us（约2s），更大的值计入最后一个桶（max仍为精确值）
+#define LAT_BUCKETS    80
+// 每条路径最多的阶段数（含起点）
+#define LAT_MAX_STAGES 5
+
+// 测量路径
+typedef enum {
+    LAT_PATH_CMD, //!< 串口1空闲中断 → 分帧 → 指令处理 → LED引脚
+    LAT_PATH_IR,  //!< 红外最后一次捕获 → 解码事件 → 读取键值 → 机械臂任务 → 启动PWM
+    LAT_PATH_NUM
+} LAT_PATH;
+
+// 命令路径各阶段（0为起点，不单独统计，其余阶段统计相对起点的累计延迟）
+enum {
+    LAT_CMD_IDLE_ISR, //!< uart_drv_irq检测到空闲中断
+    LAT_CMD_FRAMED,   //!< UART1_recv_Task完成分帧并送入命令队列
+    LAT_CMD_DEQUEUED, //!< LEDProcessedTas从命令队列取出
+    LAT_CMD_GPIO,     //!< led_apply写LED引脚（终点）
+    LAT_CMD_STAGES
+};
+
+// 红外路径各阶段
+enum {
+    LAT_IR_CAPTURE, //!< HAL_TIM_IC_CaptureCallback最后一次下降沿捕获
+    LAT_IR_NOTIFY,  //!< 溢出/重复码中断把解码事件挂到定时器服务任务
+    LAT_IR_DECODED, //!< beep_remote_event完成Read_remote_data并发布
+    LAT_IR_ROBOT,   //!< RobotmainContro取得红外快照
+    LAT_IR_PWM,     //!< Start_Robot_PWM_Function调用HAL_TIM_PWM_Start_IT之后（终点）
+    LAT_IR_STAGES
+};
+
+unsigned int lat_now(void);
+void lat_post(LAT_PATH path, unsigned int stage, unsigned int t0);
+int lat_take(LAT_PATH path, unsigned int stage, unsigned int *t0);
+void lat_record(LAT_PATH path, unsigned int stage, unsigned int t0);
+void lat_pass(LAT_PATH path, unsigned int stage, unsigned int next);
+void lat_reset(void);
+void lat_report(void);
+
+#if LAT_ENABLE
+// 在起点记录时刻，交给stage阶段的探针
+#define LAT_START(path, stage)      lat_post(path, stage, lat_now())
+// 把已有的起点t0交给stage阶段（起点随消息传递时使用）
+#define LAT_POST(path, stage, t0)   lat_post(path, stage, t0)
+// stage阶段已被交接时统计它，并把同一起点交给next阶段（next为0表示终点）
+#define LAT_PASS(path, stage, next) lat_pass(path, stage, next)
+// 丢弃交给stage阶段但本次不会到达的起点（事件在此路径上提前结束）
+#define LAT_CANCEL(path, stage)     ((void)lat_take(path, stage, &(unsigned int){0}))
+#else
+#define LAT_START(path, stage)
+#define LAT_POST(path, stage, t0)
+#define LAT_PASS(path, stage, next)
+#define LAT_CANCEL(path, stage)
+#endif
+
+#endif
@@ -36,6 +36,7 @@
 
 #include "main.h"
 #include "cmsis_os.h"
+#include "res_lock.h"
 #include "dma.h"
 #include "usart.h"
 #include "gpio.h"
@@ -103,6 +104,12 @@ typedef struct
 /* LCD */
 extern _lcd_dev lcddev; /* LCDҪ */
 
+/* LCD:κLCDǰȻȡ(res_lock_take),֤Ʋ,
+ * ȼ̳бȼסȼ;
+ * Ԥ㰴ˢ(Լ25ms),LOCKSover */
+#define LCD_LOCK_BUDGET_US  30000
+extern RES_LOCK lcd_lock;
+
 /* LCDĻɫͱɫ */
 extern uint32_t  g_point_color;     /* ĬϺɫ */
 extern uint32_t  g_back_color;      /* ɫ.ĬΪɫ */
@@ -147,6 +154,20 @@ typedef struct
 #define LCD_BASE        (uint32_t)((0X60000000 + (0X4000000 * (LCD_FSMC_NEX - 1))) | (((1 << LCD_FSMC_AX) * 2) -2))
 #define LCD             ((LCD_TypeDef *) LCD_BASE)
 
+/* LCDݿڶд: 湹(HOST_SIM)ûFSMC, ɷLCD(HostSim/Src/sim_lcd.c) */
+#ifdef HOST_SIM
+void sim_lcd_write_reg(uint16_t regno);
+void sim_lcd_write_ram(uint16_t data);
+uint16_t sim_lcd_read_ram(void);
+#define LCD_REG_WRITE(x)    sim_lcd_write_reg(x)
+#define LCD_RAM_WRITE(x)    sim_lcd_write_ram(x)
+#define LCD_RAM_READ()      sim_lcd_read_ram()
+#else
+#define LCD_REG_WRITE(x)    (LCD->LCD_REG = (x))
+#define LCD_RAM_WRITE(x)    (LCD->LCD_RAM = (x))
+#define LCD_RAM_READ()      (LCD->LCD_RAM)
+#endif
+
 /******************************************************************************************/
 /* LCDɨ跽ɫ  */
 
@@ -14,6 +14,4 @@ typedef enum {
     LED_OFF,
     LED_Artificial
 } LED_Conctrl_MOD;
-
-void StartLEDWorkTaskFunction(void *argument);
 #endif
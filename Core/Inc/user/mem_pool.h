@@ -0,0 +1,54 @@
+#ifndef __MEM_POOL_H
+#define __MEM_POOL_H
+
+#include "cmsis_os.h"
+#include "freertos_mpool.h"
+
+// 块大小向上取整到指针大小（空闲块中存放链表指针，同时保证块内结构体对齐）
+#define MEM_POOL_BLOCK_SIZE(size)        (((size) + sizeof(void *) - 1U) / sizeof(void *) * sizeof(void *))
+// 存储区需要的指针数（存储区定义为void *数组以获得指针对齐）
+#define MEM_POOL_WORDS(count, size)      ((count) * MEM_POOL_BLOCK_SIZE(size) / sizeof(void *))
+
+// 命令帧池：uart1_cmd_queue中的UART1_CMD_QUEUE_LEN条加上指令处理任务正在处理的1条
+#define CMD_POOL_LEN                     (UART1_CMD_QUEUE_LEN + 1)
+
+// POOL_BENCH：每项测量的轮数、堆中制造的空洞数、测试块大小（字节）
+#define MEM_POOL_BENCH_ROUNDS            64
+#define MEM_POOL_BENCH_HOLES             8
+#define MEM_POOL_BENCH_SIZE              32
+
+/**
+ * @brief  单个内存池的使用统计
+ */
+typedef struct {
+    volatile unsigned int alloc;  //!< 累计成功分配次数
+    volatile unsigned int fail;   //!< 分配失败次数（池空且等待超时）
+    volatile unsigned short used; //!< 当前占用块数
+    volatile unsigned short peak; //!< 上电以来的最大占用块数
+} MEM_POOL_STAT;
+
+/**
+ * @brief  固定块内存池（CMSIS-RTOS2 osMemoryPool + 统计）
+ * @note   分配/释放是空闲链表的头部摘取/插入，加上一次计数信号量操作，耗时与池大小、使用历史无关；
+ *         池空时任务可限时等待其他任务释放，中断中只能不等待（timeout必须为0）。
+ *         控制块与存储区都在mem_pool.c中静态定义，由mem_pool_init在其上创建，不占用FreeRTOS堆
+ */
+typedef struct {
+    const char *name;
+    void *mem;            //!< 块存储区（MEM_POOL_WORDS个指针）
+    unsigned short count; //!< 块数
+    unsigned short size;  //!< 块大小（字节，已按MEM_POOL_BLOCK_SIZE取整）
+    osMemoryPoolId_t id;
+    StaticMemPool_t cb;   //!< osMemoryPool控制块（含计数信号量）
+    MEM_POOL_STAT stat;
+} MEM_POOL;
+
+extern MEM_POOL cmd_pool;
+
+void mem_pool_init(MEM_POOL *pool);
+void *mem_pool_alloc(MEM_POOL *pool, unsigned int timeout);
+int mem_pool_free(MEM_POOL *pool, void *block);
+void mem_pool_report(void);
+void mem_pool_bench(void);
+
+#endif
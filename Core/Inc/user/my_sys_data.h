@@ -20,15 +20,66 @@ typedef struct
 
 /**
  * @brief  系统核心数据聚合结构体
- * @warning 多任务共享数据需进行操作保护和上锁
+ * @note   静态存放于freertos.c（sys_use_data），按所有者分区：
+ *         每个分区只允许其所有者任务写入（软件定时器回调的所有者是定时器服务任务），
+ *         所有者修改完成后调用sys_publish发布快照；
+ *         其他任务不直接读取这里的字段，而是用sys_snapshot取得一致的副本
+ * @warning 非所有者禁止直接读写本结构体中的字段
  */
 typedef struct {
-    ROBOT_USE_TYPE Robot_use_data;   // 机器人机械臂使用数据结构
-    TIME_USE_DATA Time_use_data;     // 时间管理系统（RTC模拟层）
-    USART_USE_DATA usart_use_data;   // 通信数据管理系统
-    LED_USE_DATA led_control_num;    // led控制参数
-    BEEP_USE_DATA Beep_control;      // 蜂鸣器控制数据结构
-    REMOTE_USE_DATA Remote_use_data; // 红外遥控器数据结构
+    ROBOT_USE_TYPE Robot_use_data;   // 机器人机械臂使用数据结构（所有者：RobotmainContro）
+    TIME_USE_DATA Time_use_data;     // 时间管理系统（由硬件秒节拍推算）（所有者：定时器服务任务，time_srv.c）
+    USART_USE_DATA usart_use_data;   // 通信数据管理系统（所有者：UART1_recv_Task）
+    LED_USE_DATA led_control_num;    // led控制参数（所有者：LEDProcessedTas）
+    BEEP_USE_DATA Beep_control;      // 蜂鸣器控制数据结构（所有者：LEDProcessedTas）
+    REMOTE_USE_DATA Remote_use_data; // 红外遥控器数据结构（所有者：定时器服务任务，beep_init）
 } SYS_USE_DATA;
 
+#ifdef HOST_SIM
+// 主机仿真的快照并发读写测试分区（HostSim/Src/sim_seqlock.c），固件中没有：
+// 一次发布的所有字都等于同一个序号，读者据此检查快照是否混合了两次发布
+#define SYS_SIM_WORDS 4096
+typedef struct {
+    unsigned int word[SYS_SIM_WORDS];
+} SYS_SIM_DATA;
+#endif
+
+// 系统数据分区编号（与SYS_USE_DATA中的成员一一对应，SYS_PART_SIM除外）
+typedef enum {
+    SYS_PART_ROBOT,
+    SYS_PART_TIME,
+    SYS_PART_UART,
+    SYS_PART_LED,
+    SYS_PART_BEEP,
+    SYS_PART_REMOTE,
+#ifdef HOST_SIM
+    SYS_PART_SIM,
+#endif
+    SYS_PART_NUM
+} SYS_PART_ID;
+
+// 分区发布事件（任务线程标志）：订阅者在分区每次发布后收到对应位
+// 从第8位开始，低位留给各任务自己的事件（遥测速率变更0x01等）
+#define SYS_EVT(id)     (1UL << (8 + (id)))
+// 每个分区最多的订阅任务数
+#define SYS_SUB_MAX     2
+
+// 事件等待统计编号（每个由轮询改为事件驱动的任务一个）
+typedef enum {
+    SYS_WAKE_ROBOT,
+    SYS_WAKE_NUM
+} SYS_WAKE_ID;
+
+// 定时器服务任务中的分区订阅回调（见sys_subscribe_timer）
+typedef void (*SYS_TIMER_CB)(void);
+
+void sys_publish(SYS_PART_ID id, const void *src);
+void sys_snapshot(SYS_PART_ID id, void *dst);
+unsigned int sys_part_version(SYS_PART_ID id);
+unsigned int sys_part_retries(SYS_PART_ID id);
+void sys_subscribe(SYS_PART_ID id);
+void sys_subscribe_timer(SYS_PART_ID id, SYS_TIMER_CB cb);
+unsigned int sys_wait(SYS_WAKE_ID who, unsigned int flags, unsigned int timeout);
+void sys_wake_report(void);
+
 #endif
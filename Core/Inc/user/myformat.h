@@ -0,0 +1,28 @@
+#ifndef __MYFORMAT_H
+#define __MYFORMAT_H
+
+#include "stdarg.h"
+
+// 置1时my_vsnprintf直接转发到C库的vsnprintf（newlib/glibc），只用于对比基线：
+// 两种构建分别运行BENCH fmt / BENCH uart_printf（周期）、STACK（栈水位），并比较map文件中的flash占用
+#ifndef MYFORMAT_LIBC
+#define MYFORMAT_LIBC 0
+#endif
+
+// 编译期格式串检查（AC6/GCC均支持format属性）
+#if defined(__GNUC__) || defined(__ARMCC_VERSION)
+#define MY_FORMAT_CHECK(fmt_idx, arg_idx) __attribute__((format(printf, fmt_idx, arg_idx)))
+#else
+#define MY_FORMAT_CHECK(fmt_idx, arg_idx)
+#endif
+
+/**
+ * 轻量级整数格式化（替代newlib的vsprintf/sprintf）
+ * 支持：%d %i %u %x %X %c %s %%，宽度、'0'补零、'-'左对齐，'l'长度修饰符（Cortex-M3上与int等宽）
+ * 不支持浮点；输出总是以'\0'结尾且不超过size-1个字符，返回实际写入的字符数
+ */
+int my_vsnprintf(char *buf, unsigned int size, const char *format, va_list ap);
+int my_snprintf(char *buf, unsigned int size, const char *format, ...) MY_FORMAT_CHECK(3, 4);
+unsigned int my_atou(const char *str);
+
+#endif
@@ -1,21 +1,53 @@
 #ifndef _MYPRINTF_H
 #define _MYPRINTF_H
 
+#include "myformat.h"
+#include "latency.h"
+
 // 注意这里定义的数据发送和接受长度一定要足够！例如LED_AUTO就需要8*8=64！
+// 单条命令最大长度（含结尾符），超出部分截断并计入cmd_trunc
 #define UART1_DMA_RX_LEN 70
+// 命令队列深度（UART1_recv_Task → LEDProcessedTas），需与freertos.c中uart1_cmd_queue一致
+#define UART1_CMD_QUEUE_LEN 16
+// 命令入队最长等待时间（ms），超过则丢弃并计入cmd_drop
+#define UART1_CMD_PUT_TIMEOUT 5
+// 流控窗口：上位机未收到应答的命令数上限（每条命令恰好应答一行，收到应答即返还一个信用）
+#define UART1_FLOW_WINDOW UART1_CMD_QUEUE_LEN
 
 /**
  * @brief  UART通信数据管理结构体
  * @note   DMA接收数据生命周期管理：
- *         [接收] → Read_data → [处理] → Last_Read_data/LED_Read_data
+ *         [接收] → 按'\r'/'\n'或空闲中断分帧 → uart1_cmd_queue → [处理]
+ *         Read_data保存最近一条完整命令，由接收任务发布快照（SYS_PART_UART）供LCD显示
  */
 typedef struct {
-    char Read_data[UART1_DMA_RX_LEN];          //!< 当前接收缓冲区（只有当新数据来的时候才会自动清零）
-    char Last_Read_data[UART1_DMA_RX_LEN];     //!< 历史数据缓存（用于对比变更，这里的数据可以理解为长久数据，知道下一次新数据覆盖）
-    char Response_Read_data[UART1_DMA_RX_LEN]; //!< 送给处理函数使用的变量（每次处理函数使用完成将会自动清空！）
+    char Read_data[UART1_DMA_RX_LEN]; //!< 最近一条完整命令（每收到新命令时覆盖）
 } USART_USE_DATA;
 
-void myprintf(char *format, ...);
+/**
+ * @brief  命令帧（从cmd_pool分配，uart1_cmd_queue中传递其指针）
+ * @note   data始终以'\0'结尾，len不含结尾符；指令处理任务处理完毕后释放回cmd_pool
+ */
+typedef struct {
+    unsigned char len;
+    char data[UART1_DMA_RX_LEN];
+#if LAT_ENABLE
+    unsigned int t_rx; //!< 本帧所在突发传输的空闲中断时刻（lat_now），命令路径延迟的起点
+#endif
+} UART_CMD_FRAME;
+
+/**
+ * @brief  命令流控统计（FLOW命令输出，收发字节/覆盖/错误计数见uart1_drv.stat）
+ */
+typedef struct {
+    volatile unsigned int cmd_drop;   //!< 命令帧池/命令队列满丢弃的命令数
+    volatile unsigned int cmd_trunc;  //!< 超长被截断的命令数
+} UART1_FLOW_STAT;
+
+extern UART1_FLOW_STAT uart1_flow_stat;
+
+void myprintf(const char *format, ...) MY_FORMAT_CHECK(1, 2);
+void uart1_flow_report(void);
 void StartUART1_recv_TaskFunction(void *argument);
 
 #endif
@@ -4,8 +4,10 @@
 #include "my_sys_data.h"
 
 void StartLEDProcessedTaskFunction(void *argument);
-void StartLEDWorkTaskFunction(void *argument);
 void StartLCDDisplayTaskFunction(void *argument);
-void StartTimeSetTaskFunction(void *argument);
+// 软件定时器驱动的模块（回调都在定时器服务任务中执行），在MX_FREERTOS_Init中初始化
+void led_init(void);
+void beep_init(SYS_USE_DATA *SYS);
+void time_init(SYS_USE_DATA *SYS);
 
 #endif
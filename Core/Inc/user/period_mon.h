@@ -0,0 +1,45 @@
+#ifndef __PERIOD_MON_H
+#define __PERIOD_MON_H
+
+// 可登记的最多周期任务数（PERIODS命令与LCD周期页按登记顺序显示）
+#define PERIOD_MON_MAX 8
+
+/**
+ * @brief  周期任务的截止期限/抖动监视（时间单位为CPU周期，打印时换算为us）
+ * @note   每个周期开头调用period_mon_begin、结束时调用period_mon_end，两者都只做几次加减比较，
+ *         不关中断、不除法；统计字段只由该周期任务自己写，读者（PERIODS命令、LCD）容忍读到更新一半的统计。
+ *         释放时刻按上一周期开始时刻 + 标称周期推算：
+ *         jit  : 相邻两个周期开始时刻的间隔与标称周期之差的绝对值
+ *         drift: 上述差值的累计（正值表示比标称周期慢），自动重装的定时器应在0附近
+ *         exec : 本周期从begin到end的执行时间
+ *         resp : 推算的释放时刻到end的响应时间（晚开始的部分 + 执行时间），超过deadline计入miss
+ */
+typedef struct {
+    const char *name;
+    unsigned char id;           //!< 登记序号（PERIODS命令中的行，事件日志中标识该任务）
+    unsigned int period_us;     //!< 标称周期
+    unsigned int deadline_us;   //!< 相对释放时刻的截止期限
+    unsigned int period_cyc;    //!< 同上，换算为CPU周期（热路径不做除法）
+    unsigned int deadline_cyc;
+    unsigned int t_start;       //!< 本周期开始时刻（cpu_stats_cycles）
+    unsigned int t_prev;        //!< 上一周期开始时刻，0表示下一个周期不统计抖动
+    unsigned int late;          //!< 本周期相对推算释放时刻晚开始的时间
+    unsigned int n;             //!< 已结束的周期数
+    unsigned int miss;          //!< 响应时间超过截止期限的周期数
+    unsigned int jit_max;
+    long long drift;
+    unsigned int exec_min, exec_max;
+    unsigned long long exec_sum;
+    unsigned int resp_max;
+} PERIOD_MON;
+
+void period_mon_init(PERIOD_MON *m, const char *name, unsigned int period_us, unsigned int deadline_us);
+void period_mon_set(PERIOD_MON *m, unsigned int period_us, unsigned int deadline_us);
+void period_mon_restart(PERIOD_MON *m);
+void period_mon_begin(PERIOD_MON *m);
+void period_mon_end(PERIOD_MON *m);
+const PERIOD_MON *period_mon_get(unsigned int i);
+unsigned int period_mon_cyc_to_us(unsigned int cyc);
+void period_mon_report(void);
+
+#endif
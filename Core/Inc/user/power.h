@@ -0,0 +1,33 @@
+#ifndef __POWER_H
+#define __POWER_H
+
+#include "stdint.h"
+
+// 睡眠唤醒原因（按唤醒时挂起的中断分类）
+typedef enum {
+    POWER_WAKE_TICK,  //!< 预计的空闲时间到期（SysTick）
+    POWER_WAKE_UART1, //!< USART1
+    POWER_WAKE_UART2, //!< USART2
+    POWER_WAKE_DMA,   //!< DMA1通道（串口收发）
+    POWER_WAKE_IR,    //!< TIM4红外解码
+    POWER_WAKE_PWM,   //!< TIM8机械臂PWM
+    POWER_WAKE_OTHER, //!< 其他中断
+    POWER_WAKE_NUM
+} POWER_WAKE_ID;
+
+/**
+ * @brief  无节拍空闲统计
+ */
+typedef struct {
+    unsigned int sleeps;               //!< 进入睡眠次数
+    unsigned long long sleep_cycles;   //!< 累计睡眠时长（CPU周期）
+    unsigned int ticks_avoided;        //!< 被跳过的节拍中断数
+    unsigned int wake[POWER_WAKE_NUM]; //!< 各唤醒原因次数
+} POWER_STAT;
+
+void PreSleepProcessing(uint32_t ulExpectedIdleTime);
+void PostSleepProcessing(uint32_t ulExpectedIdleTime);
+void power_ticks_skipped(uint32_t ticks);
+void power_report(void);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __RAMFUNC_H
+#define __RAMFUNC_H
+
+// 1: RAMFUNC标记的函数链接到SRAM执行（.ramfunc段，启动时随.data从Flash复制），0: 全部留在Flash
+// 改为0重新编译后再用RAMFUNC命令测一次，就是放入SRAM之前的周期数
+#define RAMFUNC_ENABLE     1
+
+/**
+ * @brief  把函数放到SRAM执行，写在函数定义的返回类型之前
+ * @note   72MHz下Flash有2个等待周期，预取缓冲只能掩盖顺序取指，跳转和文字池读取仍要等待；
+ *         SRAM取指没有等待周期，但与数据访问共用系统总线。只标记热点函数（收益尚未在目标板上实测，见ramfunc.c）：
+ *         GCC链接脚本（stm32f103zetx_flash.ld）和Keil分散加载文件（MDK-ARM/FreeRTOSSTM32ZET6.sct）都把.ramfunc放进RAM，
+ *         与Flash之间的调用由链接器自动加长跳转桩。
+ *         主机仿真构建（HOST_SIM）中为空。
+ */
+#if RAMFUNC_ENABLE && !defined(HOST_SIM)
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+void ramfunc_report(void);
+
+#endif
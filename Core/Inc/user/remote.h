@@ -32,6 +32,7 @@
 #include "usart.h"
 #include "gpio.h"
 #include "fsmc.h"
+#include "bench.h"
 
 /******************************************************************************************/
 /* żʱ  */
@@ -70,7 +71,9 @@ typedef struct
     unsigned char old_remote_cnt; /* ͳƵһεİµĴ */
 } REMOTE_USE_DATA;
 
-void remote_init(void); /* ⴫ͷųʼ */
+void remote_init(void (*handler)(void)); /* ⴫ͷųʼ¼ڶʱлصhandler */
 uint8_t remote_scan(void);
 void Read_remote_data(REMOTE_USE_DATA *data);
+extern const BENCH_CASE remote_bench_capture; /* 벶صִʱ䣨BENCH */
+extern const BENCH_CASE remote_bench_scan;    /* ִʱ䣨BENCH */
 #endif
@@ -0,0 +1,37 @@
+#ifndef __RES_LOCK_H
+#define __RES_LOCK_H
+
+#include "cmsis_os.h"
+
+// 可登记的最多锁数（LOCKS命令按登记顺序打印）
+#define RES_LOCK_MAX 8
+
+/**
+ * @brief  共享外设锁（优先级继承互斥量 + 争用统计）
+ * @note   持有者被更高优先级的等待者阻塞时临时继承其优先级，中等优先级任务不能再插进来拖长等待，
+ *         等待时间只取决于持有时间；持有时间由各锁的预算约束（超过计入over，LOCKS命令可查）。
+ *         只能在任务中使用（互斥量不能在中断中获取/释放），可以嵌套获取不同的锁，但不能重复获取同一把锁。
+ *         统计字段除timeouts外都只由持有者修改，不需要额外保护
+ */
+typedef struct {
+    const char *name;
+    osMutexId_t id;
+    StaticSemaphore_t cb;          //!< 互斥量控制块（静态分配，不占用FreeRTOS堆）
+    unsigned int budget_us;        //!< 持有时间预算（us），0表示不检查
+    osThreadId_t owner;            //!< 当前持有者，NULL表示空闲
+    unsigned int t_take;           //!< 取得锁的时刻（cpu_stats_cycles）
+    unsigned int takes;            //!< 成功获取次数
+    unsigned int waits;            //!< 获取时锁已被占用、需要等待的次数
+    volatile unsigned int timeouts; //!< 等待超时次数
+    unsigned int over;             //!< 持有时间超过预算的次数
+    unsigned int wait_max_us;      //!< 最长等待时间
+    unsigned int hold_max_us;      //!< 最长持有时间
+    const char *hold_max_task;     //!< 最长持有时间对应的任务名
+} RES_LOCK;
+
+void res_lock_init(RES_LOCK *lock, const char *name, unsigned int budget_us);
+int res_lock_take(RES_LOCK *lock, unsigned int timeout);
+void res_lock_give(RES_LOCK *lock);
+void res_lock_report(void);
+
+#endif
@@ -1,6 +1,11 @@
 #ifndef __ROBOT_H
 #define __ROBOT_H
 
+#include "bench.h"
+
+// 底盘P引脚脉冲的低/高电平宽度（ms），按控制周期计数输出
+#define Car_Pulse_half_ms 10
+
 // 电机状态参数
 typedef enum {
     Robot_Motor_Ready,
@@ -57,4 +62,7 @@ typedef struct
     CAR_MOVE_USE_DATA Car_Motor; // 小车的4个电机都通过这一个信号量来控制
 } ROBOT_USE_TYPE;
 
+// PWM脉冲完成回调的执行时间（BENCH命令，robot.c）
+extern const BENCH_CASE robot_bench_pwm_cb;
+
 #endif
@@ -0,0 +1,25 @@
+#ifndef __STACK_MON_H
+#define __STACK_MON_H
+
+#include "cmsis_os.h"
+
+// 监视的最大任务数（含IDLE与定时器服务任务）
+#define STACK_MON_MAX_TASKS   16
+// 采样周期（ms），在defauleTask中执行
+#define STACK_MON_PERIOD_MS   1000
+// 默认浸泡时长（s）：到期后自动打印一次建议栈大小，STACK_SOAK命令可重新设定
+#define STACK_MON_SOAK_S      600
+// 栈使用率告警阈值（%），峰值每创新高且超过阈值时告警一次
+#define STACK_MON_WARN_PCT    80
+// 建议栈大小 = 峰值 * (100 + STACK_MON_MARGIN_PCT) / 100 + STACK_MON_GUARD_WORDS，再向上取整到8字
+#define STACK_MON_MARGIN_PCT  25
+#define STACK_MON_GUARD_WORDS 16
+// 主动上报行的前缀（不是命令应答，uart_stream.py不计入信用）
+#define STACK_MON_ASYNC       "!"
+
+void stack_mon_add(osThreadId_t thread, unsigned int stack_bytes);
+void stack_mon_sample(void);
+void stack_mon_soak(unsigned int seconds);
+void stack_mon_report(const char *prefix);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+// 遥测采样频率范围（Hz），0表示关闭
+#define TELEMETRY_MIN_HZ     1
+#define TELEMETRY_MAX_HZ     200
+#define TELEMETRY_DEFAULT_HZ 0
+// 每隔多少毫秒强制发送一次完整快照（关键帧），便于上位机中途接入或丢帧后重新同步
+#define TELEMETRY_KEYFRAME_MS 1000
+// 遥测输出端口（uart_drv.h中的驱动实例），默认USART2(PA2/PA3)，不占用命令口带宽。
+// 改回uart1_drv时二进制帧与命令应答混在一起，上位机按应答行数计算的流控信用（Tools/uart_stream.py）会被打乱，
+// 流式发送命令前必须先TELEM_OFF
+#define TELEMETRY_UART uart2_drv
+
+/**
+ * 遥测帧格式（小端）：
+ *   [0]=0xA5 [1]=0x5A [2]=类型 [3]=序号 [4..7]=采样时刻(ms) [8]=负载长度 [9..]=负载 [末尾]=校验和
+ *   类型 TELEMETRY_FRAME_KEY  : 负载为完整快照（TELEMETRY_SNAPSHOT_LEN字节）
+ *   类型 TELEMETRY_FRAME_DELTA: 负载为变化位图（每字节快照对应1位）+ 变化的字节
+ *   校验和为[2]到负载末尾所有字节的8位累加和
+ * 快照字段顺序见telemetry.c中的telemetry_fields表，上位机解码见Tools/telemetry_decode.py
+ */
+#define TELEMETRY_SYNC0       0xA5
+#define TELEMETRY_SYNC1       0x5A
+#define TELEMETRY_FRAME_KEY   0x01
+#define TELEMETRY_FRAME_DELTA 0x02
+
+void StartTelemetryTaskFunction(void *argument);
+void telemetry_set_rate(unsigned int hz);
+void telemetry_report(void);
+
+#endif
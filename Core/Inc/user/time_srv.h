@@ -0,0 +1,13 @@
+#ifndef __TIME_SRV_H
+#define __TIME_SRV_H
+
+// 墙钟按天回绕（时分秒）
+#define TIME_SRV_DAY_S 86400U
+
+unsigned long long time_us(void);
+unsigned int time_uptime_s(void);
+int time_set(unsigned int hours, unsigned int minute, unsigned int second);
+void time_srv_second_isr(void);
+void time_report(void);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __TRACE_H
+#define __TRACE_H
+
+// 事件跟踪开关：为0时内核钩子与中断钩子都展开为空（FreeRTOSConfig.h、stm32f1xx_it.c），不占用任何周期
+#define TRACE_ENABLE      1
+// 环形缓冲的记录数（2的幂），每条记录8字节；写满后覆盖最旧的记录
+#define TRACE_BUF_RECORDS 512
+// 登记的内核对象（队列/信号量/互斥量）数上限，编号从1开始，0表示未登记
+#define TRACE_MAX_OBJS    32
+
+// 事件类型（TRACE_DUMP输出的记录中的ev，Tools/trace_to_perfetto.py按此解析）
+#define TRACE_EV_TASK_IN    1  //!< 任务切入，id=任务编号
+#define TRACE_EV_TASK_OUT   2  //!< 任务切出，id=任务编号
+#define TRACE_EV_SEND       3  //!< 队列发送/信号量释放，id=对象编号，arg=操作前的消息数
+#define TRACE_EV_RECV       4  //!< 队列接收/信号量获取
+#define TRACE_EV_SEND_ISR   5  //!< 中断中发送/释放
+#define TRACE_EV_RECV_ISR   6  //!< 中断中接收/获取
+#define TRACE_EV_BLOCK_SEND 7  //!< 队列满，任务阻塞等待发送
+#define TRACE_EV_BLOCK_RECV 8  //!< 队列空，任务阻塞等待接收/获取
+#define TRACE_EV_FAIL       9  //!< 发送或接收超时失败
+#define TRACE_EV_ISR_ENTER  10 //!< 进入中断，id=IRQ编号
+#define TRACE_EV_ISR_EXIT   11 //!< 退出中断
+
+void trace_event(unsigned int ev, unsigned int id, unsigned int arg);
+unsigned int trace_queue_created(void *queue, unsigned int type);
+
+#if TRACE_ENABLE
+#define TRACE_ISR_ENTER(irq) trace_event(TRACE_EV_ISR_ENTER, (unsigned int)(irq), 0)
+#define TRACE_ISR_EXIT(irq)  trace_event(TRACE_EV_ISR_EXIT, (unsigned int)(irq), 0)
+#else
+#define TRACE_ISR_ENTER(irq)
+#define TRACE_ISR_EXIT(irq)
+#endif
+
+void trace_start(void);
+void trace_stop(void);
+void trace_report(void);
+void trace_dump(void);
+
+#endif
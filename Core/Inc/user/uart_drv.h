@@ -0,0 +1,90 @@
+#ifndef __UART_DRV_H
+#define __UART_DRV_H
+
+#include "main.h"
+#include "cmsis_os.h"
+#include "stdarg.h"
+#include "myformat.h"
+#include "res_lock.h"
+
+// 各端口环形缓冲区大小（字节）
+// USART1：命令口，接收环需能容纳流控窗口内的突发数据在任务调度前不被覆盖
+#define UART1_DRV_RX_LEN 256
+#define UART1_DRV_TX_LEN 256
+// USART2：副端口（遥测/协处理板）
+#define UART2_DRV_RX_LEN 128
+#define UART2_DRV_TX_LEN 256
+// 格式化输出单次最大长度（含结尾符）
+#define UART_DRV_FMT_LEN 96
+
+// uart_drv_rx_wait返回的事件标志
+#define UART_DRV_EVT_DATA    0x01 //!< 有新数据
+#define UART_DRV_EVT_IDLE    0x02 //!< 线路空闲（一次突发传输结束）
+#define UART_DRV_EVT_OVERRUN 0x04 //!< 接收环在读取前被覆盖，已丢失数据
+#define UART_DRV_EVT_RESTART 0x08 //!< 串口出错后接收已重新启动，之前的半帧不可信
+
+/**
+ * @brief  单个串口的吞吐/延迟统计
+ */
+typedef struct {
+    volatile unsigned int rx_bytes;   //!< 累计接收字节数
+    volatile unsigned int tx_bytes;   //!< 累计发送字节数
+    volatile unsigned int rx_overrun; //!< 接收环被覆盖次数
+    volatile unsigned int rx_error;   //!< 串口硬件错误次数（ORE/FE/NE/PE，已自动恢复接收）
+    volatile unsigned int tx_drop;    //!< 发送环空间不足被丢弃的写入次数
+    unsigned int rx_lat_max;          //!< 中断到接收任务取走数据的最大延迟（us）
+    unsigned int rx_lat_sum;          //!< 延迟累加（us）
+    unsigned int rx_lat_cnt;          //!< 延迟采样次数
+    unsigned int tx_wait_max;         //!< 写入者等待发送环空间的最长时间（us）
+} UART_DRV_STAT;
+
+/**
+ * @brief  串口驱动对象（每个端口一个实例）
+ * @note   接收：DMA循环模式写入rx_ring，半满/全满/空闲中断唤醒读取者
+ *         发送：写入者把数据拷入tx_ring，DMA每次发送一段连续区间，完成中断中接着发下一段，
+ *               写入者不必等待上一次发送完成
+ *         句柄、缓冲区、统计与信号量控制块都在uart_drv.c中静态定义，信号量由uart_drv_init在控制块上创建
+ */
+typedef struct {
+    UART_HandleTypeDef *huart;
+    const char *name;
+    // 接收环
+    unsigned char *rx_ring;
+    unsigned short rx_len;
+    unsigned short rx_rd;               //!< 读指针（仅读取者访问）
+    unsigned short rx_wr;               //!< 本次uart_drv_rx_wait快照的DMA写指针
+    volatile unsigned char rx_idle;     //!< 空闲中断标志
+    volatile unsigned char rx_restart;  //!< 出错后已重新启动接收
+    volatile unsigned int rx_half_evt;  //!< 半满/全满事件计数
+    unsigned int rx_half_seen;          //!< 已核对的半满/全满事件数
+    volatile unsigned int rx_evt_cyc;   //!< 首个未处理接收事件的DWT时刻，0表示无
+    // 发送环
+    unsigned char *tx_ring;
+    unsigned short tx_len;
+    volatile unsigned short tx_head;    //!< 写入位置（写入者）
+    volatile unsigned short tx_tail;    //!< 正在/下一次发送的起点（中断）
+    volatile unsigned short tx_busy;    //!< DMA正在发送的字节数，0表示空闲
+    char fmt_buf[UART_DRV_FMT_LEN];     //!< uart_drv_printf格式化缓冲（持有tx_lock时使用）
+    // 通知
+    osSemaphoreId_t rx_sem;             //!< 接收事件
+    osSemaphoreId_t tx_done;            //!< 一段DMA发送完成（发送环腾出空间）
+    StaticSemaphore_t rx_sem_cb;        //!< 以上两个信号量的控制块（静态分配，不占用FreeRTOS堆）
+    StaticSemaphore_t tx_done_cb;
+    RES_LOCK tx_lock;                   //!< 写入者互斥（优先级继承，持有预算为发送环排空时间）
+    UART_DRV_STAT stat;
+} UART_DRV;
+
+extern UART_DRV uart1_drv;
+extern UART_DRV uart2_drv;
+
+void uart_drv_init(UART_DRV *drv);
+void uart_drv_irq(UART_DRV *drv);
+int uart_drv_write(UART_DRV *drv, const void *data, unsigned int len, unsigned int timeout);
+int uart_drv_vprintf(UART_DRV *drv, const char *format, va_list ap);
+int uart_drv_printf(UART_DRV *drv, const char *format, ...) MY_FORMAT_CHECK(2, 3);
+unsigned int uart_drv_rx_wait(UART_DRV *drv, unsigned int timeout);
+unsigned int uart_drv_read(UART_DRV *drv, char *buf, unsigned int max);
+unsigned int uart_drv_rx_free(UART_DRV *drv);
+void uart_drv_report(UART_DRV *drv);
+
+#endif
@@ -26,9 +26,19 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "mytask.h"
+#include "uart_drv.h"
+#include "cpu_stats.h"
+#include "stack_mon.h"
+#include "ctrl_loop.h"
+#include "mem_pool.h"
+#include "lcd.h"
+#include "boot.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
+typedef StaticTask_t osStaticThreadDef_t;
+typedef StaticQueue_t osStaticMessageQDef_t;
+typedef StaticSemaphore_t osStaticSemaphoreDef_t;
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
@@ -45,83 +55,99 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+// 系统数据静态存放（调度器启动后main栈会被中断复用，不能放在MX_FREERTOS_Init的局部变量中）
+static SYS_USE_DATA sys_use_data;
 /* USER CODE END Variables */
 /* Definitions for defauleTask */
 osThreadId_t defauleTaskHandle;
+uint32_t defauleTaskBuffer[ 128 ];
+osStaticThreadDef_t defauleTaskControlBlock;
 const osThreadAttr_t defauleTask_attributes = {
   .name = "defauleTask",
-  .stack_size = 128 * 4,
+  .cb_mem = &defauleTaskControlBlock,
+  .cb_size = sizeof(defauleTaskControlBlock),
+  .stack_mem = &defauleTaskBuffer[0],
+  .stack_size = sizeof(defauleTaskBuffer),
   .priority = (osPriority_t) osPriorityNormal,
 };
 /* Definitions for UART1_recv_Task */
 osThreadId_t UART1_recv_TaskHandle;
+uint32_t UART1_recv_TaskBuffer[ 128 ];
+osStaticThreadDef_t UART1_recv_TaskControlBlock;
 const osThreadAttr_t UART1_recv_Task_attributes = {
   .name = "UART1_recv_Task",
-  .stack_size = 128 * 4,
+  .cb_mem = &UART1_recv_TaskControlBlock,
+  .cb_size = sizeof(UART1_recv_TaskControlBlock),
+  .stack_mem = &UART1_recv_TaskBuffer[0],
+  .stack_size = sizeof(UART1_recv_TaskBuffer),
   .priority = (osPriority_t) osPriorityBelowNormal,
 };
 /* Definitions for LCDDisplayTask */
 osThreadId_t LCDDisplayTaskHandle;
+uint32_t LCDDisplayTaskBuffer[ 192 ];
+osStaticThreadDef_t LCDDisplayTaskControlBlock;
 const osThreadAttr_t LCDDisplayTask_attributes = {
   .name = "LCDDisplayTask",
-  .stack_size = 128 * 4,
+  .cb_mem = &LCDDisplayTaskControlBlock,
+  .cb_size = sizeof(LCDDisplayTaskControlBlock),
+  .stack_mem = &LCDDisplayTaskBuffer[0],
+  .stack_size = sizeof(LCDDisplayTaskBuffer),
   .priority = (osPriority_t) osPriorityLow,
 };
 /* Definitions for LEDProcessedTas */
 osThreadId_t LEDProcessedTasHandle;
+uint32_t LEDProcessedTasBuffer[ 160 ];
+osStaticThreadDef_t LEDProcessedTasControlBlock;
 const osThreadAttr_t LEDProcessedTas_attributes = {
   .name = "LEDProcessedTas",
-  .stack_size = 128 * 4,
+  .cb_mem = &LEDProcessedTasControlBlock,
+  .cb_size = sizeof(LEDProcessedTasControlBlock),
+  .stack_mem = &LEDProcessedTasBuffer[0],
+  .stack_size = sizeof(LEDProcessedTasBuffer),
   .priority = (osPriority_t) osPriorityBelowNormal,
 };
-/* Definitions for LEDWorkTask */
-osThreadId_t LEDWorkTaskHandle;
-const osThreadAttr_t LEDWorkTask_attributes = {
-  .name = "LEDWorkTask",
-  .stack_size = 128 * 4,
-  .priority = (osPriority_t) osPriorityLow,
-};
-/* Definitions for TimeSetTask */
-osThreadId_t TimeSetTaskHandle;
-const osThreadAttr_t TimeSetTask_attributes = {
-  .name = "TimeSetTask",
-  .stack_size = 128 * 4,
-  .priority = (osPriority_t) osPriorityLow,
-};
-/* Definitions for BeepWorkTask */
-osThreadId_t BeepWorkTaskHandle;
-const osThreadAttr_t BeepWorkTask_attributes = {
-  .name = "BeepWorkTask",
-  .stack_size = 128 * 4,
-  .priority = (osPriority_t) osPriorityLow,
-};
 /* Definitions for RobotmainContro */
 osThreadId_t RobotmainControHandle;
+uint32_t RobotmainControBuffer[ 128 ];
+osStaticThreadDef_t RobotmainControControlBlock;
 const osThreadAttr_t RobotmainContro_attributes = {
   .name = "RobotmainContro",
-  .stack_size = 128 * 4,
-  .priority = (osPriority_t) osPriorityLow,
+  .cb_mem = &RobotmainControControlBlock,
+  .cb_size = sizeof(RobotmainControControlBlock),
+  .stack_mem = &RobotmainControBuffer[0],
+  .stack_size = sizeof(RobotmainControBuffer),
+  .priority = (osPriority_t) osPriorityRealtime,
 };
-/* Definitions for uart1_printf_gsem */
-osSemaphoreId_t uart1_printf_gsemHandle;
-const osSemaphoreAttr_t uart1_printf_gsem_attributes = {
-  .name = "uart1_printf_gsem"
+/* Definitions for TelemetryTask */
+osThreadId_t TelemetryTaskHandle;
+uint32_t TelemetryTaskBuffer[ 128 ];
+osStaticThreadDef_t TelemetryTaskControlBlock;
+const osThreadAttr_t TelemetryTask_attributes = {
+  .name = "TelemetryTask",
+  .cb_mem = &TelemetryTaskControlBlock,
+  .cb_size = sizeof(TelemetryTaskControlBlock),
+  .stack_mem = &TelemetryTaskBuffer[0],
+  .stack_size = sizeof(TelemetryTaskBuffer),
+  .priority = (osPriority_t) osPriorityLow,
 };
-/* Definitions for uart1_rxok_gsem */
-osSemaphoreId_t uart1_rxok_gsemHandle;
-const osSemaphoreAttr_t uart1_rxok_gsem_attributes = {
-  .name = "uart1_rxok_gsem"
+/* Definitions for uart1_cmd_queue */
+osMessageQueueId_t uart1_cmd_queueHandle;
+uint8_t uart1_cmd_queueBuffer[ 16 * sizeof( UART_CMD_FRAME * ) ];
+osStaticMessageQDef_t uart1_cmd_queueControlBlock;
+const osMessageQueueAttr_t uart1_cmd_queue_attributes = {
+  .name = "uart1_cmd_queue",
+  .cb_mem = &uart1_cmd_queueControlBlock,
+  .cb_size = sizeof(uart1_cmd_queueControlBlock),
+  .mq_mem = &uart1_cmd_queueBuffer,
+  .mq_size = sizeof(uart1_cmd_queueBuffer)
 };
 /* Definitions for LCD_refresh_gsem */
 osSemaphoreId_t LCD_refresh_gsemHandle;
+osStaticSemaphoreDef_t LCD_refresh_gsemControlBlock;
 const osSemaphoreAttr_t LCD_refresh_gsem_attributes = {
-  .name = "LCD_refresh_gsem"
-};
-/* Definitions for uart1_data_handle_gsem */
-osSemaphoreId_t uart1_data_handle_gsemHandle;
-const osSemaphoreAttr_t uart1_data_handle_gsem_attributes = {
-  .name = "uart1_data_handle_gsem"
+  .name = "LCD_refresh_gsem",
+  .cb_mem = &LCD_refresh_gsemControlBlock,
+  .cb_size = sizeof(LCD_refresh_gsemControlBlock),
 };
 
 /* Private function prototypes -----------------------------------------------*/
@@ -133,13 +159,45 @@ void StartdefauleTask(void *argument);
 extern void StartUART1_recv_TaskFunction(void *argument);
 extern void StartLCDDisplayTaskFunction(void *argument);
 extern void StartLEDProcessedTaskFunction(void *argument);
-extern void StartLEDWorkTaskFunction(void *argument);
-extern void StartTimeSetTaskFunction(void *argument);
-extern void StartBeepWorkTaskFunction(void *argument);
 extern void StartRobotmainControlTask(void *argument);
+extern void StartTelemetryTaskFunction(void *argument);
 
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 
+/* Hook prototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
+/* USER CODE BEGIN 1 */
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+__weak void configureTimerForRunTimeStats(void)
+{
+
+}
+
+__weak unsigned long getRunTimeCounterValue(void)
+{
+return 0;
+}
+/* USER CODE END 1 */
+
+/* Pre/Post sleep processing prototypes */
+void PreSleepProcessing(uint32_t ulExpectedIdleTime);
+void PostSleepProcessing(uint32_t ulExpectedIdleTime);
+
+/* USER CODE BEGIN PREPOSTSLEEP */
+/* 实现见power.c（HAL时基补偿与睡眠统计） */
+__weak void PreSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+/* place for user code */
+}
+
+__weak void PostSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+/* place for user code */
+}
+/* USER CODE END PREPOSTSLEEP */
+
 /**
   * @brief  FreeRTOS initialization
   * @param  None
@@ -147,37 +205,46 @@ void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
   */
 void MX_FREERTOS_Init(void) {
   /* USER CODE BEGIN Init */
-    //完成参数初始化（这里建议使用自定义函数完成后将其放入这个位置）
-    SYS_USE_DATA sys_use_data;
+    //完成参数初始化（各分区由所有者任务启动时初始化并发布快照）
+    // 启动阶段事件标志：调度器启动后各初始化阶段按依赖并行执行（见boot.c）
+    boot_init();
   /* USER CODE END Init */
 
   /* USER CODE BEGIN RTOS_MUTEX */
     /* add mutexes, ... */
+    // 共享外设锁（优先级继承），串口写锁由uart_drv_init创建
+    res_lock_init(&lcd_lock, "lcd", LCD_LOCK_BUDGET_US);
   /* USER CODE END RTOS_MUTEX */
 
   /* Create the semaphores(s) */
-  /* creation of uart1_printf_gsem */
-  uart1_printf_gsemHandle = osSemaphoreNew(1, 1, &uart1_printf_gsem_attributes);
-
-  /* creation of uart1_rxok_gsem */
-  uart1_rxok_gsemHandle = osSemaphoreNew(1, 1, &uart1_rxok_gsem_attributes);
-
   /* creation of LCD_refresh_gsem */
   LCD_refresh_gsemHandle = osSemaphoreNew(1, 1, &LCD_refresh_gsem_attributes);
 
-  /* creation of uart1_data_handle_gsem */
-  uart1_data_handle_gsemHandle = osSemaphoreNew(1, 1, &uart1_data_handle_gsem_attributes);
-
   /* USER CODE BEGIN RTOS_SEMAPHORES */
     /* add semaphores, ... */
+    // 串口驱动的收发信号量由驱动自己创建，同时启动DMA接收
+    uart_drv_init(&uart1_drv);
+    uart_drv_init(&uart2_drv);
   /* USER CODE END RTOS_SEMAPHORES */
 
   /* USER CODE BEGIN RTOS_TIMERS */
     /* start timers, add new ones, ... */
+    // 任务CPU占用统计窗口定时器（STATS命令/LCD统计页）
+    cpu_stats_init();
+    // LED闪烁、系统时间、蜂鸣器与红外解码都在定时器服务任务中运行（原LEDWorkTask/TimeSetTask/BeepWorkTask）
+    led_init();
+    time_init(&sys_use_data);
+    beep_init(&sys_use_data);
   /* USER CODE END RTOS_TIMERS */
 
+  /* Create the queue(s) */
+  /* creation of uart1_cmd_queue */
+  uart1_cmd_queueHandle = osMessageQueueNew (16, sizeof(UART_CMD_FRAME *), &uart1_cmd_queue_attributes);
+
   /* USER CODE BEGIN RTOS_QUEUES */
     /* add queues, ... */
+    // 命令队列只传递命令帧池中块的指针
+    mem_pool_init(&cmd_pool);
   /* USER CODE END RTOS_QUEUES */
 
   /* Create the thread(s) */
@@ -193,24 +260,28 @@ void MX_FREERTOS_Init(void) {
   /* creation of LEDProcessedTas */
   LEDProcessedTasHandle = osThreadNew(StartLEDProcessedTaskFunction, (void*) &sys_use_data, &LEDProcessedTas_attributes);
 
-  /* creation of LEDWorkTask */
-  LEDWorkTaskHandle = osThreadNew(StartLEDWorkTaskFunction, (void*) &sys_use_data, &LEDWorkTask_attributes);
-
-  /* creation of TimeSetTask */
-  TimeSetTaskHandle = osThreadNew(StartTimeSetTaskFunction, (void*) &sys_use_data, &TimeSetTask_attributes);
-
-  /* creation of BeepWorkTask */
-  BeepWorkTaskHandle = osThreadNew(StartBeepWorkTaskFunction, (void*) &sys_use_data, &BeepWorkTask_attributes);
-
   /* creation of RobotmainContro */
   RobotmainControHandle = osThreadNew(StartRobotmainControlTask, (void*) &sys_use_data, &RobotmainContro_attributes);
 
+  /* creation of TelemetryTask */
+  TelemetryTaskHandle = osThreadNew(StartTelemetryTaskFunction, (void*) &sys_use_data, &TelemetryTask_attributes);
+
   /* USER CODE BEGIN RTOS_THREADS */
     /* add threads, ... */
+    // 栈水位监视登记（IDLE与定时器服务任务在首次采样时自动登记）
+    stack_mon_add(defauleTaskHandle, sizeof(defauleTaskBuffer));
+    stack_mon_add(UART1_recv_TaskHandle, sizeof(UART1_recv_TaskBuffer));
+    stack_mon_add(LCDDisplayTaskHandle, sizeof(LCDDisplayTaskBuffer));
+    stack_mon_add(LEDProcessedTasHandle, sizeof(LEDProcessedTasBuffer));
+    stack_mon_add(RobotmainControHandle, sizeof(RobotmainControBuffer));
+    stack_mon_add(TelemetryTaskHandle, sizeof(TelemetryTaskBuffer));
+    // 控制周期的周期监视登记（其余周期任务由各自的初始化函数登记，见period_mon.c）
+    ctrl_loop_init();
   /* USER CODE END RTOS_THREADS */
 
   /* USER CODE BEGIN RTOS_EVENTS */
     /* add events, ... */
+    boot_mark(BOOT_RTOS);
   /* USER CODE END RTOS_EVENTS */
 
 }
@@ -226,8 +297,10 @@ __weak void StartdefauleTask(void *argument)
 {
   /* USER CODE BEGIN StartdefauleTask */
     /* Infinite loop */
+    // 栈水位监视（见stack_mon.c）；原来的osDelay(1)每1ms唤醒一次，会让无节拍空闲永远进入不了睡眠
     for (;;) {
-        osDelay(1);
+        osDelay(STACK_MON_PERIOD_MS);
+        stack_mon_sample();
     }
   /* USER CODE END StartdefauleTask */
 }
@@ -28,6 +28,9 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "mytask.h"
+#include "boot.h"
+#include "delay.h"
+#include "journal.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -71,7 +74,10 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
-
+    // 启动剖析（BOOT命令）：以下各段依次标记，时间原点为复位向量
+    boot_start();
+    // 校验复位前保留的事件日志并记录本次启动（JOURNAL命令）
+    journal_init();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -87,18 +93,26 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+    boot_mark(BOOT_CLOCK);
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
   MX_DMA_Init();
   MX_USART1_UART_Init();
+  MX_USART2_UART_Init();
   MX_FSMC_Init();
+  MX_TIM1_Init();
+  MX_TIM2_Init();
+  MX_TIM3_Init();
   MX_TIM4_Init();
+  MX_TIM5_Init();
+  MX_TIM7_Init();
   MX_TIM8_Init();
   /* USER CODE BEGIN 2 */
-
+    // 启动us时间基准（TIM5+TIM1），HAL_Delay/delay_xx从此改用它计时，此前用DWT周期计数忙等
+    delay_init();
+    boot_mark(BOOT_PERIPH);
   /* USER CODE END 2 */
 
   /* Init scheduler */
@@ -195,6 +209,7 @@ void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
+  journal_log(JOURNAL_FAULT, JOURNAL_FAULT_HAL, JOURNAL_CALLER());
   __disable_irq();
   while (1)
   {
@@ -1,5 +1,6 @@
 #include "FreeRTOS.h"
 #include "task.h"
+#include "timers.h"
 #include "main.h"
 #include "cmsis_os.h"
 #include "gpio.h"
@@ -7,24 +8,129 @@
 #include "lcd.h"
 
 #include "my_sys_data.h"
+#include "latency.h"
+#include "boot.h"
+#include "period_mon.h"
 
-void StartBeepWorkTaskFunction(void *argument)
+// 鸣叫周期（ms）：每个周期先响Beep_delay_num毫秒，其余时间静音
+#define BEEP_PERIOD_MS 1000
+// 鸣叫结束允许晚于设定时长的时间（ms），超过计入PERIODS中beep的miss
+#define BEEP_DEADLINE_MS 20
+
+// 原BeepWorkTask的工作全部改在定时器服务任务中完成：
+// 蜂鸣器分区由指令处理任务发布，定时器订阅回调只读快照并启停定时器；
+// 每个周期由自动重装定时器开始，由单次定时器按鸣叫时长结束
+// 红外遥控分区的所有者是定时器服务任务：中断把解码事件挂到定时器服务任务，解码后发布快照供机械臂、LCD和遥测读取
+static SYS_USE_DATA *beep_sys;
+static unsigned int beep_on_ms; // 当前鸣叫时长，0表示不鸣叫
+// 鸣叫周期监视（PERIODS命令）：周期定时器回调开始一个周期，单次定时器关断蜂鸣器时结束，
+// 因此exec即实际鸣叫时长，jit/drift为周期定时器的精度
+static PERIOD_MON beep_mon;
+
+static osTimerId_t beep_period_timer;
+static StaticTimer_t beep_period_timer_cb;
+static const osTimerAttr_t beep_period_timer_attributes = {
+    .name    = "beep_period",
+    .cb_mem  = &beep_period_timer_cb,
+    .cb_size = sizeof(beep_period_timer_cb),
+};
+static osTimerId_t beep_off_timer;
+static StaticTimer_t beep_off_timer_cb;
+static const osTimerAttr_t beep_off_timer_attributes = {
+    .name    = "beep_off",
+    .cb_mem  = &beep_off_timer_cb,
+    .cb_size = sizeof(beep_off_timer_cb),
+};
+
+/**
+ * @brief   开始一个鸣叫周期（周期定时器回调，在定时器服务任务中执行）
+ * @note    鸣叫时长不小于周期时一直鸣叫，不启动单次定时器
+ */
+static void beep_cycle(void *argument)
 {
-    SYS_USE_DATA *SYS                  = (SYS_USE_DATA *)argument;
-    SYS->Beep_control.Beep_delay_num   = 0;
-    SYS->Beep_control.Beep_control_num = BEEP_OFF;
-    SYS->Remote_use_data.str           = 0;
-    SYS->Remote_use_data.key           = 0;
-    remote_init(); /* 红外接收初始化 */
-    for (;;) {
-        if (SYS->Beep_control.Beep_control_num != BEEP_OFF) {
-            HAL_GPIO_WritePin(Beep1_GPIO_Port, Beep1_Pin, GPIO_PIN_SET);
-            osDelay(SYS->Beep_control.Beep_delay_num);
-            HAL_GPIO_WritePin(Beep1_GPIO_Port, Beep1_Pin, GPIO_PIN_RESET);
-            osDelay(1000 - SYS->Beep_control.Beep_delay_num);
-        } else {
-            Read_remote_data(&(SYS->Remote_use_data));
-            osDelay(100);
-        }
+    (void)argument;
+    if (beep_on_ms == 0) return;
+    period_mon_begin(&beep_mon);
+    HAL_GPIO_WritePin(Beep1_GPIO_Port, Beep1_Pin, GPIO_PIN_SET);
+    if (beep_on_ms < BEEP_PERIOD_MS) {
+        osTimerStart(beep_off_timer, beep_on_ms);
+    } else {
+        period_mon_end(&beep_mon);
     }
 }
+
+/**
+ * @brief   鸣叫时长到期（单次定时器回调）
+ */
+static void beep_off(void *argument)
+{
+    (void)argument;
+    HAL_GPIO_WritePin(Beep1_GPIO_Port, Beep1_Pin, GPIO_PIN_RESET);
+    period_mon_end(&beep_mon);
+}
+
+/**
+ * @brief   蜂鸣器分区发布后执行新指令（定时器订阅回调）
+ * @note    新的BEEP指令（包括BEEP_OFF）立即结束当前周期，BEEP_ON从新周期开始，
+ *          并按新的鸣叫时长重设周期监视的截止期限（统计随之清零）
+ */
+static void beep_apply(void)
+{
+    BEEP_USE_DATA beep;
+
+    sys_snapshot(SYS_PART_BEEP, &beep);
+    osTimerStop(beep_off_timer);
+    osTimerStop(beep_period_timer);
+    HAL_GPIO_WritePin(Beep1_GPIO_Port, Beep1_Pin, GPIO_PIN_RESET);
+    beep_on_ms = beep.Beep_control_num != BEEP_OFF ? beep.Beep_delay_num : 0;
+    if (beep_on_ms == 0) return;
+    period_mon_set(&beep_mon, BEEP_PERIOD_MS * 1000U,
+                   ((beep_on_ms < BEEP_PERIOD_MS ? beep_on_ms : 0U) + BEEP_DEADLINE_MS) * 1000U);
+    beep_cycle(NULL);
+    osTimerStart(beep_period_timer, BEEP_PERIOD_MS);
+}
+
+/**
+ * @brief   红外解码事件（中断经xTimerPendFunctionCallFromISR挂到定时器服务任务执行）
+ * @note    按下、重复码与松开都会触发；不再受蜂鸣器是否鸣叫影响
+ */
+static void beep_remote_event(void)
+{
+    Read_remote_data(&beep_sys->Remote_use_data);
+    LAT_PASS(LAT_PATH_IR, LAT_IR_DECODED, LAT_IR_ROBOT);
+    sys_publish(SYS_PART_REMOTE, &beep_sys->Remote_use_data);
+}
+
+/**
+ * @brief   红外接收初始化阶段（BOOT_REMOTE，调度器启动后在定时器服务任务中执行）
+ * @note    与LCD初始化等其他启动阶段并行，控制任务等待本阶段结束后才开始控制周期
+ */
+static void beep_remote_start(void *unused1, uint32_t unused2)
+{
+    (void)unused1;
+    (void)unused2;
+    boot_begin(BOOT_REMOTE);
+    remote_init(beep_remote_event); /* 红外接收初始化，解码事件在定时器服务任务中处理 */
+    boot_end(BOOT_REMOTE);
+}
+
+/**
+ * @brief   蜂鸣器与红外遥控初始化
+ * @param   SYS: 系统数据（只写红外遥控分区）
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中调用；上电蜂鸣器状态由指令处理任务发布（BEEP_OFF）；
+ *          红外接收的硬件初始化挂到定时器服务任务，作为一个启动阶段执行（见boot.c）
+ */
+void beep_init(SYS_USE_DATA *SYS)
+{
+    beep_sys                  = SYS;
+    SYS->Remote_use_data.str  = "";
+    SYS->Remote_use_data.key  = 0;
+    sys_publish(SYS_PART_REMOTE, &SYS->Remote_use_data);
+
+    beep_period_timer = osTimerNew(beep_cycle, osTimerPeriodic, NULL, &beep_period_timer_attributes);
+    beep_off_timer    = osTimerNew(beep_off, osTimerOnce, NULL, &beep_off_timer_attributes);
+    period_mon_init(&beep_mon, "beep", BEEP_PERIOD_MS * 1000U, BEEP_DEADLINE_MS * 1000U);
+    sys_subscribe_timer(SYS_PART_BEEP, beep_apply);
+    xTimerPendFunctionCall(beep_remote_start, NULL, 0, 0);
+}
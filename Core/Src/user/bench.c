@@ -0,0 +1,362 @@
+/**
+ * @file    bench.c
+ * @brief   微基准测量项登记表与BENCH命令
+ * @note    一个测量项是一个带setup/prepare/teardown的具名函数（BENCH_CASE），登记在bench_table中。
+ *          每项测量runs次（默认BENCH_RUNS），每次只用cpu_stats_cycles夹住run一次调用，
+ *          扣除两次读周期计数器本身的开销（BENCH命令首行的ovh）后排序，给出min/中位数/max（CPU周期）。
+ *          中断按测量项的flags控制：BENCH_F_IRQ_OFF每次测量关中断，BENCH_F_ATOMIC整组测量关中断。
+ *          目标板上cpu_stats_cycles是DWT CYCCNT；主机仿真构建（HOST_SIM）中是单调时钟按72MHz换算的周期数，
+ *          登记表与命令完全相同，数值只能用于同一构建内的相对比较。
+ *          已登记：
+ *          - lcd_fill/lcd_char/lcd_point：64x16填充、一个16号字符、单点，画在屏幕右下角、颜色为背景白色
+ *          - fmt：my_snprintf格式化一行状态；uart_write/uart_printf：向uart2_drv写16字节/格式化并写同一行
+ *          - sem_rtt：两个任务间信号量一来一回；ctx_switch：线程标志唤醒高优先级任务再被唤醒（两次任务切换）
+ *          - ir_capture/ir_scan：红外输入捕获回调（上升沿路径）与按键解码（remote.c）
+ *          - pwm_cb：PWM脉冲完成回调（脉冲计数递减路径，robot.c）
+ *          LCD测量持有lcd_lock，与LCD刷新任务互斥；串口测量写到副端口，接在上面的设备会收到测量数据。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include <ctype.h>
+
+#include "bench.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+#include "myformat.h"
+#include "uart_drv.h"
+#include "stack_mon.h"
+#include "lcd.h"
+#include "remote.h"
+#include "robot.h"
+
+// LCD测量区域（右下角，宽BENCH_LCD_W、高BENCH_LCD_H）
+#define BENCH_LCD_W 64
+#define BENCH_LCD_H 16
+
+// 串口测量：写入字节数与测量次数（全部写入不超过发送环，不会阻塞）
+#define BENCH_UART_LEN  16
+#define BENCH_UART_RUNS 8
+// 等待发送环排空的最长时间（ms）
+#define BENCH_UART_DRAIN_MS 100
+
+// 对端任务的线程标志
+#define BENCH_PEER_PING 0x01 //!< 回一次BENCH_PEER_PONG（ctx_switch）
+#define BENCH_PEER_SEM  0x02 //!< 进入信号量往返循环，直到bench_sem_stop（sem_rtt）
+#define BENCH_PEER_PONG 0x01 //!< 发给测量任务
+
+// 格式化测量用的一行（同时是uart_printf写出的内容）
+#define BENCH_FMT "CTRL n=%u lat=%u/%u/%u us\r\n"
+
+static unsigned int bench_sample[BENCH_RUNS];
+static unsigned int bench_ovh;
+static char bench_buf[UART_DRV_FMT_LEN];
+static const char bench_line[BENCH_UART_LEN] = "BENCH uart_drv\r\n";
+
+// 对端任务（第一次测量sem_rtt/ctx_switch时创建，优先级高于指令处理任务）
+static osThreadId_t bench_peer;
+static osThreadId_t bench_caller;
+static uint32_t bench_peer_stack[128];
+static StaticTask_t bench_peer_cb;
+static const osThreadAttr_t bench_peer_attributes = {
+    .name       = "bench",
+    .cb_mem     = &bench_peer_cb,
+    .cb_size    = sizeof(bench_peer_cb),
+    .stack_mem  = &bench_peer_stack[0],
+    .stack_size = sizeof(bench_peer_stack),
+    .priority   = (osPriority_t)osPriorityAboveNormal,
+};
+static osSemaphoreId_t bench_sem_ping, bench_sem_pong;
+static StaticSemaphore_t bench_sem_ping_cb, bench_sem_pong_cb;
+static volatile unsigned char bench_sem_stop;
+
+/**
+ * @brief   LCD测量：持有lcd_lock，屏幕未初始化（宽度为0）时不测量
+ */
+static int bench_lcd_setup(void)
+{
+    if (lcddev.width < BENCH_LCD_W || lcddev.height < BENCH_LCD_H) return -1;
+    res_lock_take(&lcd_lock, osWaitForever);
+    return 0;
+}
+
+static void bench_lcd_teardown(void)
+{
+    res_lock_give(&lcd_lock);
+}
+
+static void bench_lcd_fill(void)
+{
+    const uint16_t x = lcddev.width - BENCH_LCD_W, y = lcddev.height - BENCH_LCD_H;
+
+    lcd_fill(x, y, x + BENCH_LCD_W - 1, y + BENCH_LCD_H - 1, WHITE);
+}
+
+static void bench_lcd_char(void)
+{
+    lcd_show_char(lcddev.width - BENCH_LCD_W, lcddev.height - BENCH_LCD_H, ' ', 16, 0, WHITE);
+}
+
+static void bench_lcd_point(void)
+{
+    lcd_draw_point(lcddev.width - BENCH_LCD_W, lcddev.height - BENCH_LCD_H, WHITE);
+}
+
+/**
+ * @brief   格式化测量：一行典型的状态输出
+ */
+static void bench_fmt(void)
+{
+    (void)my_snprintf(bench_buf, sizeof(bench_buf), BENCH_FMT, 123456U, 3U, 5U, 17U);
+}
+
+/**
+ * @brief   串口测量：等待副端口发送环排空，保证全部写入都不会等待
+ */
+static int bench_uart_setup(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < BENCH_UART_DRAIN_MS; i++) {
+        if (uart2_drv.tx_head == uart2_drv.tx_tail && uart2_drv.tx_busy == 0) return 0;
+        osDelay(1);
+    }
+    return -1;
+}
+
+static void bench_uart_write(void)
+{
+    (void)uart_drv_write(&uart2_drv, bench_line, BENCH_UART_LEN, 0);
+}
+
+static void bench_uart_printf(void)
+{
+    (void)uart_drv_printf(&uart2_drv, BENCH_FMT, 123456U, 3U, 5U, 17U);
+}
+
+/**
+ * @brief   对端任务：按线程标志回应ctx_switch或进入sem_rtt的信号量往返循环
+ */
+static void bench_peer_task(void *argument)
+{
+    uint32_t flags;
+
+    (void)argument;
+    for (;;) {
+        flags = osThreadFlagsWait(BENCH_PEER_PING | BENCH_PEER_SEM, osFlagsWaitAny, osWaitForever);
+        if (flags & BENCH_PEER_PING) osThreadFlagsSet(bench_caller, BENCH_PEER_PONG);
+        if (flags & BENCH_PEER_SEM) {
+            for (;;) {
+                (void)osSemaphoreAcquire(bench_sem_ping, osWaitForever);
+                if (bench_sem_stop) break;
+                osSemaphoreRelease(bench_sem_pong);
+            }
+        }
+    }
+}
+
+/**
+ * @brief   创建对端任务与信号量（只在第一次调用时创建），记录测量任务
+ */
+static int bench_peer_setup(void)
+{
+    const osSemaphoreAttr_t ping_attr = {.name = "bench_ping", .cb_mem = &bench_sem_ping_cb, .cb_size = sizeof(bench_sem_ping_cb)};
+    const osSemaphoreAttr_t pong_attr = {.name = "bench_pong", .cb_mem = &bench_sem_pong_cb, .cb_size = sizeof(bench_sem_pong_cb)};
+
+    if (bench_peer == NULL) {
+        bench_sem_ping = osSemaphoreNew(1, 0, &ping_attr);
+        bench_sem_pong = osSemaphoreNew(1, 0, &pong_attr);
+        bench_peer     = osThreadNew(bench_peer_task, NULL, &bench_peer_attributes);
+        if (bench_peer == NULL) return -1;
+        stack_mon_add(bench_peer, sizeof(bench_peer_stack));
+    }
+    bench_caller = osThreadGetId();
+    osThreadFlagsClear(BENCH_PEER_PONG);
+    return 0;
+}
+
+static void bench_ctx_switch(void)
+{
+    osThreadFlagsSet(bench_peer, BENCH_PEER_PING);
+    (void)osThreadFlagsWait(BENCH_PEER_PONG, osFlagsWaitAny, osWaitForever);
+}
+
+static int bench_sem_setup(void)
+{
+    if (bench_peer_setup() != 0) return -1;
+    bench_sem_stop = 0;
+    osThreadFlagsSet(bench_peer, BENCH_PEER_SEM);
+    return 0;
+}
+
+static void bench_sem_rtt(void)
+{
+    osSemaphoreRelease(bench_sem_ping);
+    (void)osSemaphoreAcquire(bench_sem_pong, osWaitForever);
+}
+
+static void bench_sem_teardown(void)
+{
+    bench_sem_stop = 1;
+    osSemaphoreRelease(bench_sem_ping);
+}
+
+static const BENCH_CASE bench_lcd_fill_case    = {"lcd_fill", bench_lcd_setup, NULL, bench_lcd_fill, bench_lcd_teardown, 0, BENCH_F_IRQ_OFF};
+static const BENCH_CASE bench_lcd_char_case    = {"lcd_char", bench_lcd_setup, NULL, bench_lcd_char, bench_lcd_teardown, 0, BENCH_F_IRQ_OFF};
+static const BENCH_CASE bench_lcd_point_case   = {"lcd_point", bench_lcd_setup, NULL, bench_lcd_point, bench_lcd_teardown, 0, BENCH_F_IRQ_OFF};
+static const BENCH_CASE bench_fmt_case         = {"fmt", NULL, NULL, bench_fmt, NULL, 0, BENCH_F_IRQ_OFF};
+static const BENCH_CASE bench_uart_write_case  = {"uart_write", bench_uart_setup, NULL, bench_uart_write, NULL, BENCH_UART_RUNS, 0};
+static const BENCH_CASE bench_uart_printf_case = {"uart_printf", bench_uart_setup, NULL, bench_uart_printf, NULL, BENCH_UART_RUNS, 0};
+static const BENCH_CASE bench_sem_rtt_case     = {"sem_rtt", bench_sem_setup, NULL, bench_sem_rtt, bench_sem_teardown, 0, 0};
+static const BENCH_CASE bench_ctx_switch_case  = {"ctx_switch", bench_peer_setup, NULL, bench_ctx_switch, NULL, 0, 0};
+
+// 登记表（BENCH命令按此顺序测量）
+static const BENCH_CASE *const bench_table[] = {
+    &bench_lcd_fill_case, &bench_lcd_char_case, &bench_lcd_point_case,
+    &bench_fmt_case, &bench_uart_write_case, &bench_uart_printf_case,
+    &bench_sem_rtt_case, &bench_ctx_switch_case,
+    &remote_bench_capture, &remote_bench_scan, &robot_bench_pwm_cb,
+};
+
+#define BENCH_NUM (sizeof(bench_table) / sizeof(bench_table[0]))
+
+/**
+ * @brief   两次连续读周期计数器的最小间隔（关中断测量，只测一次）
+ */
+static unsigned int bench_overhead(void)
+{
+    unsigned int i, t0, t;
+
+    if (bench_ovh != 0) return bench_ovh;
+    bench_ovh = ~0U;
+    taskENTER_CRITICAL();
+    for (i = 0; i < BENCH_RUNS; i++) {
+        t0 = cpu_stats_cycles();
+        t  = cpu_stats_cycles() - t0;
+        if (t < bench_ovh) bench_ovh = t;
+    }
+    taskEXIT_CRITICAL();
+    if (bench_ovh == 0) bench_ovh = 1;
+    return bench_ovh;
+}
+
+/**
+ * @brief   名称比较（不区分大小写）
+ */
+static int bench_name_eq(const char *a, const char *b)
+{
+    while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return tolower((unsigned char)*a) == tolower((unsigned char)*b);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   按名称查找测量项
+ * @param   name: 名称（不区分大小写）
+ * @retval  测量项，没有时为NULL
+ */
+const BENCH_CASE *bench_find(const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; i < BENCH_NUM; i++) {
+        if (bench_name_eq(bench_table[i]->name, name)) return bench_table[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief   测量一个测量项
+ * @param   c: 测量项
+ * @param   r: 结果（CPU周期）
+ * @retval  0: 成功；-1: setup返回非0，当前不能测量
+ * @note    在指令处理任务中调用，测量期间本任务不处理其他命令；样本缓冲为静态，不可重入
+ */
+int bench_measure(const BENCH_CASE *c, BENCH_RESULT *r)
+{
+    const unsigned int ovh   = bench_overhead();
+    const unsigned int runs  = (c->runs && c->runs < BENCH_RUNS) ? c->runs : BENCH_RUNS;
+    const unsigned char each = (c->flags & (BENCH_F_IRQ_OFF | BENCH_F_ATOMIC)) == BENCH_F_IRQ_OFF;
+    unsigned int i, j, t0, t;
+
+    if (c->flags & BENCH_F_ATOMIC) taskENTER_CRITICAL();
+    if (c->setup != NULL && c->setup() != 0) {
+        if (c->flags & BENCH_F_ATOMIC) taskEXIT_CRITICAL();
+        return -1;
+    }
+    for (i = 0; i < runs; i++) {
+        if (c->prepare != NULL) c->prepare();
+        if (each) taskENTER_CRITICAL();
+        t0 = cpu_stats_cycles();
+        c->run();
+        t = cpu_stats_cycles() - t0;
+        if (each) taskEXIT_CRITICAL();
+        t = t > ovh ? t - ovh : 0U;
+        // 插入排序（样本数很少）
+        for (j = i; j > 0 && bench_sample[j - 1] > t; j--) bench_sample[j] = bench_sample[j - 1];
+        bench_sample[j] = t;
+    }
+    if (c->teardown != NULL) c->teardown();
+    if (c->flags & BENCH_F_ATOMIC) taskEXIT_CRITICAL();
+
+    r->runs = runs;
+    r->min  = bench_sample[0];
+    r->med  = bench_sample[runs / 2];
+    r->max  = bench_sample[runs - 1];
+    return 0;
+}
+
+/**
+ * @brief   测量并打印一行
+ */
+static void bench_run_line(const BENCH_CASE *c)
+{
+    BENCH_RESULT r;
+
+    if (bench_measure(c, &r) != 0) {
+        myprintf("  %-12s busy\r\n", c->name);
+    } else {
+        myprintf("  %-12s n=%-2u min=%u med=%u max=%u\r\n", c->name, r.runs, r.min, r.med, r.max);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   BENCH命令（多行应答，单位CPU周期）
+ * @param   arg: 命令参数（已去掉前导空格）：空串列出测量项，"all"测量全部，否则为测量项名称（不区分大小写）
+ * @retval  None
+ * @note    列表每行为名称、测量次数与中断控制方式（irq_off每次测量关中断，atomic整组关中断）；
+ *          测量结果首行ovh为已扣除的读周期计数器开销，不能测量的项（屏幕未初始化、副端口发送环排不空、
+ *          红外正在接收、电机1正在输出等）打印busy
+ */
+void bench_command(const char *arg)
+{
+    const BENCH_CASE *c;
+    unsigned int i;
+
+    if (*arg == '\0') {
+        myprintf("BENCH n=%u runs=%u\r\n", (unsigned int)BENCH_NUM, BENCH_RUNS);
+        for (i = 0; i < BENCH_NUM; i++) {
+            c = bench_table[i];
+            myprintf("  %-12s n=%-2u %s\r\n", c->name, c->runs ? c->runs : BENCH_RUNS,
+                     (c->flags & BENCH_F_ATOMIC) ? "atomic" : (c->flags & BENCH_F_IRQ_OFF) ? "irq_off" : "-");
+        }
+        return;
+    }
+    if (bench_name_eq("all", arg)) {
+        myprintf("BENCH all ovh=%u cyc\r\n", bench_overhead());
+        for (i = 0; i < BENCH_NUM; i++) bench_run_line(bench_table[i]);
+        return;
+    }
+    if ((c = bench_find(arg)) == NULL) {
+        myprintf("BENCH unknown %s\r\n", arg);
+        return;
+    }
+    myprintf("BENCH %s ovh=%u cyc\r\n", c->name, bench_overhead());
+    bench_run_line(c);
+}
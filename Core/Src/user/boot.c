@@ -0,0 +1,230 @@
+/**
+ * @file    boot.c
+ * @brief   启动剖析与分阶段并行初始化（BOOT命令）
+ * @note    时间原点是复位向量：SystemInit第一件事清零并打开DWT周期计数器（主机仿真构建中为进入main的时刻）。
+ *          main与MX_FREERTOS_Init依次用boot_mark标记串行的里程碑；调度器启动后，
+ *          互不依赖的初始化阶段在各自的任务中并行执行，每个阶段用boot_begin/boot_end包住：
+ *          boot_begin先等待boot_deps中该阶段依赖的阶段全部结束（事件标志，不轮询、不固定延时），
+ *          等待时长单独记录，boot_end置位本阶段的标志放行依赖它的阶段。
+ *          所有并行阶段结束的时刻即就绪时间（BOOT命令首行ready），last为最后结束的阶段，即关键路径的终点。
+ *          周期计数按各段实际的CPU频率换算：SystemClock_Config之前是HSI 8MHz，之后是SystemCoreClock。
+ *          32位周期计数72MHz下约60s回绕，启动过程远短于此。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "boot.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+
+#ifdef HOST_SIM
+#include <time.h>
+#endif
+
+// 最后一个串行里程碑，之后都是并行阶段
+#define BOOT_SERIAL_LAST BOOT_SCHED
+
+/**
+ * @brief  一个阶段的记录（us，以复位为0）
+ */
+typedef struct {
+    unsigned int begin_us;
+    unsigned int end_us;
+    unsigned int wait_us; //!< boot_begin中等待依赖阶段的时长
+    const char *task;     //!< 执行该阶段的任务
+    unsigned char done;
+} BOOT_REC;
+
+static const char *const boot_name[BOOT_NUM] = {
+    "reset", "main", "clock", "periph", "rtos", "sched", "remote", "cmd", "robot", "lcd", "frame",
+};
+
+// 各并行阶段开始前必须已经结束的阶段
+static const unsigned short boot_deps[BOOT_NUM] = {
+    [BOOT_ROBOT] = BOOT_BIT(BOOT_REMOTE), // 红外解码就绪后才有按键事件可控
+    [BOOT_FRAME] = BOOT_BIT(BOOT_LCD),
+};
+
+static BOOT_REC boot_rec[BOOT_NUM];
+static osEventFlagsId_t boot_evt;
+static StaticEventGroup_t boot_evt_cb;
+static const osEventFlagsAttr_t boot_evt_attributes = {
+    .name    = "boot",
+    .cb_mem  = &boot_evt_cb,
+    .cb_size = sizeof(boot_evt_cb),
+};
+
+#ifdef HOST_SIM
+static unsigned long long boot_host_base;
+
+/**
+ * @brief   主机仿真：单调时钟的微秒数
+ */
+static unsigned long long boot_host_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000U + (unsigned long long)ts.tv_nsec / 1000U;
+}
+
+static unsigned int boot_now(void)
+{
+    return (unsigned int)(boot_host_us() - boot_host_base);
+}
+#else
+static unsigned int boot_cyc; //!< 上一次换算到的周期计数
+static unsigned int boot_us;  //!< 与boot_cyc对应的时间
+static unsigned int boot_mhz; //!< 自上一次换算以来的CPU频率（MHz）
+
+/**
+ * @brief   复位以来的微秒数
+ * @note    把上一次换算以来的周期按当时的频率累加，再记下当前频率；调度器运行后在临界区内换算
+ */
+static unsigned int boot_now(void)
+{
+    const unsigned char locked = osKernelGetState() == osKernelRunning;
+    unsigned int d, now;
+
+    if (locked) taskENTER_CRITICAL();
+    d        = cpu_stats_cycles() - boot_cyc;
+    boot_us += d / boot_mhz;
+    boot_cyc += d - d % boot_mhz;
+    boot_mhz = SystemCoreClock / 1000000U;
+    now      = boot_us;
+    if (locked) taskEXIT_CRITICAL();
+    return now;
+}
+#endif
+
+/**
+ * @brief   当前执行者的名称
+ */
+static const char *boot_task(void)
+{
+    return osKernelGetState() == osKernelRunning ? osThreadGetName(osThreadGetId()) : "main";
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   开始启动剖析并标记进入main
+ * @retval  None
+ * @note    main的第一条语句（USER CODE 1）
+ */
+void boot_start(void)
+{
+#ifdef HOST_SIM
+    boot_host_base = boot_host_us();
+#else
+    // SystemInit已清零周期计数器，此时仍运行在复位后的HSI
+    boot_cyc = 0;
+    boot_us  = 0;
+    boot_mhz = SystemCoreClock / 1000000U;
+#endif
+    boot_rec[BOOT_RESET].task = "reset";
+    boot_rec[BOOT_RESET].done = 1;
+    boot_mark(BOOT_MAIN);
+}
+
+/**
+ * @brief   标记一个串行里程碑结束（从上一个里程碑结束开始计）
+ * @param   stage: BOOT_MAIN~BOOT_RTOS
+ * @retval  None
+ */
+void boot_mark(BOOT_STAGE stage)
+{
+    BOOT_REC *r = &boot_rec[stage];
+
+    r->begin_us = boot_rec[stage - 1].end_us;
+    r->end_us   = boot_now();
+    r->task     = boot_task();
+    r->done     = 1;
+}
+
+/**
+ * @brief   创建阶段事件标志
+ * @retval  None
+ * @note    在MX_FREERTOS_Init开头调用，之后才能调用boot_begin/boot_end
+ */
+void boot_init(void)
+{
+    boot_evt = osEventFlagsNew(&boot_evt_attributes);
+}
+
+/**
+ * @brief   开始一个并行阶段：等待它依赖的阶段全部结束
+ * @param   stage: BOOT_SCHED之后的阶段
+ * @retval  None
+ * @note    由执行该阶段的任务调用（定时器服务任务中调用的阶段不能有依赖）；
+ *          第一个开始的并行阶段同时标记调度器启动
+ */
+void boot_begin(BOOT_STAGE stage)
+{
+    BOOT_REC *r          = &boot_rec[stage];
+    const unsigned int t = boot_now();
+
+    taskENTER_CRITICAL();
+    if (!boot_rec[BOOT_SCHED].done) {
+        boot_rec[BOOT_SCHED].begin_us = boot_rec[BOOT_RTOS].end_us;
+        boot_rec[BOOT_SCHED].end_us   = t;
+        boot_rec[BOOT_SCHED].task     = "kernel";
+        boot_rec[BOOT_SCHED].done     = 1;
+    }
+    taskEXIT_CRITICAL();
+    r->task = boot_task();
+    if (boot_deps[stage] != 0) {
+        (void)osEventFlagsWait(boot_evt, boot_deps[stage], osFlagsWaitAll | osFlagsNoClear, osWaitForever);
+    }
+    r->begin_us = boot_now();
+    r->wait_us  = r->begin_us - t;
+}
+
+/**
+ * @brief   结束一个并行阶段，放行依赖它的阶段
+ * @param   stage: BOOT_SCHED之后的阶段
+ * @retval  None
+ */
+void boot_end(BOOT_STAGE stage)
+{
+    boot_rec[stage].end_us = boot_now();
+    boot_rec[stage].done   = 1;
+    osEventFlagsSet(boot_evt, BOOT_BIT(stage));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印启动时间线（BOOT命令，多行应答，单位us，以复位为0）
+ * @note    首行ready为全部并行阶段结束的时刻（未全部结束时为-），last为最后结束的阶段；
+ *          每行为开始/结束时刻、时长、等待依赖的时长与执行者，未结束的阶段结束时刻为-
+ */
+void boot_report(void)
+{
+    unsigned int i, ready = 0, last = BOOT_SERIAL_LAST, pending = 0;
+    const BOOT_REC *r;
+
+    for (i = BOOT_SERIAL_LAST + 1; i < BOOT_NUM; i++) {
+        if (!boot_rec[i].done) pending++;
+        if (boot_rec[i].done && boot_rec[i].end_us >= ready) {
+            ready = boot_rec[i].end_us;
+            last  = i;
+        }
+    }
+    if (pending == 0) {
+        myprintf("BOOT ready=%u last=%s us\r\n", ready, boot_name[last]);
+    } else {
+        myprintf("BOOT ready=- pending=%u us\r\n", pending);
+    }
+    myprintf("  %-6s %8s %8s %7s %6s %s\r\n", "stage", "begin", "end", "dur", "wait", "task");
+    for (i = 0; i < BOOT_NUM; i++) {
+        r = &boot_rec[i];
+        if (r->done) {
+            myprintf("  %-6s %8u %8u %7u %6u %s\r\n", boot_name[i], r->begin_us, r->end_us, r->end_us - r->begin_us,
+                     r->wait_us, r->task);
+        } else {
+            myprintf("  %-6s %8u %8s %7s %6s %s\r\n", boot_name[i], r->begin_us, "-", "-", "-",
+                     r->task != NULL ? r->task : "-");
+        }
+    }
+}
@@ -0,0 +1,273 @@
+/**
+ * @file    cpu_stats.c
+ * @brief   任务CPU占用统计（FreeRTOS运行时间统计）
+ * @note    运行时间时钟取自DWT周期计数器（configGENERATE_RUN_TIME_STATS），
+ *          任务切入次数由traceTASK_SWITCHED_IN钩子累计（见FreeRTOSConfig.h）。
+ *          软件定时器每CPU_STATS_WINDOW_MS采样一次uxTaskGetSystemState，与上一次采样做差得到
+ *          窗口内各任务的CPU占用与切换次数，连同栈最低剩余与任务状态保存为最近一个完整窗口，
+ *          STATS命令与LCD统计页都读取这份数据，采样本身只在定时器服务任务中进行。
+ *          主机仿真构建（HOST_SIM）改用CLOCK_MONOTONIC微秒计数。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+#include "cpu_stats.h"
+#include "myprintf.h"
+
+#ifdef HOST_SIM
+#include <time.h>
+#define CPU_STATS_HZ 1000000U
+#else
+#define CPU_STATS_HZ (SystemCoreClock >> CPU_STATS_SHIFT)
+#endif
+
+// 各任务切入次数（PendSV中累加，按任务编号索引）
+static volatile unsigned int cpu_sw[CPU_STATS_MAX_TASKS];
+static unsigned int cpu_sw_last;
+// 上一次采样的累计值（仅定时器服务任务访问）
+static TaskStatus_t cpu_status[CPU_STATS_MAX_TASKS];
+static unsigned int cpu_prev_rt[CPU_STATS_MAX_TASKS];
+static unsigned int cpu_prev_sw[CPU_STATS_MAX_TASKS];
+static unsigned int cpu_prev_total;
+// 最近一个完整窗口（读写都在调度器挂起期间拷贝）
+static CPU_STATS_VIEW cpu_view;
+
+static osTimerId_t cpu_stats_timer;
+static StaticTimer_t cpu_stats_timer_cb;
+static const osTimerAttr_t cpu_stats_timer_attributes = {
+    .name    = "cpu_stats",
+    .cb_mem  = &cpu_stats_timer_cb,
+    .cb_size = sizeof(cpu_stats_timer_cb),
+};
+
+#ifdef HOST_SIM
+void configureTimerForRunTimeStats(void)
+{
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)((unsigned long long)ts.tv_sec * 1000000U + (unsigned long long)ts.tv_nsec / 1000U);
+}
+
+void cpu_stats_add_sleep(unsigned int cycles)
+{
+    (void)cycles;
+}
+
+/**
+ * @brief   主机仿真的CPU周期计数：CLOCK_MONOTONIC按SystemCoreClock折算为周期（32位回绕）
+ * @note    调用方用SystemCoreClock把周期差换算为时间，与目标板上的换算方式相同
+ */
+unsigned int cpu_stats_cycles(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int)(((unsigned long long)ts.tv_sec * 1000000000U + (unsigned long long)ts.tv_nsec) *
+                          (SystemCoreClock / 1000000U) / 1000U);
+}
+#else
+static unsigned int cpu_cyc_last;
+static unsigned int cpu_cyc_high;
+// 睡眠期间DWT未计的周期（由power.c在醒来后补充）
+static unsigned long long cpu_cyc_sleep;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   运行时间时钟初始化（portCONFIGURE_TIMER_FOR_RUN_TIME_STATS，由vTaskStartScheduler调用）
+ * @note    打开DWT周期计数器；遥测与串口驱动的延迟统计也使用这个计数器
+ */
+void configureTimerForRunTimeStats(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cpu_cyc_last = DWT->CYCCNT;
+}
+
+/**
+ * @brief   读取运行时间计数（portGET_RUN_TIME_COUNTER_VALUE）
+ * @retval  （64位周期计数 + 睡眠补偿）右移CPU_STATS_SHIFT位后的低32位
+ * @note    只在任务切换（PendSV）和调度器挂起期间被调用，不会重入；
+ *          32位周期计数约60s回绕一次，统计定时器每秒至少引起一次任务切换，回绕不会被漏掉
+ */
+unsigned long getRunTimeCounterValue(void)
+{
+    unsigned int now = DWT->CYCCNT;
+
+    if (now < cpu_cyc_last) cpu_cyc_high++;
+    cpu_cyc_last = now;
+    return (unsigned long)(((((unsigned long long)cpu_cyc_high << 32) | now) + cpu_cyc_sleep) >> CPU_STATS_SHIFT);
+}
+
+/**
+ * @brief   补充睡眠期间DWT没有计入的周期（无节拍空闲醒来后、关中断状态下调用）
+ * @param   cycles: 周期数
+ */
+void cpu_stats_add_sleep(unsigned int cycles)
+{
+    cpu_cyc_sleep += cycles;
+}
+
+/**
+ * @brief   经过睡眠补偿的CPU周期计数（32位回绕）
+ * @note    DWT周期计数在WFI睡眠期间不增加，跨越空闲睡眠测量时间间隔（遥测抖动、串口等待）时用它代替DWT->CYCCNT；
+ *          中断中也可调用
+ */
+unsigned int cpu_stats_cycles(void)
+{
+    return DWT->CYCCNT + (unsigned int)cpu_cyc_sleep;
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   任务切入钩子（traceTASK_SWITCHED_IN，在PendSV中调用）
+ * @param   number: 切入任务的编号（TCB中的uxTCBNumber）
+ * @note    同一任务被重新选中不算切换
+ */
+void cpu_stats_switched_in(unsigned int number)
+{
+    if (number == cpu_sw_last) return;
+    cpu_sw_last = number;
+    if (number < CPU_STATS_MAX_TASKS) cpu_sw[number]++;
+}
+
+/**
+ * @brief   状态枚举转显示字符
+ */
+static unsigned char cpu_stats_state_char(eTaskState state)
+{
+    static const char states[] = "XRBSD";
+
+    return (unsigned int)state < sizeof(states) - 1 ? states[state] : '?';
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   统计窗口采样（软件定时器回调，在定时器服务任务中执行）
+ * @param   argument: 未使用
+ * @retval  None
+ * @note    各任务按编号排序；编号超出CPU_STATS_MAX_TASKS的任务不统计
+ */
+static void cpu_stats_sample(void *argument)
+{
+    uint32_t total;
+    unsigned int delta_total, num, i, j, n, rt, sw, busy;
+    CPU_STATS_TASK *t;
+    (void)argument;
+
+    num = uxTaskGetSystemState(cpu_status, CPU_STATS_MAX_TASKS, &total);
+    if (num == 0) return;
+    delta_total = total - cpu_prev_total;
+    if (delta_total < 1000) return;
+    cpu_prev_total = total;
+
+    vTaskSuspendAll();
+    cpu_view.num      = 0;
+    cpu_view.switches = 0;
+    busy              = 1000;
+    for (i = 0; i < num; i++) {
+        n = cpu_status[i].xTaskNumber;
+        if (n >= CPU_STATS_MAX_TASKS) continue;
+        rt = cpu_status[i].ulRunTimeCounter - cpu_prev_rt[n];
+        sw = cpu_sw[n] - cpu_prev_sw[n];
+        cpu_prev_rt[n] = cpu_status[i].ulRunTimeCounter;
+        cpu_prev_sw[n] = cpu_sw[n];
+
+        // 按任务编号插入排序，显示顺序固定
+        for (j = cpu_view.num; j > 0 && cpu_view.task[j - 1].number > n; j--) {
+            cpu_view.task[j] = cpu_view.task[j - 1];
+        }
+        t = &cpu_view.task[j];
+        strncpy(t->name, cpu_status[i].pcTaskName, sizeof(t->name) - 1);
+        t->name[sizeof(t->name) - 1] = '\0';
+        t->number         = n;
+        t->state          = cpu_stats_state_char(cpu_status[i].eCurrentState);
+        t->prio           = cpu_status[i].uxCurrentPriority;
+        t->permille       = rt / (delta_total / 1000) > 1000 ? 1000 : rt / (delta_total / 1000);
+        t->stack_free     = cpu_status[i].usStackHighWaterMark;
+        t->switches       = sw;
+        t->switches_total = cpu_sw[n];
+        cpu_view.switches += sw;
+        cpu_view.num++;
+        // 空闲任务名为tasks.c中configIDLE_TASK_NAME的默认值
+        if (strcmp(t->name, "IDLE") == 0) busy -= t->permille;
+    }
+    cpu_view.busy_permille = busy;
+    cpu_view.window_us     = (unsigned int)((unsigned long long)delta_total * 1000000U / CPU_STATS_HZ);
+    cpu_view.seq++;
+    xTaskResumeAll();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   创建并启动统计窗口定时器
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中调用，首个完整窗口在启动后CPU_STATS_WINDOW_MS时生成；
+ *          定时器控制块静态分配，osTimerNew仍会从FreeRTOS堆申请8字节保存回调函数与参数
+ */
+void cpu_stats_init(void)
+{
+    cpu_stats_timer = osTimerNew(cpu_stats_sample, osTimerPeriodic, NULL, &cpu_stats_timer_attributes);
+    osTimerStart(cpu_stats_timer, CPU_STATS_WINDOW_MS);
+}
+
+/**
+ * @brief   拷贝最近一个完整窗口
+ * @param   dst: 输出（约530字节，调用者应静态分配）
+ */
+void cpu_stats_get(CPU_STATS_VIEW *dst)
+{
+    vTaskSuspendAll();
+    memcpy(dst, &cpu_view, sizeof(cpu_view));
+    xTaskResumeAll();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印最近一个窗口的统计（STATS命令，多行应答）
+ * @note    第一行为汇总，之后每个任务一行：名称 状态 优先级 CPU占用 窗口/累计切换次数 栈最低剩余（字）
+ */
+void cpu_stats_report(void)
+{
+    static CPU_STATS_VIEW view;
+    unsigned int i;
+    CPU_STATS_TASK *t;
+
+    cpu_stats_get(&view);
+    if (view.seq == 0) {
+        myprintf("STATS no window yet\r\n");
+        return;
+    }
+    myprintf("STATS win=%ums cpu=%u.%u%% sw=%u tasks=%u\r\n", view.window_us / 1000, view.busy_permille / 10,
+             view.busy_permille % 10, view.switches, view.num);
+    for (i = 0; i < view.num; i++) {
+        t = &view.task[i];
+        myprintf("  %-16s %c %2u %3u.%u%% sw=%u/%u stk=%u\r\n", t->name, t->state, t->prio, t->permille / 10,
+                 t->permille % 10, t->switches, t->switches_total, t->stack_free);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印FreeRTOS堆使用情况（HEAP命令，单行应答）
+ * @note    任务、队列、信号量与定时器控制块均已静态分配，堆只剩CMSIS-RTOS2封装内部的少量申请
+ *          （osTimerNew的回调结构），allocs应在启动后保持不变，min为上电以来的最低剩余
+ */
+void cpu_stats_heap_report(void)
+{
+    HeapStats_t hs;
+
+    vPortGetHeapStats(&hs);
+    myprintf("HEAP size=%u free=%u min=%u largest=%u allocs=%u frees=%u\r\n", (unsigned int)configTOTAL_HEAP_SIZE,
+             (unsigned int)hs.xAvailableHeapSpaceInBytes, (unsigned int)hs.xMinimumEverFreeBytesRemaining,
+             (unsigned int)hs.xSizeOfLargestFreeBlockInBytes, (unsigned int)hs.xNumberOfSuccessfulAllocations,
+             (unsigned int)hs.xNumberOfSuccessfulFrees);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file    ctrl_loop.c
+ * @brief   定时器释放的固定频率控制周期（TIM7更新中断 + 线程标志）
+ * @note    TIM7以1MHz计数，每个控制周期产生一次更新中断；中断只记录时间戳、累加释放次数并置位CTRL_LOOP_EVT，
+ *          控制任务（RobotmainContro，应用任务中优先级最高）在ctrl_loop_wait中等待该标志，醒来即开始一个周期。
+ *          不用裸任务通知：CMSIS-RTOS2线程标志占用任务通知值，而控制任务同时还要等待分区发布事件。
+ *          周期之间的唯一阻塞点是ctrl_loop_wait，周期内的代码不能调用任何会阻塞的接口（osDelay、带超时的队列/锁等）。
+ *          控制频率可在CTRL_LOOP_HZ_MIN~CTRL_LOOP_HZ_MAX之间修改（CTRL_RATE命令），
+ *          修改请求由控制任务在周期之间生效（ARR预装载，下一个更新事件起按新周期），同时清零统计。
+ *          没有需要控制的对象时控制任务可以用ctrl_loop_stop停止定时器、阻塞等待事件，再用ctrl_loop_start重新开始，
+ *          避免空转的周期中断妨碍无节拍空闲睡眠。
+ *          CTRL命令打印释放延迟、周期抖动、执行时间与超预算/漏周期计数；
+ *          抖动/执行时间/超预算来自周期监视（period_mon，预算即截止期限），PERIODS命令中名为robot。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "tim.h"
+
+#include "ctrl_loop.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+#include "period_mon.h"
+
+#define CTRL_CYC_PER_US (SystemCoreClock / 1000000U)
+
+static osThreadId_t ctrl_task;
+static unsigned int ctrl_hz = CTRL_LOOP_HZ_DEFAULT;
+static volatile unsigned int ctrl_hz_req;     //!< 待生效的新频率，0表示没有请求
+static volatile unsigned int ctrl_release;    //!< 最近一次更新中断的时刻（cpu_stats_cycles）
+static volatile unsigned int ctrl_releases;   //!< 更新中断次数（只由中断写）
+static unsigned int ctrl_seen;                //!< 控制任务已处理到的释放次数
+// 周期状态：0周期之间，1周期执行中，2执行中又来了一次释放（中断置位，周期结束时计入miss）
+static volatile unsigned char ctrl_busy;
+static volatile unsigned char ctrl_running;   //!< 定时器已启动
+static CTRL_LOOP_STAT ctrl_stat = {.lat_min = ~0U};
+// 抖动/执行时间/超预算统计（PERIODS命令中的robot）
+static PERIOD_MON ctrl_mon;
+
+/**
+ * @brief   当前频率下的周期与执行预算（us）
+ */
+static unsigned int ctrl_loop_period_us(void)
+{
+    return CTRL_LOOP_TIM_HZ / ctrl_hz;
+}
+
+static unsigned int ctrl_loop_budget_us(void)
+{
+    return CTRL_LOOP_TIM_HZ / ctrl_hz * CTRL_LOOP_BUDGET_PCT / 100U;
+}
+
+/**
+ * @brief   清零统计（控制任务中调用）
+ */
+static void ctrl_loop_reset(void)
+{
+    ctrl_stat         = (CTRL_LOOP_STAT){0};
+    ctrl_stat.lat_min = ~0U;
+    period_mon_set(&ctrl_mon, ctrl_loop_period_us(), ctrl_loop_budget_us());
+}
+
+/**
+ * @brief   应用待生效的频率（周期之间调用）
+ */
+static void ctrl_loop_apply_rate(void)
+{
+    unsigned int hz = ctrl_hz_req;
+
+    if (hz == 0) return;
+    ctrl_hz_req = 0;
+    ctrl_hz     = hz;
+    __HAL_TIM_SET_AUTORELOAD(&htim7, CTRL_LOOP_TIM_HZ / hz - 1U);
+    ctrl_loop_reset();
+}
+
+/**
+ * @brief   结束当前周期：统计执行时间与漏掉的释放
+ */
+static void ctrl_loop_end(void)
+{
+    unsigned char late;
+
+    period_mon_end(&ctrl_mon);
+    taskENTER_CRITICAL();
+    late      = ctrl_busy == 2;
+    ctrl_busy = 0;
+    taskEXIT_CRITICAL();
+    if (late) ctrl_stat.miss++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   登记控制周期的周期监视
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中调用
+ */
+void ctrl_loop_init(void)
+{
+    period_mon_init(&ctrl_mon, "robot", ctrl_loop_period_us(), ctrl_loop_budget_us());
+}
+
+/**
+ * @brief   启动控制周期定时器
+ * @retval  None
+ * @note    由控制任务调用，调用者成为接收释放标志的任务；第一个周期在一个控制周期后释放
+ */
+void ctrl_loop_start(void)
+{
+    ctrl_task = osThreadGetId();
+    if (ctrl_hz_req) {
+        ctrl_loop_apply_rate();
+    } else {
+        __HAL_TIM_SET_AUTORELOAD(&htim7, CTRL_LOOP_TIM_HZ / ctrl_hz - 1U);
+    }
+    period_mon_restart(&ctrl_mon);
+    __HAL_TIM_SET_COUNTER(&htim7, 0);
+    __HAL_TIM_CLEAR_FLAG(&htim7, TIM_FLAG_UPDATE);
+    // 丢弃停止之前留下的释放
+    osThreadFlagsClear(CTRL_LOOP_EVT);
+    ctrl_seen    = ctrl_releases;
+    ctrl_running = 1;
+    HAL_TIM_Base_Start_IT(&htim7);
+}
+
+/**
+ * @brief   结束当前周期并停止定时器
+ * @retval  None
+ * @note    由控制任务在周期内调用，之后可以阻塞等待事件，再调用ctrl_loop_start继续
+ */
+void ctrl_loop_stop(void)
+{
+    HAL_TIM_Base_Stop_IT(&htim7);
+    ctrl_running = 0;
+    if (ctrl_busy) ctrl_loop_end();
+}
+
+/**
+ * @brief   结束当前周期，阻塞到下一次定时器释放
+ * @retval  None
+ * @note    控制任务每个周期开头调用一次，返回即进入新周期
+ */
+void ctrl_loop_wait(void)
+{
+    unsigned int n, lat;
+
+    if (ctrl_busy) ctrl_loop_end();
+    ctrl_loop_apply_rate();
+
+    (void)osThreadFlagsWait(CTRL_LOOP_EVT, osFlagsWaitAny, osWaitForever);
+    period_mon_begin(&ctrl_mon);
+    ctrl_busy = 1;
+
+    // 两次等待之间到达的多次释放被合并成一个周期，多出的同样是漏掉的周期
+    n         = ctrl_releases - ctrl_seen;
+    ctrl_seen += n;
+    if (n > 1U) ctrl_stat.miss += n - 1U;
+    lat = ctrl_mon.t_start - ctrl_release;
+    if (lat < ctrl_stat.lat_min) ctrl_stat.lat_min = lat;
+    if (lat > ctrl_stat.lat_max) ctrl_stat.lat_max = lat;
+    ctrl_stat.lat_sum += lat;
+    ctrl_stat.cycles++;
+}
+
+/**
+ * @brief   当前控制频率（Hz）
+ */
+unsigned int ctrl_loop_hz(void)
+{
+    return ctrl_hz;
+}
+
+/**
+ * @brief   请求修改控制频率（CTRL_RATE命令）
+ * @param   hz: 新频率，CTRL_LOOP_HZ_MIN~CTRL_LOOP_HZ_MAX
+ * @retval  0: 已提交，在控制任务下一次周期之间生效；-1: 超出范围
+ */
+int ctrl_loop_set_rate(unsigned int hz)
+{
+    if (hz < CTRL_LOOP_HZ_MIN || hz > CTRL_LOOP_HZ_MAX) return -1;
+    ctrl_hz_req = hz;
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   控制周期释放（TIM7更新中断，由HAL_TIM_PeriodElapsedCallback调用）
+ * @retval  None
+ */
+void ctrl_loop_isr(void)
+{
+    ctrl_release = cpu_stats_cycles();
+    ctrl_releases++;
+    if (ctrl_busy) ctrl_busy = 2;
+    if (ctrl_task != NULL) osThreadFlagsSet(ctrl_task, CTRL_LOOP_EVT);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印控制周期统计（CTRL命令，单行应答，时间单位us）
+ * @note    lat/exec为min/平均/max，exec最后一项是预算；run/park表示定时器运行或控制任务已停下等待事件
+ */
+void ctrl_loop_report(void)
+{
+    const CTRL_LOOP_STAT s = ctrl_stat;
+    const PERIOD_MON *m    = &ctrl_mon;
+    const unsigned int n   = s.cycles ? s.cycles : 1U;
+
+    myprintf("CTRL hz=%u %s n=%u miss=%u over=%u lat=%u/%u/%u jit=%u exec=%u/%u/%u/%u us\r\n", ctrl_hz,
+             ctrl_running ? "run" : "park", s.cycles, s.miss, m->miss,
+             s.cycles ? s.lat_min / CTRL_CYC_PER_US : 0U, (unsigned int)(s.lat_sum / n) / CTRL_CYC_PER_US,
+             s.lat_max / CTRL_CYC_PER_US, m->jit_max / CTRL_CYC_PER_US,
+             m->n ? m->exec_min / CTRL_CYC_PER_US : 0U, m->n ? (unsigned int)(m->exec_sum / m->n) / CTRL_CYC_PER_US : 0U,
+             m->exec_max / CTRL_CYC_PER_US, m->deadline_us);
+}
@@ -2,9 +2,9 @@
  ****************************************************************************************************
  * @file        delay.c
  * @author      ԭŶ(ALIENTEK)
- * @version     V1.1
- * @date        2023-02-25
- * @brief       ʹSysTickͨģʽӳٽй(֧ucosii)
+ * @version     V1.2
+ * @date        2026-10-19
+ * @brief       usʱ׼(TIM5+TIM132λɼ)ʱ
  *              ṩdelay_initʼ delay_usdelay_msʱ
  * @license     Copyright (c) 2022-2032, ӿƼ޹˾
  ****************************************************************************************************
@@ -24,192 +24,330 @@
  * ޸delay_initʹ8Ƶ,ȫͳһʹMCUʱ
  * ޸delay_usʹʱժȡʱ, OS
  * ޸delay_msֱʹdelay_usʱʵ.
+ * V1.2 20261019
+ * ɾSYS_SUPPORT_OS(ucosii), ٶдSysTick(FreeRTOSֲ)
+ * TIM5+TIM132λusʱ, һĵʱȴαȽж, ʱæȵ
+ * DELAYͳ
  *
  ****************************************************************************************************
  */
 
+#include "FreeRTOS.h"
+#include "task.h"
 #include "main.h"
 #include "cmsis_os.h"
-#include "dma.h"
-#include "usart.h"
-#include "gpio.h"
+#include "tim.h"
 
 #include "delay.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
 
+#ifdef HOST_SIM
+#include <time.h>
+#endif
 
-static uint32_t g_fac_us = 0;       /* usʱ */
+/*
+ *  usʱ׼: TIM51MHzɼ(16λ), TRGOTIM1(ITR0, 16λ), 32λus.
+ *  SysTickFreeRTOSֲ, ļٶд.
+ *
+ *  ʱ:
+ *  - һĵĶʱ, Լж/ٽ/δʱʱ: ѯʱ׼æ,
+ *    Ҳж, ڼȼճռ(ռֻʱ䳤, ).
+ *  - һĵĳʱ(): ռTIM5һȽͨ, ϵαȽжϺ̱߳־DELAY_EVT,
+ *    жȷϵʱλñ־, CPUڵȴڼ佻˯. 16λΧĵȴж¹ұȽ.
+ *    4Ƚͨͬʱ4ȴ, ͨʱ˻æ.
+ *  DELAYӡæ/Ĵۼʱ(æʱʱ˷ѵCPU)ѵĳٵʱ뱾Ĺжʱ.
+ */
 
-/* SYS_SUPPORT_OS,˵Ҫ֧OS(UCOS) */
-#if SYS_SUPPORT_OS
+#define DELAY_TIM_LO        TIM5                                /* 16λ, Ƚͨ1~4 */
+#define DELAY_TIM_HI        TIM1                                /* 16λ */
+#define DELAY_CH_NUM        4U
+#define DELAY_EVT           0x40000000U                         /* ȴ̱߳־(õı־ͻ) */
+#define DELAY_BLOCK_MIN_US  (1000000U / configTICK_RATE_HZ)     /* ʱ */
 
-/* ӹͷļ ( ucosҪõ) */
-#include "os.h"
+/* ڱȽͨϵ */
+typedef struct
+{
+    osThreadId_t task;
+    uint32_t target;                    /* ʱʱ(delay_now_us) */
+} DELAY_WAITER;
 
-/* g_fac_ms, ʾmsʱı, ÿĵms, (ʹosʱ,Ҫõ) */
-static uint16_t g_fac_ms = 0;
+/* ʱͳ(DELAY) */
+typedef struct
+{
+    uint32_t spin_n, block_n;
+    unsigned long long spin_us;         /* æۼʱ, ʱ˷ѵCPU */
+    unsigned long long block_us;        /* ۼʱ, óCPU */
+    uint32_t spin_max;                  /* һæ(us) */
+    unsigned long long late_sum;        /* ڵʱʱ̵ۼ(us) */
+    uint32_t late_max;
+    uint32_t busy;                      /* Ƚͨ˻æȵĴ */
+    uint32_t lock_max;                  /* Ĺжʱ(CPU) */
+} DELAY_STAT;
+
+static DELAY_WAITER g_delay_waiter[DELAY_CH_NUM];
+static volatile uint8_t g_delay_ch_used;                        /* ռõıȽͨ(λͼ) */
+static volatile uint8_t g_delay_running;                        /* ʱ׼ */
+static DELAY_STAT g_delay_stat;
 
-/*
- *  delay_us/delay_msҪ֧OSʱҪOSصĺ궨ͺ֧
- *  3궨:
- *      delay_osrunning    :ڱʾOSǰǷ,ԾǷʹغ
- *      delay_ostickspersec:ڱʾOS趨ʱӽ,delay_initʼsystick
- *      delay_osintnesting :ڱʾOSжǶ׼,Ϊж治Ե,delay_msʹøò
- *  Ȼ3:
- *      delay_osschedlock  :OS,ֹ
- *      delay_osschedunlock:ڽOS,¿
- *      delay_ostimedly    :OSʱ,.
- *
- *  ̽UCOSII֧,OS,вοֲ
+/**
+ * @brief     ȡusʱ׼
+ * @param     
+ * @retval    us(32λ, Լ71ӻ, òֵȽ)
+ * @note      жжɵ, ж: ζ16λ֮16λض.
+ *            TIM5TIM1Ҫʱڵͬż1, Ե16λΪ01usҲض.
+ *            delay_init֮ǰ0(¼־ʱ֮ǰҪ¼).
+ *            湹дģʽʱ, CLOCK_MONOTONIC(ͬdelay_initʱΪ0)
  */
+#ifdef HOST_SIM
+static unsigned long long g_delay_host_base;                    /* delay_initʱ */
 
-/* ֧UCOSII */
-#define delay_osrunning     OSRunning           /* OSǷб,0,;1, */
-#define delay_ostickspersec OS_TICKS_PER_SEC    /* OSʱӽ,ÿȴ */
-#define delay_osintnesting  OSIntNesting        /* жǶ׼,жǶ״ */
+static unsigned long long delay_host_us(void)
+{
+    struct timespec ts;
 
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000U + (unsigned long long)ts.tv_nsec / 1000U;
+}
+
+uint32_t delay_now_us(void)
+{
+    if (!g_delay_running) return 0;
+
+    return (uint32_t)(delay_host_us() - g_delay_host_base);
+}
+#else
+uint32_t delay_now_us(void)
+{
+    uint32_t hi, lo;
+
+    if (!g_delay_running) return 0;
+
+    do
+    {
+        hi = DELAY_TIM_HI->CNT;
+        lo = DELAY_TIM_LO->CNT;
+    } while (hi != DELAY_TIM_HI->CNT || lo == 0U);
+
+    return (hi << 16) | lo;
+}
+#endif
 
 /**
- * @brief     usʱʱ,ر(ֹusӳ)
+ * @brief     ʼӳٺ: usʱ׼
  * @param     
  * @retval    
+ * @note      mainMX_TIM1_Init/MX_TIM5_Init֮; ǰʱDWTڼæ.
+ *            TIM1TIM5, һᶪ
  */
-void delay_osschedlock(void)
+void delay_init(void)
 {
-    OSSchedLock();                      /* UCOSIIķʽ,ֹȣֹusʱ */
+    HAL_TIM_Base_Start(&htim1);
+    HAL_TIM_Base_Start(&htim5);
+#ifdef HOST_SIM
+    g_delay_host_base = delay_host_us();
+#endif
+    g_delay_running = 1;
 }
 
 /**
- * @brief     usʱʱ,ָ
- * @param     
- * @retval    
+ * @brief     ¼һæ
  */
-void delay_osschedunlock(void)
+static void delay_spin_account(uint32_t us)
 {
-    OSSchedUnlock();                    /* UCOSIIķʽ,ָ */
+    UBaseType_t s = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    g_delay_stat.spin_n++;
+    g_delay_stat.spin_us += us;
+    if (us > g_delay_stat.spin_max) g_delay_stat.spin_max = us;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
 }
 
 /**
- * @brief     usʱʱ,ָ
- * @param     ticks: ʱĽ
- * @retval    
+ * @brief     ǰܷ: Сжûйж
  */
-void delay_ostimedly(uint32_t ticks)
+static int delay_can_block(void)
 {
-    OSTimeDly(ticks);                               /* UCOSIIʱ */
+    return osKernelGetState() == osKernelRunning && __get_IPSR() == 0U && __get_PRIMASK() == 0U &&
+           __get_BASEPRI() == 0U;
 }
 
 /**
- * @brief     systickжϷ,ʹOSʱõ
- * @param     ticks : ʱĽ  
- * @retval    
- */  
-void SysTick_Handler(void)
+ * @brief     ѱȽͨchҵtargetʱ(жϻTIM5же)
+ * @param     ch: Ƚͨ(0~3)
+ * @param     target: ʱʱ
+ * @retval    >0: ѹ, us; <=0: Ѿʱ(ȽжϿѴҲܲᴥ)
+ * @note      һ65535us, Զĵʱʱж¹
+ */
+static int32_t delay_arm(uint32_t ch, uint32_t target)
+{
+    __IO uint32_t *ccr = &DELAY_TIM_LO->CCR1 + ch * (&DELAY_TIM_LO->CCR2 - &DELAY_TIM_LO->CCR1);
+    int32_t left = (int32_t)(target - delay_now_us());
+
+    if (left <= 0) return left;
+    if (left > 0xFFFF) left = 0xFFFF;
+    /* ͨжʱȽƥλ־, ; дCCR֮ƥĻʹжϺж */
+    DELAY_TIM_LO->SR = ~(TIM_SR_CC1IF << ch);
+    *ccr = (DELAY_TIM_LO->CNT + (uint32_t)left) & 0xFFFFU;
+    DELAY_TIM_LO->DIER |= TIM_DIER_CC1IE << ch;
+
+    /* CNTдCCR֮ѾԽCCR򲻻ƥ, ʱһѵʱ */
+    return (int32_t)(target - delay_now_us());
+}
+
+/**
+ * @brief     ͷűȽͨch(жϵ)
+ */
+static void delay_disarm(uint32_t ch)
+{
+    DELAY_TIM_LO->DIER &= ~(TIM_DIER_CC1IE << ch);
+    g_delay_ch_used &= ~(1U << ch);
+}
+
+/**
+ * @brief     t0 + nusʱ: ռһȽͨ, ȴȽжλ̱߳־
+ * @param     t0: ʱʼʱ
+ * @param     nus: ʱʱ, DELAY_BLOCK_MIN_US
+ * @retval    0: ʱ; -1: Ƚͨ, ɵæ
+ */
+static int delay_block(uint32_t t0, uint32_t nus)
+{
+    const uint32_t target = t0 + nus;
+    uint32_t ch, c0, lock;
+    int32_t left;
+
+    (void)osThreadFlagsClear(DELAY_EVT);
+
+    c0 = cpu_stats_cycles();
+    taskENTER_CRITICAL();
+    for (ch = 0; ch < DELAY_CH_NUM && (g_delay_ch_used & (1U << ch)); ch++)
+    {
+    }
+    if (ch < DELAY_CH_NUM)
+    {
+        g_delay_ch_used |= 1U << ch;
+        g_delay_waiter[ch].task = osThreadGetId();
+        g_delay_waiter[ch].target = target;
+        left = delay_arm(ch, target);
+        if (left <= 0) delay_disarm(ch);
+    }
+    taskEXIT_CRITICAL();
+    lock = cpu_stats_cycles() - c0;
+
+    if (ch == DELAY_CH_NUM)
+    {
+        g_delay_stat.busy++;
+        return -1;
+    }
+
+    if (left > 0)
+    {
+        /* ʱֻǱ(Ƚж϶ʧʱ), ɱȽжϻ */
+        (void)osThreadFlagsWait(DELAY_EVT, osFlagsWaitAny, nus / DELAY_BLOCK_MIN_US + 2U);
+        taskENTER_CRITICAL();
+        delay_disarm(ch);
+        taskEXIT_CRITICAL();
+        (void)osThreadFlagsClear(DELAY_EVT);    /* ʱжϲλı־ */
+    }
+
+    /* ׳ʱȡ, ڵʱʱ; ֻʱ׼Ķ */
+    while ((int32_t)(delay_now_us() - target) < 0)
+    {
+    }
+
+    taskENTER_CRITICAL();
+    g_delay_stat.block_n++;
+    g_delay_stat.block_us += nus;
+    left = (int32_t)(delay_now_us() - target);
+    g_delay_stat.late_sum += (uint32_t)left;
+    if ((uint32_t)left > g_delay_stat.late_max) g_delay_stat.late_max = (uint32_t)left;
+    if (lock > g_delay_stat.lock_max) g_delay_stat.lock_max = lock;
+    taskEXIT_CRITICAL();
+    return 0;
+}
+
+/**
+ * @brief     Ƚж: ʱѵȴ, ¹ұȽ
+ * @param     ch: Ƚͨ(0~3)
+ */
+static void delay_isr(uint32_t ch)
 {
-    /* OS ʼ,ִĵȴ */
-    if (delay_osrunning == OS_TRUE)
+    DELAY_WAITER *w = &g_delay_waiter[ch];
+
+    if (!(g_delay_ch_used & (1U << ch)))
     {
-        /*  uC/OS-II  SysTick жϷ */
-        OS_CPU_SysTickHandler();
+        DELAY_TIM_LO->DIER &= ~(TIM_DIER_CC1IE << ch);
+        return;
     }
-    HAL_IncTick();
+    if (delay_arm(ch, w->target) > 0) return;  /* 16λΧĵȴ, ǰ¼ */
+
+    DELAY_TIM_LO->DIER &= ~(TIM_DIER_CC1IE << ch);
+    osThreadFlagsSet(w->task, DELAY_EVT);
 }
-#endif
 
 /**
- * @brief     ʼӳٺ
- * @param     sysclk: ϵͳʱƵ, CPUƵ(rcc_c_ck), 72MHz
+ * @brief     TIM5Ƚ¼ص(HAL_TIM_IRQHandler)
+ * @param     htim: ʱ
  * @retval    
- */  
-void delay_init(uint16_t sysclk)
+ */
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim)
 {
-#if SYS_SUPPORT_OS                                      /* Ҫ֧OS */
-    uint32_t reload;
-#endif
-    g_fac_us = sysclk;                                  /* HAL_InitѶsystickã */
-#if SYS_SUPPORT_OS                                      /* Ҫ֧OS. */
-    reload = sysclk;                                    /* ÿӵļ λΪM */
-    reload *= 1000000 / delay_ostickspersec;            /* delay_ostickspersec趨ʱ,reloadΪ24λ
-                                                         * Ĵ,ֵ:16777216,72M,Լ0.233s
-                                                         */
-    g_fac_ms = 1000 / delay_ostickspersec;              /* OSʱٵλ */
-    SysTick->CTRL |= 1 << 1;                            /* SYSTICKж */
-    SysTick->LOAD = reload;                             /* ÿ1/delay_ostickspersecжһ */
-    SysTick->CTRL |= 1 << 0;                            /* SYSTICK */
-#endif 
+    uint32_t ch;
+
+    if (htim->Instance != DELAY_TIM_LO) return;
+    for (ch = 0; ch < DELAY_CH_NUM; ch++)
+    {
+        if (htim->Channel == (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << ch)) delay_isr(ch);
+    }
 }
 
 /**
  * @brief     ʱnus
- * @note      ǷʹOS, ʱժȡusʱ
  * @param     nus: Ҫʱus
- * @note      nusȡֵΧ: 0 ~ (2^32 / fac_us) (fac_usһϵͳƵ, )
+ * @note      һҵʱȴȽж, æ();
+ *            ʱ׼֮ǰ(mainʼڼ)DWTڼæ.
+ *            nusȡֵΧ: 0 ~ 2^31
  * @retval    
  */
 void delay_us(uint32_t nus)
 {
-    uint32_t ticks;
-    uint32_t told, tnow, tcnt = 0;
-    uint32_t reload = SysTick->LOAD;        /* LOADֵ */
-    ticks = nus * g_fac_us;                 /* ҪĽ */
-    
-#if SYS_SUPPORT_OS                          /* Ҫ֧OS */
-    delay_osschedlock();                    /*  OS  */
-#endif
+    uint32_t t0, n;
 
-    told = SysTick->VAL;                    /* սʱļֵ */
-    while (1)
+    if (!g_delay_running)
     {
-        tnow = SysTick->VAL;
-        if (tnow != told)
+        t0 = cpu_stats_cycles();
+        n = nus * (SystemCoreClock / 1000000U);
+        while (cpu_stats_cycles() - t0 < n)
         {
-            if (tnow < told)
-            {
-                tcnt += told - tnow;        /* עһSYSTICKһݼļͿ */
-            }
-            else
-            {
-                tcnt += reload - tnow + told;
-            }
-            told = tnow;
-            if (tcnt >= ticks) 
-            {
-                break;                      /* ʱ䳬/Ҫӳٵʱ,˳ */
-            }
         }
+        delay_spin_account(nus);
+        return;
     }
 
-#if SYS_SUPPORT_OS                          /* Ҫ֧OS */
-    delay_osschedunlock();                  /* ָ OS  */
-#endif 
+    t0 = delay_now_us();
+#if DELAY_BLOCK_ENABLE
+    if (nus > DELAY_BLOCK_MIN_US && delay_can_block() && delay_block(t0, nus) == 0) return;
+#endif
 
+    while (delay_now_us() - t0 < nus)
+    {
+    }
+    delay_spin_account(delay_now_us() - t0);
 }
 
 /**
  * @brief     ʱnms
- * @param     nms: Ҫʱms (0< nms <= (2^32 / fac_us / 1000))(fac_usһϵͳƵ, )
+ * @param     nms: Ҫʱms (0< nms <= 65535)
  * @retval    
  */
 void delay_ms(uint16_t nms)
 {
-    
-#if SYS_SUPPORT_OS  /* Ҫ֧OS, osʱͷCPU */
-    if (delay_osrunning && delay_osintnesting == 0)     /* OSѾ,Ҳж(ж治) */
-    {
-        if (nms >= g_fac_ms)                            /* ʱʱOSʱ */
-        {
-            delay_ostimedly(nms / g_fac_ms);            /* OSʱ */
-        }
-
-        nms %= g_fac_ms;                                /* OSѾ޷ṩôСʱ,ͨʽʱ */
-    }
-#endif
-
-    delay_us((uint32_t)(nms * 1000));                   /* ͨʽʱ */
+    delay_us((uint32_t)nms * 1000U);
 }
 
 /**
  * @brief       HALڲõʱ
- * @note        HALʱĬSystickûпSystickжϻᵼµʱ޷˳
+ * @note        HALʱĬϲѯuwTick(TIM6ʱ), usʱ׼, еʱæ
  * @param       Delay : Ҫʱĺ
  * @retval      None
  */
@@ -218,12 +356,22 @@ void HAL_Delay(uint32_t Delay)
      delay_ms(Delay);
 }
 
+/**
+ * @brief       ӡʱͳ(DELAY, Ӧ)
+ * @note        spin/blockΪ/ۼus, spinۼƼʱ˷ѵCPU, maxΪһæ;
+ *              lateΪڵʱʱ̵ƽ/us, busyΪȽͨ˻æȵĴ,
+ *              lockΪĹжʱ(CPU, ֻڹ/ժȽͨʱж, ʱڼ䲻)
+ * @retval      None
+ */
+void delay_report(void)
+{
+    DELAY_STAT s;
 
+    taskENTER_CRITICAL();
+    s = g_delay_stat;
+    taskEXIT_CRITICAL();
 
-
-
-
-
-
-
-
+    myprintf("DELAY spin=%u/%uus max=%uus block=%u/%uus late=%u/%uus busy=%u lock=%ucyc\r\n", s.spin_n,
+             (unsigned int)s.spin_us, s.spin_max, s.block_n, (unsigned int)s.block_us,
+             s.block_n ? (unsigned int)(s.late_sum / s.block_n) : 0U, s.late_max, s.busy, s.lock_max);
+}
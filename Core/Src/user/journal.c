@@ -0,0 +1,247 @@
+/**
+ * @file    journal.c
+ * @brief   复位后保留的事件日志（JOURNAL命令）
+ * @note    事件记录在复位时不清零的RAM区（.noinit）中的环形缓冲里，热启动（复位键、软件复位、看门狗、
+ *          故障后复位）后仍在，现场出问题后接上串口用JOURNAL命令读出复位前发生了什么。
+ *          已记录：启动与复位原因、机械臂模式切换（robot.c）、收到的命令与命令丢弃/接收环覆盖（myprintf.c）、
+ *          周期任务错过截止期限（period_mon.c）、HardFault等故障与Error_Handler（stm32f1xx_it.c/main.c）。
+ *          头部带魔数、布局（记录大小与条数）和校验值，journal_init在启动时校验，不通过（上电、换了布局不同的固件）
+ *          则重新初始化。写入只在屏蔽中断的几条存储指令内完成：先写记录，再写head，最后写校验值，
+ *          校验时同时接受head与校验值之间断开的状态，复位打断写入也不会丢掉整个日志。
+ *          一次写入的CPU周期数见JOURNAL命令首行的cost（现场实测值），可以留在热路径中常开。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "journal.h"
+#include "delay.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+#include "myformat.h"
+#include "period_mon.h"
+
+#define JOURNAL_MAGIC  0x4A524E4CU // "JRNL"
+#define JOURNAL_LAYOUT (((uint32_t)sizeof(JOURNAL_REC) << 16) | JOURNAL_CAP)
+
+/**
+ * @brief  日志头部
+ * @note   check = ~(magic + layout + boots + head)，head为累计写入的条数（不回绕到容量）
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t layout;
+    uint32_t boots; //!< 头部建立以来的启动次数
+    uint32_t head;
+    uint32_t check;
+} JOURNAL_HDR;
+
+typedef struct {
+    JOURNAL_HDR hdr;
+    JOURNAL_REC rec[JOURNAL_CAP];
+} JOURNAL;
+
+static JOURNAL journal NOINIT;
+
+// 以下是本次启动的状态，在普通.bss中
+static uint32_t journal_base;     //!< magic + layout + boots，写入时只需再加head
+static uint8_t journal_boot8;     //!< boots的低8位（记录中的boot）
+static uint8_t journal_retained;  //!< 本次启动时之前的记录通过了校验
+static uint32_t journal_csr;      //!< 本次复位的RCC->CSR
+
+static const char *const journal_type_name[JOURNAL_TYPE_NUM] = {
+    "?", "boot", "mode", "cmd", "fault", "deadline",
+};
+
+static const char *const journal_fault_name[JOURNAL_FAULT_NUM] = {
+    "hard", "mem", "bus", "usage", "hal", "uart_ovr", "cmd_drop",
+};
+
+static const char *const journal_mode_name[] = {"null", "motor1", "motor2", "motor3", "move", "auto"};
+
+/**
+ * @brief   按RCC->CSR给出复位原因（每次复位NRST引脚都会拉低，其他原因优先）
+ */
+static const char *journal_reset_name(uint32_t csr)
+{
+    if (csr & RCC_CSR_LPWRRSTF) return "lpwr";
+    if (csr & RCC_CSR_WWDGRSTF) return "wwdg";
+    if (csr & RCC_CSR_IWDGRSTF) return "iwdg";
+    if (csr & RCC_CSR_SFTRSTF) return "sw";
+    if (csr & RCC_CSR_PORRSTF) return "por";
+    if (csr & RCC_CSR_PINRSTF) return "pin";
+    return "-";
+}
+
+static const char *journal_mode(uint32_t mode)
+{
+    return mode < sizeof(journal_mode_name) / sizeof(journal_mode_name[0]) ? journal_mode_name[mode] : "?";
+}
+
+/**
+ * @brief   头部是否有效（允许复位打断在写head与写check之间）
+ */
+static int journal_valid(void)
+{
+    const JOURNAL_HDR *h = &journal.hdr;
+    const uint32_t base  = h->magic + h->layout + h->boots;
+
+    if (h->magic != JOURNAL_MAGIC || h->layout != JOURNAL_LAYOUT) return 0;
+    return h->check == ~(base + h->head) || h->check == ~(base + h->head - 1U);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   校验保留的日志并记录本次启动
+ * @retval  None
+ * @note    main的USER CODE 1中、boot_start之后调用（越早越好，之后的故障才能记录下来）；
+ *          读出并清除RCC->CSR中的复位标志，时间基准启动之前记录的时刻为0
+ */
+void journal_init(void)
+{
+    JOURNAL_HDR *h = &journal.hdr;
+
+    journal_csr = RCC->CSR;
+    // 不用__HAL_RCC_CLEAR_RESET_FLAGS：它写位带别名区，主机仿真的寄存器空间没有映射
+    SET_BIT(RCC->CSR, RCC_CSR_RMVF);
+    journal_retained = journal_valid();
+    if (!journal_retained) {
+        h->magic  = JOURNAL_MAGIC;
+        h->layout = JOURNAL_LAYOUT;
+        h->boots  = 0;
+        h->head   = 0;
+    }
+    h->boots++;
+    journal_base  = h->magic + h->layout + h->boots;
+    journal_boot8 = (uint8_t)h->boots;
+    h->check      = ~(journal_base + h->head);
+    journal_log(JOURNAL_BOOT, journal_retained, journal_csr);
+}
+
+/**
+ * @brief   写一条事件
+ * @param   type: JOURNAL_TYPE
+ * @param   a, b: 参数，含义见JOURNAL_TYPE
+ * @retval  None
+ * @note    任务与中断（含故障处理）中都可调用，不阻塞；环满后覆盖最旧的一条
+ */
+void journal_log(uint8_t type, uint16_t a, uint32_t b)
+{
+    UBaseType_t s = portSET_INTERRUPT_MASK_FROM_ISR();
+    const uint32_t head = journal.hdr.head;
+    JOURNAL_REC *r      = &journal.rec[head & (JOURNAL_CAP - 1U)];
+
+    r->t              = delay_now_us();
+    r->type           = type;
+    r->boot           = journal_boot8;
+    r->a              = a;
+    r->b              = b;
+    journal.hdr.head  = head + 1U;
+    journal.hdr.check = ~(journal_base + head + 1U);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+}
+
+/**
+ * @brief   清空事件记录（JOURNAL_CLEAR命令，启动次数保留）
+ * @retval  None
+ */
+void journal_clear(void)
+{
+    UBaseType_t s = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    journal.hdr.head  = 0;
+    journal.hdr.check = ~journal_base;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+}
+
+/**
+ * @brief   实测一次journal_log的CPU周期数：写一条后撤销，日志内容不变
+ */
+static unsigned int journal_cost(void)
+{
+    UBaseType_t s = portSET_INTERRUPT_MASK_FROM_ISR();
+    const uint32_t head     = journal.hdr.head;
+    JOURNAL_REC *r          = &journal.rec[head & (JOURNAL_CAP - 1U)];
+    const JOURNAL_REC saved = *r;
+    unsigned int t0, cost;
+
+    t0   = cpu_stats_cycles();
+    journal_log(0, 0, 0);
+    cost = cpu_stats_cycles() - t0;
+    *r                = saved;
+    journal.hdr.head  = head;
+    journal.hdr.check = ~(journal_base + head);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+    return cost;
+}
+
+/**
+ * @brief   按类型解析一条记录的参数
+ */
+static void journal_detail(const JOURNAL_REC *r, char *buf, unsigned int size)
+{
+    const PERIOD_MON *m;
+    char cmd[5];
+    unsigned int i;
+
+    switch (r->type) {
+        case JOURNAL_BOOT:
+            my_snprintf(buf, size, "retained=%u reset=%s csr=0x%08x", r->a, journal_reset_name(r->b), r->b);
+            break;
+        case JOURNAL_MODE:
+            my_snprintf(buf, size, "%s -> %s", journal_mode(r->b), journal_mode(r->a));
+            break;
+        case JOURNAL_CMD:
+            for (i = 0; i < 4; i++) {
+                cmd[i] = i < r->a ? (char)(r->b >> (8 * i)) : '\0';
+                if (i < r->a && (cmd[i] < ' ' || cmd[i] > '~')) cmd[i] = '.';
+            }
+            cmd[4] = '\0';
+            my_snprintf(buf, size, "len=%u \"%s%s\"", r->a, cmd, r->a > 4 ? "..." : "");
+            break;
+        case JOURNAL_FAULT:
+            my_snprintf(buf, size, "%s 0x%08x", r->a < JOURNAL_FAULT_NUM ? journal_fault_name[r->a] : "?", r->b);
+            break;
+        case JOURNAL_DEADLINE:
+            m = period_mon_get(r->a);
+            my_snprintf(buf, size, "%s resp=%uus", m != NULL ? m->name : "?", period_mon_cyc_to_us(r->b));
+            break;
+        default:
+            my_snprintf(buf, size, "a=%u b=0x%08x", r->a, r->b);
+            break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印保留的事件（JOURNAL命令，多行应答）
+ * @note    首行boots为头部建立以来的启动次数，retained表示本次启动时之前的记录通过了校验，
+ *          total为累计写入条数（超过cap的部分已被覆盖），reset为本次复位原因，cost为一次写入的CPU周期数；
+ *          之后从旧到新每行一条：启动序号、时刻（该次启动以来的us）、类型与参数。
+ *          打印期间新写入的记录不打印，打印到之前已被覆盖的记录跳过
+ */
+void journal_report(void)
+{
+    const unsigned int cost = journal_cost();
+    const uint32_t head     = journal.hdr.head;
+    uint32_t i = head > JOURNAL_CAP ? head - JOURNAL_CAP : 0;
+    JOURNAL_REC r;
+    UBaseType_t s;
+    char detail[56];
+
+    myprintf("JOURNAL boots=%u retained=%u total=%u cap=%u reset=%s cost=%ucyc\r\n", journal.hdr.boots,
+             journal_retained, head, JOURNAL_CAP, journal_reset_name(journal_csr), cost);
+    for (; i != head; i++) {
+        s = portSET_INTERRUPT_MASK_FROM_ISR();
+        if (journal.hdr.head - i > JOURNAL_CAP) {
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+            continue;
+        }
+        r = journal.rec[i & (JOURNAL_CAP - 1U)];
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+        journal_detail(&r, detail, sizeof(detail));
+        myprintf("  #%-3u %10u %-8s %s\r\n", r.boot, r.t, journal_type_name[r.type < JOURNAL_TYPE_NUM ? r.type : 0],
+                 detail);
+    }
+}
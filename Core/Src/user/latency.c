@@ -0,0 +1,221 @@
+/**
+ * @file    latency.c
+ * @brief   命令与红外两条路径的端到端延迟直方图
+ * @note    每条路径由若干阶段组成：起点探针记录时刻（LAT_START），之后各阶段的探针用LAT_PASS
+ *          把"起点时刻"逐级交接下去，每经过一个阶段统计一次相对起点的累计延迟（n/min/平均/max），
+ *          到达终点时再计入该路径的直方图，LAT命令给出min/p50/p99/max。
+ *          交接只保存最近一次的起点，没有被下一阶段取走的起点会被新的起点覆盖（例如红外松开事件不会启动PWM），
+ *          所以只有真正走完整条路径的事件才进入直方图。
+ *          命令路径的起点随命令帧经过命令队列（UART_CMD_FRAME.t_rx），队列中积压的命令各自计时。
+ *          时间取自cpu_stats_cycles（睡眠补偿），中断与任务中都可以调用；LAT_ENABLE为0时全部探针不编译。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+#include "latency.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+
+#define LAT_CYC_PER_US (SystemCoreClock / 1000000U)
+
+/**
+ * @brief  单个阶段相对起点的累计延迟（us）
+ */
+typedef struct {
+    unsigned int n;
+    unsigned int min;
+    unsigned int max;
+    unsigned long long sum;
+} LAT_STAGE_STAT;
+
+/**
+ * @brief  一条路径的统计与交接状态
+ */
+typedef struct {
+    LAT_STAGE_STAT stage[LAT_MAX_STAGES];
+    unsigned int hist[LAT_BUCKETS];          //!< 端到端直方图（终点阶段）
+    unsigned int t0[LAT_MAX_STAGES];         //!< 交给各阶段的起点时刻
+    volatile unsigned char armed;            //!< 已交接起点的阶段位图
+} LAT_PATH_DATA;
+
+static LAT_PATH_DATA lat_path[LAT_PATH_NUM];
+
+static const char *const lat_path_name[LAT_PATH_NUM] = {"cmd", "ir"};
+static const unsigned char lat_path_stages[LAT_PATH_NUM] = {LAT_CMD_STAGES, LAT_IR_STAGES};
+static const char *const lat_stage_name[LAT_PATH_NUM][LAT_MAX_STAGES] = {
+    {"idle_isr", "framed", "dequeued", "gpio"},
+    {"capture", "notify", "decoded", "robot", "pwm"},
+};
+
+/**
+ * @brief   延迟值（us）所在的桶
+ * @note    小于2^(LAT_SUB_BITS+1)每us一个桶，之后每个2倍区间LAT_SUB个桶
+ */
+static unsigned int lat_bucket(unsigned int us)
+{
+    unsigned int msb, b;
+
+    if (us < (2U << LAT_SUB_BITS)) return us;
+    msb = 31U - (unsigned int)__builtin_clz(us);
+    b   = (msb - LAT_SUB_BITS) * (1U << LAT_SUB_BITS) + (us >> (msb - LAT_SUB_BITS));
+    return b < LAT_BUCKETS ? b : LAT_BUCKETS - 1;
+}
+
+/**
+ * @brief   桶的上界（us），lat_bucket的反函数
+ */
+static unsigned int lat_bucket_upper(unsigned int b)
+{
+    unsigned int msb, sub;
+
+    if (b < (2U << LAT_SUB_BITS)) return b;
+    msb = b / (1U << LAT_SUB_BITS) + 1U;
+    sub = b % (1U << LAT_SUB_BITS) + (1U << LAT_SUB_BITS);
+    return ((sub + 1U) << (msb - LAT_SUB_BITS)) - 1U;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   当前时刻（CPU周期，32位回绕）
+ */
+unsigned int lat_now(void)
+{
+    return cpu_stats_cycles();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   把起点时刻交给某个阶段
+ * @param   path: 路径
+ * @param   stage: 接手的阶段
+ * @param   t0: 起点时刻（lat_now）
+ * @retval  None
+ * @note    中断与任务中都可调用；该阶段已有未取走的起点时覆盖
+ */
+void lat_post(LAT_PATH path, unsigned int stage, unsigned int t0)
+{
+    LAT_PATH_DATA *p = &lat_path[path];
+    UBaseType_t s    = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    p->t0[stage] = t0;
+    p->armed |= (unsigned char)(1U << stage);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+}
+
+/**
+ * @brief   取走交给某个阶段的起点时刻
+ * @retval  1取到，0该阶段没有起点
+ */
+int lat_take(LAT_PATH path, unsigned int stage, unsigned int *t0)
+{
+    LAT_PATH_DATA *p = &lat_path[path];
+    UBaseType_t s    = portSET_INTERRUPT_MASK_FROM_ISR();
+    int ok           = (p->armed >> stage) & 1U;
+
+    if (ok) {
+        *t0 = p->t0[stage];
+        p->armed &= (unsigned char)~(1U << stage);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+    return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   统计一个阶段相对起点的延迟
+ * @param   path: 路径
+ * @param   stage: 阶段（1 ~ 路径阶段数-1），终点阶段同时计入直方图
+ * @param   t0: 起点时刻
+ * @retval  None
+ * @note    中断与任务中都可调用
+ */
+void lat_record(LAT_PATH path, unsigned int stage, unsigned int t0)
+{
+    LAT_PATH_DATA *p  = &lat_path[path];
+    LAT_STAGE_STAT *st = &p->stage[stage];
+    unsigned int us    = (lat_now() - t0) / LAT_CYC_PER_US;
+    UBaseType_t s      = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    if (st->n == 0 || us < st->min) st->min = us;
+    if (us > st->max) st->max = us;
+    st->sum += us;
+    st->n++;
+    if (stage == lat_path_stages[path] - 1U) p->hist[lat_bucket(us)]++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+}
+
+/**
+ * @brief   阶段探针：取走交给本阶段的起点并统计，再交给下一阶段
+ * @param   next: 下一阶段，0表示本阶段是终点
+ * @note    本阶段没有起点时什么也不做（事件不是从起点走过来的）
+ */
+void lat_pass(LAT_PATH path, unsigned int stage, unsigned int next)
+{
+    unsigned int t0;
+
+    if (!lat_take(path, stage, &t0)) return;
+    lat_record(path, stage, t0);
+    if (next) lat_post(path, next, t0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   清零全部统计（LAT_RESET命令），正在交接的起点一并丢弃
+ */
+void lat_reset(void)
+{
+    UBaseType_t s = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    memset(lat_path, 0, sizeof(lat_path));
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+}
+
+/**
+ * @brief   直方图的百分位（桶上界，不超过max）
+ */
+static unsigned int lat_percentile(const LAT_PATH_DATA *p, unsigned int n, unsigned int max, unsigned int pct)
+{
+    unsigned int b, acc = 0, need = (n * pct + 99U) / 100U, up;
+
+    for (b = 0; b < LAT_BUCKETS; b++) {
+        acc += p->hist[b];
+        if (acc >= need) break;
+    }
+    up = lat_bucket_upper(b < LAT_BUCKETS ? b : LAT_BUCKETS - 1);
+    return up < max ? up : max;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印各路径端到端延迟与分阶段延迟（LAT命令，多行应答）
+ * @retval  None
+ * @note    每条路径先给一行端到端（终点阶段）的n/min/p50/p99/max，再每阶段一行相对起点的累计延迟n/min/avg/max，单位us；
+ *          各阶段的n不同说明有事件在该阶段之后没有继续（如LED_AUTO重复执行、红外键不控制电机）
+ */
+void lat_report(void)
+{
+    static LAT_PATH_DATA snap;
+    const LAT_STAGE_STAT *st, *end;
+    unsigned int path, i;
+    UBaseType_t s;
+
+    myprintf("LAT %s\r\n", LAT_ENABLE ? "on" : "off(LAT_ENABLE=0)");
+    for (path = 0; path < LAT_PATH_NUM; path++) {
+        s = portSET_INTERRUPT_MASK_FROM_ISR();
+        snap = lat_path[path];
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(s);
+
+        end = &snap.stage[lat_path_stages[path] - 1U];
+        myprintf("  %-8s n=%u min=%u p50=%u p99=%u max=%uus\r\n", lat_path_name[path], end->n,
+                 end->n ? end->min : 0, end->n ? lat_percentile(&snap, end->n, end->max, 50) : 0,
+                 end->n ? lat_percentile(&snap, end->n, end->max, 99) : 0, end->max);
+        for (i = 1; i < lat_path_stages[path]; i++) {
+            st = &snap.stage[i];
+            myprintf("    %-10s n=%u min=%u avg=%u max=%uus\r\n", lat_stage_name[path][i], st->n, st->n ? st->min : 0,
+                     st->n ? (unsigned int)(st->sum / st->n) : 0, st->max);
+        }
+    }
+}
@@ -33,6 +33,7 @@
 #include "stdlib.h"
 #include "lcd.h"
 #include "lcdfont.h"
+#include "ramfunc.h"    /* дGRAMѭصĺRAMFUNCSRAMִ */
 
 
 /* lcd_ex.cŸLCDICļĴʼִ,Լlcd.c,.cļ
@@ -51,15 +52,18 @@ uint32_t g_back_color  = 0XFFFF;    /* 
 /* LCDҪ */
 _lcd_dev lcddev;
 
+/* LCD(freertos.cд) */
+RES_LOCK lcd_lock;
+
 /**
  * @brief       LCDд
  * @param       data: Ҫд
  * @retval      
  */
-void lcd_wr_data(volatile uint16_t data)
+RAMFUNC void lcd_wr_data(volatile uint16_t data)
 {
     data = data;            /* ʹ-O2Żʱ,ʱ */
-    LCD->LCD_RAM = data;
+    LCD_RAM_WRITE(data);
 }
 
 /**
@@ -67,10 +71,10 @@ void lcd_wr_data(volatile uint16_t data)
  * @param       regno: Ĵ/ַ
  * @retval      
  */
-void lcd_wr_regno(volatile uint16_t regno)
+RAMFUNC void lcd_wr_regno(volatile uint16_t regno)
 {
     regno = regno;          /* ʹ-O2Żʱ,ʱ */
-    LCD->LCD_REG = regno;   /* дҪдļĴ */
+    LCD_REG_WRITE(regno);   /* дҪдļĴ */
 }
 
 /**
@@ -81,8 +85,8 @@ void lcd_wr_regno(volatile uint16_t regno)
  */
 void lcd_write_reg(uint16_t regno, uint16_t data)
 {
-    LCD->LCD_REG = regno;   /* дҪдļĴ */
-    LCD->LCD_RAM = data;    /* д */
+    LCD_REG_WRITE(regno);   /* дҪдļĴ */
+    LCD_RAM_WRITE(data);    /* д */
 }
 
 /**
@@ -104,7 +108,7 @@ static uint16_t lcd_rd_data(void)
 {
     volatile uint16_t ram;  /* ֹŻ */
     lcd_opt_delay(2);
-    ram = LCD->LCD_RAM;
+    ram = LCD_RAM_READ();
     return ram;
 }
 
@@ -113,9 +117,9 @@ static uint16_t lcd_rd_data(void)
  * @param       
  * @retval      
  */
-void lcd_write_ram_prepare(void)
+RAMFUNC void lcd_write_ram_prepare(void)
 {
-    LCD->LCD_REG = lcddev.wramcmd;
+    LCD_REG_WRITE(lcddev.wramcmd);
 }
 
 /**
@@ -200,7 +204,7 @@ void lcd_display_off(void)
  * @param       x,y: 
  * @retval      
  */
-void lcd_set_cursor(uint16_t x, uint16_t y)
+RAMFUNC void lcd_set_cursor(uint16_t x, uint16_t y)
 {
     if (lcddev.id == 0X1963)
     {
@@ -420,11 +424,11 @@ void lcd_scan_dir(uint8_t dir)
  * @param       color: ɫ(32λɫ,LTDC)
  * @retval      
  */
-void lcd_draw_point(uint16_t x, uint16_t y, uint32_t color)
+RAMFUNC void lcd_draw_point(uint16_t x, uint16_t y, uint32_t color)
 {
     lcd_set_cursor(x, y);       /* ùλ */
     lcd_write_ram_prepare();    /* ʼдGRAM */
-    LCD->LCD_RAM = color;
+    LCD_RAM_WRITE(color);
 }
 
 /**
@@ -820,7 +824,7 @@ void lcd_init(void)
  * @param       color: Ҫɫ
  * @retval      
  */
-void lcd_clear(uint16_t color)
+RAMFUNC void lcd_clear(uint16_t color)
 {
     uint32_t index = 0;
     uint32_t totalpoint = lcddev.width;
@@ -830,7 +834,7 @@ void lcd_clear(uint16_t color)
 
     for (index = 0; index < totalpoint; index++)
     {
-        LCD->LCD_RAM = color;
+        LCD_RAM_WRITE(color);
    }
 }
 
@@ -840,7 +844,7 @@ void lcd_clear(uint16_t color)
  * @param       color:Ҫɫ(32λɫ,LTDC)
  * @retval      
  */
-void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
+RAMFUNC void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
 {
     uint16_t i, j;
     uint16_t xlen = 0;
@@ -853,7 +857,7 @@ void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color
 
         for (j = 0; j < xlen; j++)
         {
-            LCD->LCD_RAM = color;   /* ʾɫ */
+            LCD_RAM_WRITE(color);   /* ʾɫ */
         }
     }
 }
@@ -878,7 +882,7 @@ void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t
 
         for (j = 0; j < width; j++)
         {
-            LCD->LCD_RAM = color[i * width + j]; /* д */
+            LCD_RAM_WRITE(color[i * width + j]); /* д */
         }
     }
 }
@@ -1053,7 +1057,7 @@ void lcd_fill_circle(uint16_t x, uint16_t y, uint16_t r, uint16_t color)
  * @param       color : ַɫ;
  * @retval      
  */
-void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
+RAMFUNC void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
 {
     uint8_t temp, t1, t;
     uint16_t y0 = y;
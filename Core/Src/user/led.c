@@ -5,45 +5,92 @@
 #include "gpio.h"
 
 #include "my_sys_data.h"
+#include "latency.h"
+#include "period_mon.h"
+
+// 自动模式闪烁周期（ms）
+#define LED_BLINK_MS          1000
+// 闪烁回调的截止期限（ms）：晚于此值人眼已能察觉节奏不匀
+#define LED_BLINK_DEADLINE_MS 50
+
+// 自动模式闪烁的周期监视（PERIODS命令）
+static PERIOD_MON led_blink_mon;
+
+static osTimerId_t led_blink_timer;
+static StaticTimer_t led_blink_timer_cb;
+static const osTimerAttr_t led_blink_timer_attributes = {
+    .name    = "led_blink",
+    .cb_mem  = &led_blink_timer_cb,
+    .cb_size = sizeof(led_blink_timer_cb),
+};
+// 已执行的模式（LED_Artificial表示还没有执行过任何模式），仅定时器服务任务访问
+static unsigned char led_applied = LED_Artificial;
 
 /**
- * @brief   LED控制任务（主状态指示灯）
- * @param   argument: FreeRTOS任务参数（未使用）
- * @retval  None
- * @note    工作模式:每隔100ms就进行一次LED_Conctrl_num检测
- *          如果LED_Conctrl_num不是手动模式时，将进行下一步检测，否则将重复等待100ms后检测
- *          检测到LED_OFF时，关闭所有LED，将模式调成手动模式
- *          检测到LED_ON时，开启所有LED，将模式调成手动模式
- *          检测到LED_AUTO时，让LED一直闪烁
+ * @brief   自动模式闪烁（自动重装定时器回调，在定时器服务任务中执行）
+ */
+static void led_blink(void *argument)
+{
+    (void)argument;
+    period_mon_begin(&led_blink_mon);
+    HAL_GPIO_TogglePin(LED0_GPIO_Port, LED0_Pin);
+    HAL_GPIO_TogglePin(LED1_GPIO_Port, LED1_Pin);
+    period_mon_end(&led_blink_mon);
+}
+
+/**
+ * @brief   LED分区发布后执行新的模式（定时器订阅回调，在定时器服务任务中执行）
+ * @note    已经执行过的模式不再重复执行，重复的LED_AUTO指令不打乱闪烁周期
+ *          LED_AUTO：立即翻转一次并启动闪烁定时器
+ *          LED_ON/LED_OFF：停止闪烁定时器并开启/关闭所有LED
  */
-void StartLEDWorkTaskFunction(void *argument)
+static void led_apply(void)
 {
-    SYS_USE_DATA *SYS            = (SYS_USE_DATA *)argument;
-    SYS->led_control_num.Led_num = LED_AUTO;
-    for (;;) {
-        if (SYS->led_control_num.Led_num != LED_Artificial) {
-            switch (SYS->led_control_num.Led_num) {
-                case LED_AUTO:
-                    HAL_GPIO_TogglePin(LED0_GPIO_Port, LED0_Pin);
-                    HAL_GPIO_TogglePin(LED1_GPIO_Port, LED1_Pin);
-                    break;
-                case LED_ON:
-                    HAL_GPIO_WritePin(LED0_GPIO_Port, LED0_Pin, GPIO_PIN_RESET);
-                    HAL_GPIO_WritePin(LED1_GPIO_Port, LED1_Pin, GPIO_PIN_RESET);
-                    SYS->led_control_num.Led_num = LED_Artificial;
-                    break;
-                case LED_OFF:
-                    HAL_GPIO_WritePin(LED0_GPIO_Port, LED0_Pin, GPIO_PIN_SET);
-                    HAL_GPIO_WritePin(LED1_GPIO_Port, LED1_Pin, GPIO_PIN_SET);
-                    SYS->led_control_num.Led_num = LED_Artificial;
-                    break;
-                default:
-                    break;
-            }
-            osDelay(1000);
-            // 如果完成这次LED闪烁就跳过剩下的代码，重新开始，这样能够稳定保证1s的闪烁周期
-            continue;
-        }
-        osDelay(100);
+    LED_USE_DATA led;
+#if LAT_ENABLE
+    unsigned int t_rx;
+    // 取走LED指令交来的起点；模式未变（重复指令）时不写引脚，起点随之丢弃
+    int lat = lat_take(LAT_PATH_CMD, LAT_CMD_GPIO, &t_rx);
+#endif
+
+    sys_snapshot(SYS_PART_LED, &led);
+    if (led.Led_num == led_applied) return;
+    led_applied = led.Led_num;
+    switch (led.Led_num) {
+        case LED_AUTO:
+            HAL_GPIO_TogglePin(LED0_GPIO_Port, LED0_Pin);
+            HAL_GPIO_TogglePin(LED1_GPIO_Port, LED1_Pin);
+            period_mon_restart(&led_blink_mon);
+            osTimerStart(led_blink_timer, LED_BLINK_MS);
+            break;
+        case LED_ON:
+            osTimerStop(led_blink_timer);
+            HAL_GPIO_WritePin(LED0_GPIO_Port, LED0_Pin, GPIO_PIN_RESET);
+            HAL_GPIO_WritePin(LED1_GPIO_Port, LED1_Pin, GPIO_PIN_RESET);
+            break;
+        case LED_OFF:
+            osTimerStop(led_blink_timer);
+            HAL_GPIO_WritePin(LED0_GPIO_Port, LED0_Pin, GPIO_PIN_SET);
+            HAL_GPIO_WritePin(LED1_GPIO_Port, LED1_Pin, GPIO_PIN_SET);
+            break;
+        default:
+            break;
     }
+#if LAT_ENABLE
+    if (lat) lat_record(LAT_PATH_CMD, LAT_CMD_GPIO, t_rx);
+#endif
+}
+
+/**
+ * @brief   LED控制初始化（主状态指示灯）
+ * @retval  None
+ * @note    原LEDWorkTask只是按1s超时等待并翻转LED，现改为软件定时器：
+ *          闪烁由自动重装定时器完成，模式切换由LED分区的定时器订阅触发，不再占用任务栈与TCB
+ *          在MX_FREERTOS_Init中调用，上电模式由指令处理任务发布（LED_AUTO）
+ */
+void led_init(void)
+{
+    led_blink_timer = osTimerNew(led_blink, osTimerPeriodic, NULL, &led_blink_timer_attributes);
+    period_mon_init(&led_blink_mon, "led", LED_BLINK_MS * 1000U, LED_BLINK_DEADLINE_MS * 1000U);
+    sys_subscribe_timer(SYS_PART_LED, led_apply);
 }
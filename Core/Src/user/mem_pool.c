@@ -0,0 +1,194 @@
+/**
+ * @file    mem_pool.c
+ * @brief   固定块内存池：在CMSIS-RTOS2 osMemoryPool之上增加静态定义与使用统计
+ * @note    消息类数据（命令帧等）按固定大小从池中分配，分配/释放时间恒定且可在中断中使用；
+ *          heap_4是首次适配加合并，耗时随空闲链表长度（碎片程度）增长，只保留给启动期的少量申请。
+ *          新增内存池：在此文件定义存储区与实例并加入mem_pool_table，在freertos.c中调用mem_pool_init。
+ *          POOL命令打印各池统计，POOL_BENCH命令在碎片化的堆上对比pvPortMalloc与池分配的耗时，
+ *          主机仿真构建（HOST_SIM）下同样可用（周期数由单调时钟换算）。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "mem_pool.h"
+#include "myprintf.h"
+#include "cpu_stats.h"
+
+static void *cmd_pool_mem[MEM_POOL_WORDS(CMD_POOL_LEN, sizeof(UART_CMD_FRAME))];
+
+MEM_POOL cmd_pool = {
+    .name  = "cmd",
+    .mem   = cmd_pool_mem,
+    .count = CMD_POOL_LEN,
+    .size  = MEM_POOL_BLOCK_SIZE(sizeof(UART_CMD_FRAME)),
+};
+
+static MEM_POOL *const mem_pool_table[] = {&cmd_pool};
+#define MEM_POOL_NUM (sizeof(mem_pool_table) / sizeof(mem_pool_table[0]))
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   在静态控制块与存储区上创建内存池
+ * @param   pool: 内存池实例
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中调用（调度器启动前）
+ */
+void mem_pool_init(MEM_POOL *pool)
+{
+    const osMemoryPoolAttr_t attr = {
+        .name    = pool->name,
+        .cb_mem  = &pool->cb,
+        .cb_size = sizeof(pool->cb),
+        .mp_mem  = pool->mem,
+        .mp_size = pool->count * pool->size,
+    };
+
+    pool->id = osMemoryPoolNew(pool->count, pool->size, &attr);
+}
+
+/**
+ * @brief   分配一块
+ * @param   pool: 内存池实例
+ * @param   timeout: 池空时最长等待时间（节拍），中断中必须为0
+ * @retval  块地址，池空且超时返回NULL
+ * @note    任务与中断中均可调用；统计在BASEPRI屏蔽下更新（FROM_ISR版本的临界区在任务中同样可用）
+ */
+void *mem_pool_alloc(MEM_POOL *pool, unsigned int timeout)
+{
+    void *block = osMemoryPoolAlloc(pool->id, timeout);
+    UBaseType_t mask;
+
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    if (block != NULL) {
+        pool->stat.alloc++;
+        if (++pool->stat.used > pool->stat.peak) pool->stat.peak = pool->stat.used;
+    } else {
+        pool->stat.fail++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return block;
+}
+
+/**
+ * @brief   释放一块
+ * @param   pool: 内存池实例（必须是分配该块的池）
+ * @param   block: mem_pool_alloc返回的块
+ * @retval  0: 成功，-1: 块不属于该池或池已全部空闲（重复释放）
+ * @note    任务与中断中均可调用，释放会唤醒等待该池的任务
+ */
+int mem_pool_free(MEM_POOL *pool, void *block)
+{
+    UBaseType_t mask;
+
+    if (osMemoryPoolFree(pool->id, block) != osOK) return -1;
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    pool->stat.used--;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印各内存池的使用统计（POOL命令，多行应答）
+ * @note    blk  : 块大小x块数      used/peak: 当前/峰值占用块数
+ *          alloc: 累计分配次数     fail     : 池空且等待超时的次数
+ */
+void mem_pool_report(void)
+{
+    unsigned int i;
+    MEM_POOL *p;
+
+    myprintf("POOL n=%u\r\n", (unsigned int)MEM_POOL_NUM);
+    for (i = 0; i < MEM_POOL_NUM; i++) {
+        p = mem_pool_table[i];
+        myprintf("  %-8s blk=%ux%u used=%u peak=%u alloc=%u fail=%u\r\n", p->name, p->size, p->count, p->stat.used,
+                 p->stat.peak, p->stat.alloc, p->stat.fail);
+    }
+}
+
+/**
+ * @brief  一项耗时测量的最小/累计/最大值（周期）
+ */
+typedef struct {
+    unsigned int min, max, sum;
+} MEM_POOL_BENCH_STAT;
+
+static void mem_pool_bench_add(MEM_POOL_BENCH_STAT *s, unsigned int cyc)
+{
+    if (cyc < s->min) s->min = cyc;
+    if (cyc > s->max) s->max = cyc;
+    s->sum += cyc;
+}
+
+/**
+ * @brief   测量MEM_POOL_BENCH_ROUNDS次申请+释放并打印一行结果
+ * @param   pool: 测试池，NULL表示测量pvPortMalloc/vPortFree
+ * @note    测量期间挂起调度器，中断仍会计入最大值
+ */
+static void mem_pool_bench_run(const char *name, unsigned int holes, MEM_POOL *pool)
+{
+    MEM_POOL_BENCH_STAT a = {~0U, 0, 0}, f = {~0U, 0, 0};
+    unsigned int i, t0, t1, t2;
+    void *p;
+
+    vTaskSuspendAll();
+    for (i = 0; i < MEM_POOL_BENCH_ROUNDS; i++) {
+        t0 = cpu_stats_cycles();
+        p  = pool != NULL ? mem_pool_alloc(pool, 0) : pvPortMalloc(MEM_POOL_BENCH_SIZE);
+        t1 = cpu_stats_cycles();
+        if (pool != NULL) {
+            mem_pool_free(pool, p);
+        } else {
+            vPortFree(p);
+        }
+        t2 = cpu_stats_cycles();
+        mem_pool_bench_add(&a, t1 - t0);
+        mem_pool_bench_add(&f, t2 - t1);
+    }
+    (void)xTaskResumeAll();
+    myprintf("  %-4s holes=%u alloc=%u/%u/%u free=%u/%u/%u\r\n", name, holes, a.min, a.sum / MEM_POOL_BENCH_ROUNDS,
+             a.max, f.min, f.sum / MEM_POOL_BENCH_ROUNDS, f.max);
+}
+
+/**
+ * @brief   池分配与pvPortMalloc的耗时对比（POOL_BENCH命令，多行应答）
+ * @note    各做MEM_POOL_BENCH_ROUNDS次申请+释放MEM_POOL_BENCH_SIZE字节，打印最小/平均/最大周期数：
+ *          池分配一次；堆在空闲链表完整时一次，再交替申请小块与保留块、释放小块，
+ *          制造MEM_POOL_BENCH_HOLES个放不下测试块的空洞后再测一次。
+ *          pvPortMalloc每次都要越过全部空洞，耗时随碎片增长；池分配与碎片无关。
+ *          结束后释放全部测试块，堆恢复原状；HEAP命令的min会记录测量期间的最低剩余
+ * @warning 禁止在中断中调用
+ */
+void mem_pool_bench(void)
+{
+    static void *bench_mem[MEM_POOL_WORDS(4, MEM_POOL_BENCH_SIZE)];
+    static MEM_POOL bench = {
+        .name  = "bench",
+        .mem   = bench_mem,
+        .count = 4,
+        .size  = MEM_POOL_BLOCK_SIZE(MEM_POOL_BENCH_SIZE),
+    };
+    void *keep[MEM_POOL_BENCH_HOLES], *hole[MEM_POOL_BENCH_HOLES];
+    unsigned int i, n;
+
+    if (bench.id == NULL) mem_pool_init(&bench);
+    myprintf("POOL_BENCH size=%u rounds=%u cycles min/avg/max\r\n", MEM_POOL_BENCH_SIZE, MEM_POOL_BENCH_ROUNDS);
+    mem_pool_bench_run("pool", 0, &bench);
+    mem_pool_bench_run("heap", 0, NULL);
+
+    // 制造空洞：小块与保留块交替，空洞（小块+块头）放不下测试块
+    for (n = 0; n < MEM_POOL_BENCH_HOLES; n++) {
+        hole[n] = pvPortMalloc(MEM_POOL_BENCH_SIZE / 2);
+        keep[n] = pvPortMalloc(MEM_POOL_BENCH_SIZE / 2);
+        if (hole[n] == NULL || keep[n] == NULL) {
+            vPortFree(hole[n]);
+            vPortFree(keep[n]);
+            break;
+        }
+    }
+    for (i = 0; i < n; i++) vPortFree(hole[i]);
+    mem_pool_bench_run("heap", n, NULL);
+    for (i = 0; i < n; i++) vPortFree(keep[i]);
+}
@@ -0,0 +1,206 @@
+/**
+ * @file    my_sys_data.c
+ * @brief   系统数据分区快照发布
+ * @note    每个分区有两份快照缓冲区和一个版本号：
+ *          - 所有者（唯一写入者）把新数据写入当前未发布的那份缓冲区，写完后版本号加1完成发布，
+ *            写入过程中读者看到的始终是上一次发布的完整数据
+ *          - 读者记下版本号后拷贝已发布的缓冲区，拷贝完成后版本号未变即为一致副本；
+ *            拷贝期间所有者又发布过（可能已开始改写这份缓冲区）则重试
+ *          双方都不加锁、不关中断，读者也不会因为低优先级写入者被抢占而空等
+ *          需要在数据变化时才工作的任务用sys_subscribe订阅分区，发布时收到SYS_EVT(id)线程标志，
+ *          配合sys_wait阻塞等待，取代固定间隔的轮询；
+ *          没有自己任务的模块（软件定时器驱动的LED、蜂鸣器）用sys_subscribe_timer订阅，
+ *          发布时回调被挂到定时器服务任务中执行
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+#include "my_sys_data.h"
+#include "myprintf.h"
+
+typedef struct {
+    volatile unsigned int version; //!< 发布次数，最新快照位于buf[version & 1]
+    unsigned int retries;          //!< 读者因并发发布而重试的次数
+    unsigned short size;
+    void *buf[2];
+    unsigned char sub_num;              //!< 订阅任务数
+    osThreadId_t sub[SYS_SUB_MAX];      //!< 发布时需要通知的任务
+    SYS_TIMER_CB timer_cb;              //!< 发布时挂到定时器服务任务执行的回调
+} SYS_SNAPSHOT;
+
+/**
+ * @brief  事件等待统计
+ */
+typedef struct {
+    unsigned int event;   //!< 被事件唤醒的次数
+    unsigned int timeout; //!< 超时唤醒的次数（周期性动作）
+} SYS_WAKE_STAT;
+
+static SYS_WAKE_STAT sys_wake_stat[SYS_WAKE_NUM];
+// 挂到定时器服务任务的分区回调次数，以及因定时器命令队列满而丢失的次数
+static unsigned int sys_pend_num, sys_pend_lost;
+
+static ROBOT_USE_TYPE sys_robot_buf[2];
+static TIME_USE_DATA sys_time_buf[2];
+static USART_USE_DATA sys_uart_buf[2];
+static LED_USE_DATA sys_led_buf[2];
+static BEEP_USE_DATA sys_beep_buf[2];
+static REMOTE_USE_DATA sys_remote_buf[2];
+#ifdef HOST_SIM
+static SYS_SIM_DATA sys_sim_buf[2];
+#endif
+
+#define SYS_SNAPSHOT_DEF(b) {0, 0, sizeof((b)[0]), {&(b)[0], &(b)[1]}, 0, {0}, NULL}
+
+static SYS_SNAPSHOT sys_parts[SYS_PART_NUM] = {
+    [SYS_PART_ROBOT]  = SYS_SNAPSHOT_DEF(sys_robot_buf),
+    [SYS_PART_TIME]   = SYS_SNAPSHOT_DEF(sys_time_buf),
+    [SYS_PART_UART]   = SYS_SNAPSHOT_DEF(sys_uart_buf),
+    [SYS_PART_LED]    = SYS_SNAPSHOT_DEF(sys_led_buf),
+    [SYS_PART_BEEP]   = SYS_SNAPSHOT_DEF(sys_beep_buf),
+    [SYS_PART_REMOTE] = SYS_SNAPSHOT_DEF(sys_remote_buf),
+#ifdef HOST_SIM
+    [SYS_PART_SIM]    = SYS_SNAPSHOT_DEF(sys_sim_buf),
+#endif
+};
+
+/**
+ * @brief   在定时器服务任务中执行分区订阅回调（xTimerPendFunctionCall的目标）
+ * @param   unused: 未使用
+ * @param   id: 分区编号
+ */
+static void sys_timer_dispatch(void *unused, uint32_t id)
+{
+    (void)unused;
+    sys_pend_num++;
+    sys_parts[id].timer_cb();
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   发布分区快照
+ * @param   id: 分区编号
+ * @param   src: 所有者的工作数据（SYS_USE_DATA中对应的成员）
+ * @retval  None
+ * @note    拷贝到未发布的缓冲区后才更新版本号，读者不会看到写了一半的数据；
+ *          发布后给所有订阅者置SYS_EVT(id)标志，有定时器订阅时把回调挂到定时器服务任务；
+ *          定时器服务任务优先级高于所有应用任务，挂起的回调会立即执行，命令队列不会积压
+ * @warning 只能由该分区的所有者调用（每个分区只有一个写入者），不能在中断中调用
+ */
+void sys_publish(SYS_PART_ID id, const void *src)
+{
+    SYS_SNAPSHOT *p = &sys_parts[id];
+    unsigned int v  = p->version;
+    unsigned char i;
+
+    memcpy(p->buf[(v + 1) & 1], src, p->size);
+    // 数据写完之后才能发布
+    __DMB();
+    p->version = v + 1;
+    for (i = 0; i < p->sub_num; i++) {
+        osThreadFlagsSet(p->sub[i], SYS_EVT(id));
+    }
+    if (p->timer_cb && xTimerPendFunctionCall(sys_timer_dispatch, NULL, id, 0) != pdPASS) {
+        sys_pend_lost++;
+    }
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   读取分区的一致快照
+ * @param   id: 分区编号
+ * @param   dst: 输出缓冲（大小与分区类型一致）
+ * @retval  None
+ * @note    不加锁；只有拷贝期间所有者恰好发布了新快照才会重试
+ */
+void sys_snapshot(SYS_PART_ID id, void *dst)
+{
+    SYS_SNAPSHOT *p = &sys_parts[id];
+    unsigned int v;
+
+    for (;;) {
+        v = p->version;
+        __DMB();
+        memcpy(dst, p->buf[v & 1], p->size);
+        __DMB();
+        if (p->version == v) return;
+        p->retries++;
+    }
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   分区版本号（每次发布加1），读者可据此判断数据是否变化而不必拷贝比较
+ */
+unsigned int sys_part_version(SYS_PART_ID id)
+{
+    return sys_parts[id].version;
+}
+
+/**
+ * @brief   读者重试次数（用于评估并发冲突）
+ */
+unsigned int sys_part_retries(SYS_PART_ID id)
+{
+    return sys_parts[id].retries;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   订阅分区：调用者任务在该分区每次发布后收到SYS_EVT(id)线程标志
+ * @param   id: 分区编号
+ * @retval  None
+ * @note    在任务入口调用一次；超过SYS_SUB_MAX的订阅被忽略
+ */
+void sys_subscribe(SYS_PART_ID id)
+{
+    SYS_SNAPSHOT *p = &sys_parts[id];
+
+    taskENTER_CRITICAL();
+    if (p->sub_num < SYS_SUB_MAX) {
+        p->sub[p->sub_num] = osThreadGetId();
+        p->sub_num++;
+    }
+    taskEXIT_CRITICAL();
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   以软件定时器方式订阅分区：该分区每次发布后，cb在定时器服务任务中执行一次
+ * @param   id: 分区编号
+ * @param   cb: 回调，与该模块的软件定时器回调在同一任务中串行执行，彼此不需要加锁
+ * @retval  None
+ * @note    每个分区一个定时器订阅；在MX_FREERTOS_Init中调用
+ */
+void sys_subscribe_timer(SYS_PART_ID id, SYS_TIMER_CB cb)
+{
+    sys_parts[id].timer_cb = cb;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   阻塞等待线程标志并统计唤醒原因
+ * @param   who: 统计编号
+ * @param   flags: 等待的标志（任意一位即返回，返回时清除）
+ * @param   timeout: 超时（tick），osWaitForever表示只由事件唤醒
+ * @retval  收到的标志，超时返回0
+ */
+unsigned int sys_wait(SYS_WAKE_ID who, unsigned int flags, unsigned int timeout)
+{
+    uint32_t r = osThreadFlagsWait(flags, osFlagsWaitAny, timeout);
+
+    // 超时（timeout为0时是osFlagsErrorResource）都按周期性唤醒统计
+    if (r & osFlagsError) {
+        sys_wake_stat[who].timeout++;
+        return 0;
+    }
+    sys_wake_stat[who].event++;
+    return r & flags;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印各任务唤醒次数（事件/超时）与定时器订阅回调次数（执行/丢失），单行应答
+ */
+void sys_wake_report(void)
+{
+    myprintf("WAKE robot=%u/%u timer_cb=%u/%u\r\n", sys_wake_stat[SYS_WAKE_ROBOT].event,
+             sys_wake_stat[SYS_WAKE_ROBOT].timeout, sys_pend_num, sys_pend_lost);
+}
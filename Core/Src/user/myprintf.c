@@ -2,141 +2,176 @@
 #include "task.h"
 #include "main.h"
 #include "cmsis_os.h"
-#include "stdio.h"
 #include "stdarg.h"
 #include "string.h"
 #include "gpio.h"
 #include "mytask.h"
 #include "myprintf.h"
+#include "myformat.h"
+#include "uart_drv.h"
+#include "mem_pool.h"
+#include "journal.h"
 
-// 定义串口号
-extern UART_HandleTypeDef huart1;
-// 定义DMA接口
-extern DMA_HandleTypeDef hdma_usart1_rx;
 // 信号量
-extern osSemaphoreId_t uart1_printf_gsemHandle;
-extern osSemaphoreId_t uart1_rxok_gsemHandle;
 extern osSemaphoreId_t LCD_refresh_gsemHandle;
-// 完成数据读取，通知数据处理函数可以工作了
-extern osSemaphoreId_t uart1_data_handle_gsemHandle;
+// 完成一帧命令读取，送入命令队列通知数据处理函数
+extern osMessageQueueId_t uart1_cmd_queueHandle;
 
-// 要发送的数据
-char gbuf_printf[UART1_DMA_RX_LEN];
+// 流控统计
+UART1_FLOW_STAT uart1_flow_stat;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @brief   定制化串口格式化输出函数
- * @param   format: 格式化字符串（支持%d, %x, %s等标准格式）
+ * @param   format: 格式化字符串（支持%d, %u, %x, %s, %c及宽度/补零，见myformat.h）
  * @param   ...: 可变参数列表
  * @retval  None
- * @note    使用内部缓冲gbuf_printf（大小：UART1_DMA_RX_LEN）
- *          依赖HAL_UART_Transmit_DMA实现非阻塞发送
- *          线程安全设计（通过uart1_printf_gsemHandle互斥锁）
+ * @note    输出到命令口（uart1_drv），单次最长UART_DRV_FMT_LEN-1字节，超长内容被截断
+ *          格式化结果拷入发送环后立即返回，不等待上一次发送完成
+ *          线程安全设计（驱动内部的写锁保证多任务输出不交错）
  * @warning 禁止在中断上下文中调用
  * @example myprintf("ADC Value: %d", adc_val);
  */
-void myprintf(char *format, ...)
+void myprintf(const char *format, ...)
 {
     // 创建可变参数列表类型变量ap
     va_list ap;
-    // 获取信号量，如果信号量不可用就一直等待
-    osSemaphoreAcquire(uart1_printf_gsemHandle, osWaitForever);
     // 初始化可变参数列表ap，让其指向format第一个参数
     va_start(ap, format);
-    // 检查串口是否正在发送数据，如果是直接退出
-    if (huart1.gState == HAL_UART_STATE_BUSY_TX) return;
-    // 将格式化后的字符串存到gbuf_printf数组中
-    vsprintf(gbuf_printf, format, ap);
-    // 串口中断方式发送gbuf_printf中的数据
-    HAL_UART_Transmit_IT(&huart1, (uint8_t *)gbuf_printf, strlen(gbuf_printf));
+    uart_drv_vprintf(&uart1_drv, format, ap);
     // 释放ap的资源
     va_end(ap);
 }
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * @brief   串口发送完成中断回调
- * @param   huart: 串口句柄指针
+ * @brief   将一帧完整命令送入命令队列
+ * @param   SYS: 系统数据聚合指针
+ * @param   frame: 已组帧的命令（接收任务自己的组帧缓冲）
  * @retval  None
- * @note    释放串口发送互斥量
- *          当发送完成时触发LED闪烁指示
- * @warning 此函数在中断上下文中执行（保持简短）
- *
- * 关联全局变量:
- * - uart1_printf_gsemHandle : 串口发送互斥信号量
- * - tx_complete_flag : 发送完成标志位（bit0）
+ * @note    从cmd_pool取一块拷入命令内容，队列中只传递块指针；
+ *          池空时最多等待UART1_CMD_PUT_TIMEOUT，超时丢弃并计数（池比队列多1块，池不空时入队不会失败）
+ *          上位机遵守流控窗口时不会丢弃
  */
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+static void uart1_cmd_commit(SYS_USE_DATA *SYS, UART_CMD_FRAME *frame)
 {
-    if (huart->Instance == USART1) {
-        // 串口发送完成中断时，释放信号量
-        osSemaphoreRelease(uart1_printf_gsemHandle);
+    UART_CMD_FRAME *msg;
+    uint32_t head4;
+
+    frame->data[frame->len] = '\0';
+    // 事件日志记下长度与前4个字符（超出长度的字节打印时忽略）
+    memcpy(&head4, frame->data, sizeof(head4));
+    journal_log(JOURNAL_CMD, frame->len, head4);
+#if LAT_ENABLE
+    lat_record(LAT_PATH_CMD, LAT_CMD_FRAMED, frame->t_rx);
+#endif
+    msg = mem_pool_alloc(&cmd_pool, UART1_CMD_PUT_TIMEOUT);
+    if (msg != NULL) {
+        msg->len = frame->len;
+        memcpy(msg->data, frame->data, frame->len + 1);
+#if LAT_ENABLE
+        msg->t_rx = frame->t_rx;
+#endif
+        if (osMessageQueuePut(uart1_cmd_queueHandle, &msg, 0, 0) != osOK) {
+            mem_pool_free(&cmd_pool, msg);
+            msg = NULL;
+        }
     }
+    if (msg == NULL) {
+        uart1_flow_stat.cmd_drop++;
+        journal_log(JOURNAL_FAULT, JOURNAL_FAULT_CMD_DROP, uart1_flow_stat.cmd_drop);
+    }
+    // 保存最近一条命令并发布快照供LCD显示
+    memcpy(SYS->usart_use_data.Read_data, frame->data, frame->len + 1);
+    sys_publish(SYS_PART_UART, &SYS->usart_use_data);
+    frame->len = 0;
 }
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * @brief   串口数据接收处理引擎
- * @param   None
- * @retval  None
- * @note    当产生空闲中断就释放串口接收任务信号量
- *          随后进入串口接收任务（DMA模式）
- * @warning 这个函数需要将其放入中断文件(stm32f1xx_it.C)中，调用这个中断响应函数
+ * @brief   通过串口打印流控状态（单行）
+ * @note    win  : 流控窗口，上位机未收到应答的命令数不得超过该值
+ *          free : 命令队列当前空闲槽位
+ *          ring : DMA环形缓冲区当前空闲字节
+ *          ovr  : 环形缓冲区被覆盖次数  err: 串口硬件错误次数
+ *          drop : 命令队列满丢弃数      trunc: 超长命令被截断数
+ * @warning 禁止在中断中调用
  */
-void uart1_data_in()
+void uart1_flow_report(void)
 {
-    if ((__HAL_UART_GET_FLAG(&huart1, UART_FLAG_IDLE) != RESET)) {
-        // 产生空闲中断就清除中断
-        __HAL_UART_CLEAR_IDLEFLAG(&huart1);
-        // 释放信号量
-        osSemaphoreRelease(uart1_rxok_gsemHandle);
-    }
+    UART_DRV_STAT *st = &uart1_drv.stat;
+    myprintf("FLOW win=%u free=%u ring=%u rx=%u ovr=%u err=%u drop=%u trunc=%u\r\n", UART1_FLOW_WINDOW,
+             (unsigned int)osMessageQueueGetSpace(uart1_cmd_queueHandle), uart_drv_rx_free(&uart1_drv), st->rx_bytes,
+             st->rx_overrun, st->rx_error, uart1_flow_stat.cmd_drop, uart1_flow_stat.cmd_trunc);
 }
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * @brief  串口接收任务（DMA模式）
  * @param  argument: FreeRTOS任务参数指针
  * @retval None
- * @note   使用HAL_UART_Receive_DMA配合空闲中断实现
- *         环形缓冲区大小：UART1_DMA_RX_LEN(50)
- *         信号量：
- *           - uart1_rxok_gsemHandle : 数据接收完成信号
+ * @note   数据由uart1_drv（DMA循环接收+空闲/半满/全满中断）提供，本任务只负责分帧
+ *         分帧规则：遇到'\r'或'\n'结束一帧；空闲中断时将未结束的数据也作为一帧
+ *         （兼容不带换行符的旧上位机），单条命令最长UART1_DMA_RX_LEN-1
+ *         流控：每条命令恰好产生一行应答，上位机以应答作为信用返还，
+ *         保持未应答命令数不超过UART1_FLOW_WINDOW即可全速发送而不丢数据（见FLOW命令）
+ *         信号量/队列：
+ *           - uart1_cmd_queueHandle : 命令帧指针队列（按接收顺序处理，帧从cmd_pool分配）
  *           - LCD_refresh_gsemHandle: LCD刷新触发信号
  * @warning 禁止在中断中调用本函数
  */
 void StartUART1_recv_TaskFunction(void *argument)
 {
     SYS_USE_DATA *SYS = (SYS_USE_DATA *)argument;
-    // now_dma_ip当前数据缓冲区数据长度
-    // rd_dma_ip读到的数据的长度
-    unsigned short now_dam_ip, rd_dma_ip = 0, Read_data_len;
-    // 接受缓冲区rxBuffer，指令缓冲区SYS->usart_use_data.Read_data
-    char rxBuffer[UART1_DMA_RX_LEN];
-    // 初始化DMA缓冲区
-    memset(rxBuffer, 0, UART1_DMA_RX_LEN);
-    // 打开串口空闲中断
-    __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
-    // 使能DMA接收功能
-    HAL_UART_Receive_DMA(&huart1, (uint8_t *)rxBuffer, UART1_DMA_RX_LEN);
+    // 正在组帧的命令
+    static UART_CMD_FRAME frame;
+    char chunk[32];
+    unsigned int evt, n, i;
+    unsigned char new_cmd, discard = 0;
+    char ch;
+    frame.len = 0;
 
     for (;;) {
-        // 接收到信号量才继续进行
-        osSemaphoreAcquire(uart1_rxok_gsemHandle, osWaitForever);
-        // 计算当前数据队列中已有的数据长度
-        now_dam_ip = UART1_DMA_RX_LEN - (unsigned short int)__HAL_DMA_GET_COUNTER(&hdma_usart1_rx);
-        // 将读取到的数据的指针重置为0
-        Read_data_len = 0;
-        // 清空指令缓冲区
-        memset(SYS->usart_use_data.Read_data, 0, UART1_DMA_RX_LEN);
-        // 如果读指针不等于当前数据指针
-        while (rd_dma_ip != now_dam_ip) {
-            // 将数据读取到SYS->usart_use_data.Read_data当中
-            SYS->usart_use_data.Read_data[Read_data_len++] = rxBuffer[rd_dma_ip++];
-            if (rd_dma_ip >= UART1_DMA_RX_LEN) rd_dma_ip = 0;
+        // 等待接收事件
+        evt     = uart_drv_rx_wait(&uart1_drv, osWaitForever);
+        new_cmd = 0;
+#if LAT_ENABLE
+        // 本次唤醒读出的命令以空闲中断时刻为起点；半满/全满唤醒没有空闲时刻，以唤醒时刻代替
+        if (!lat_take(LAT_PATH_CMD, LAT_CMD_FRAMED, &frame.t_rx)) frame.t_rx = lat_now();
+#endif
+        if (evt & (UART_DRV_EVT_RESTART | UART_DRV_EVT_OVERRUN)) {
+            // 当前半条命令的内容已经丢失，丢弃到下一个行结束符为止
+            frame.len = 0;
+            discard   = (evt & UART_DRV_EVT_OVERRUN) ? 1 : 0;
+            if (evt & UART_DRV_EVT_OVERRUN) journal_log(JOURNAL_FAULT, JOURNAL_FAULT_UART_OVR, uart1_drv.stat.rx_overrun);
+        }
+        while ((n = uart_drv_read(&uart1_drv, chunk, sizeof(chunk))) > 0) {
+            for (i = 0; i < n; i++) {
+                ch = chunk[i];
+                if (ch == '\r' || ch == '\n') {
+                    // 行结束符：提交一帧（忽略空行，兼容"\r\n"）
+                    if (frame.len && !discard) {
+                        uart1_cmd_commit(SYS, &frame);
+                        new_cmd = 1;
+                    }
+                    frame.len = 0;
+                    discard   = 0;
+                } else if (frame.len < UART1_DMA_RX_LEN - 1) {
+                    frame.data[frame.len++] = ch;
+                } else if (frame.len == UART1_DMA_RX_LEN - 1 && !discard) {
+                    // 超长命令只保留前UART1_DMA_RX_LEN-1个字符
+                    uart1_flow_stat.cmd_trunc++;
+                    discard = 2;
+                }
+            }
+        }
+        // 空闲中断：一次突发传输结束，没有结束符的数据也作为完整命令
+        if ((evt & UART_DRV_EVT_IDLE) && frame.len) {
+            if (discard != 1) {
+                uart1_cmd_commit(SYS, &frame);
+                new_cmd = 1;
+            }
+            frame.len = 0;
+            discard   = 0;
         }
-        // 保存读取到的数据，因为Read_data会清零！虽然在这个位置他是完整的数据
-        strcpy(SYS->usart_use_data.Response_Read_data, SYS->usart_use_data.Read_data);
-        // 释放data处理刷新信号量(Response_Read_data使用完成之后自动清空)
-        osSemaphoreRelease(uart1_data_handle_gsemHandle);
         // 释放LCD刷新信号量(在LCD显示的同时将Read_data送给Last_Read_data)
-        osSemaphoreRelease(LCD_refresh_gsemHandle);
+        if (new_cmd) osSemaphoreRelease(LCD_refresh_gsemHandle);
     }
 }
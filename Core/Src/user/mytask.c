@@ -29,6 +29,39 @@
  * 2025-03-21 v1.5.0  新增加蜂鸣器响应，现在可以通过串口发送命令使蜂鸣器响相对应时间
  * 2025-04-25 v2.0.0  新增红外遥控控制，并且完全重构数据结构和部分实现代码，现在整个项目可以准备接入电机输出PWM控制了
  * 已经开启PWM-TIM8
+ * 2026-10-19 v2.1.0  串口命令改为消息队列流水线（按行分帧、按序应答），去掉100ms处理间隔，波特率提升至115200
+ * 2026-10-19 v2.1.1  串口接收增加基于应答信用的流控、环形缓冲区覆盖检测与错误自动恢复，新增FLOW命令
+ * 2026-10-19 v2.2.0  串口改为多实例驱动（uart_drv，DMA环形收发），新增USART2副端口，新增UART_STAT命令
+ * 2026-10-19 v2.2.1  系统数据改为静态存放并按所有者分区，跨任务读取改为无锁快照（sys_publish/sys_snapshot）
+ * 2026-10-19 v2.2.2  LED/蜂鸣器/红外/机械臂任务由轮询改为事件唤醒（分区订阅+红外中断通知），新增WAKE命令
+ * 2026-10-19 v2.3.0  开启FreeRTOS运行时间统计（DWT周期计数），新增STATS命令与LCD统计页（LCD_STATS/LCD_MAIN）
+ * 2026-10-19 v2.3.1  开启无节拍空闲（SysTick定时+WFI睡眠，HAL时基TIM6补偿），新增SLEEP命令
+ * 2026-10-19 v2.3.2  任务/队列/信号量/定时器全部静态分配并按任务单独设定栈大小，FreeRTOS堆缩减为1KB，
+ *                    新增HEAP命令与链接map内存预算表（Tools/mem_budget.py）
+ * 2026-10-19 v2.3.3  新增任务栈水位监视（defauleTask周期采样，超阈值主动告警，浸泡期后给出建议栈大小），
+ *                    新增STACK/STACK_SOAK命令
+ * 2026-10-19 v2.4.0  LED闪烁、系统时间与蜂鸣器改为软件定时器（删除LEDWorkTask/TimeSetTask/BeepWorkTask），
+ *                    红外解码挂到定时器服务任务执行，新增TIMERS命令
+ * 2026-10-19 v2.4.1  新增时间服务（time_srv，TIM2/TIM3级联的硬件秒节拍与64位微秒时间戳），
+ *                    系统时间改由硬件秒节拍推算不再漂移，新增TIME/TIME_SET命令
+ * 2026-10-19 v2.4.2  新增调度器/中断事件跟踪（trace，RAM环形缓冲），新增TRACE/TRACE_ON/TRACE_OFF/TRACE_DUMP命令，
+ *                    Tools/trace_to_perfetto.py转换为Perfetto trace
+ * 2026-10-19 v2.4.3  新增命令与红外路径的端到端延迟测量（latency，分阶段统计与直方图），新增LAT/LAT_RESET命令
+ * 2026-10-19 v2.4.4  新增固定块内存池（mem_pool，osMemoryPool+统计），命令队列改为传递命令帧池中的块指针，
+ *                    新增POOL/POOL_BENCH命令
+ * 2026-10-19 v2.4.5  串口写锁改为优先级继承互斥量，新增LCD总线锁（res_lock，争用/持有时间统计），新增LOCKS命令
+ * 2026-10-19 v2.4.6  机械臂控制改为TIM7定时释放的固定频率控制周期（ctrl_loop，500Hz~5kHz，最高应用优先级），
+ *                    底盘脉冲改为按周期计数输出不再阻塞，新增CTRL/CTRL_RATE命令
+ * 2026-10-19 v2.4.7  新增周期任务的截止期限/抖动监视（period_mon），TIMERS命令由PERIODS命令取代，
+ *                    新增LCD周期页（LCD_PERIODS）
+ * 2026-10-19 v2.4.8  LCD像素循环、PWM脉冲回调与红外捕获回调放到SRAM执行（RAMFUNC/.ramfunc段），新增RAMFUNC命令
+ * 2026-10-19 v2.4.9  新增微基准登记表与BENCH命令（bench.c），RAMFUNC命令改用其中的测量项
+ * 2026-10-19 v2.5.0  启动剖析与分阶段并行初始化（boot.c），新增BOOT命令；LCD初始化不再重复清屏，
+ *                    控制任务不再固定延时500ms，红外接收初始化移到定时器服务任务作为启动阶段执行
+ * 2026-10-19 v2.5.1  delay_us/delay_ms/HAL_Delay改用TIM5+TIM1级联的us时间基准，不再读写SysTick，
+ *                    超过一个节拍的延时阻塞等待比较中断而不是忙等，新增DELAY命令
+ * 2026-10-19 v2.5.2  新增复位后保留的事件日志（journal.c，.noinit段），记录启动、模式切换、命令、故障与超期，
+ *                    新增JOURNAL/JOURNAL_CLEAR命令
  * ====================================================================
  * @endverbatim
  ************************************************************************/
@@ -39,20 +72,42 @@
 #include "cmsis_os.h"
 #include "gpio.h"
 
-#include "stdio.h"
 #include "stdarg.h"
 #include "string.h"
 #include "ctype.h"
 
 #include "lcd.h"
-#include "delay.h"
 #include "mytask.h"
+#include "myformat.h"
+#include "telemetry.h"
+#include "uart_drv.h"
+#include "cpu_stats.h"
+#include "power.h"
+#include "stack_mon.h"
+#include "time_srv.h"
+#include "trace.h"
+#include "latency.h"
+#include "mem_pool.h"
+#include "res_lock.h"
+#include "ctrl_loop.h"
+#include "period_mon.h"
+#include "ramfunc.h"
+#include "bench.h"
+#include "boot.h"
+#include "delay.h"
+#include "journal.h"
 
 extern osSemaphoreId_t LCD_refresh_gsemHandle;
-extern osSemaphoreId_t uart1_data_handle_gsemHandle;
+extern osMessageQueueId_t uart1_cmd_queueHandle;
+
+// LCD显示页面（指令处理任务写，LCD任务读，单字节读写本身是原子的）
+#define LCD_PAGE_MAIN    0
+#define LCD_PAGE_STATS   1
+#define LCD_PAGE_PERIODS 2
+static volatile unsigned char lcd_page = LCD_PAGE_MAIN;
 
 /**
- * @brief   多协议指令处理中枢（100ms轮询式）
+ * @brief   多协议指令处理中枢（队列驱动）
  * @param   argument: 系统数据聚合指针
  * @retval  None
  * @note    支持指令类型：
@@ -63,53 +118,284 @@ extern osSemaphoreId_t uart1_data_handle_gsemHandle;
  *          | LED_ON/OFF     | 强制LED开关          | 无参数                 |
  *          | BEEP_ON[time]  | 蜂鸣器定时鸣叫       | 时间参数(单位：ms)     |
  *          | BEEP_OFF       | 立即关闭蜂鸣器       | 无参数                 |
+ *          | TELEM_ON[hz]   | 开启遥测快照流       | 采样频率(1-200Hz)      |
+ *          | TELEM_OFF      | 关闭遥测快照流       | 无参数                 |
+ *          | TELEM_STAT     | 打印遥测带宽/抖动统计 | 无参数（多行应答）     |
+ *          | FLOW           | 打印串口流控状态      | 无参数                 |
+ *          | UART_STAT      | 打印各串口吞吐/延迟   | 无参数（多行应答）     |
+ *          | WAKE           | 打印各任务唤醒次数    | 无参数                 |
+ *          | STATS          | 打印各任务CPU占用等   | 无参数（多行应答）     |
+ *          | LCD_STATS/MAIN | 切换LCD统计页/主页面  | 无参数                 |
+ *          | LCD_PERIODS    | 切换LCD周期页        | 无参数                 |
+ *          | SLEEP          | 打印睡眠时长/唤醒原因 | 无参数                 |
+ *          | HEAP           | 打印FreeRTOS堆使用    | 无参数                 |
+ *          | STACK          | 打印栈峰值与建议大小  | 无参数（多行应答）     |
+ *          | STACK_SOAK[s]  | 重新开始栈浸泡计时    | 浸泡时长(单位：s)      |
+ *          | PERIODS        | 打印周期任务抖动/超期 | 无参数（多行应答）     |
+ *          | TIME           | 打印时间/上电时长     | 无参数                 |
+ *          | TIME_SET[t]    | 设定墙钟             | 时间参数(hh:mm:ss)     |
+ *          | TRACE          | 打印事件跟踪状态      | 无参数                 |
+ *          | TRACE_ON/OFF   | 清空并开始/停止跟踪   | 无参数                 |
+ *          | TRACE_DUMP     | 停止跟踪并输出记录    | 无参数（多行应答）     |
+ *          | LAT            | 打印端到端延迟分布    | 无参数（多行应答）     |
+ *          | LAT_RESET      | 清零延迟统计          | 无参数                 |
+ *          | POOL           | 打印内存池使用统计    | 无参数（多行应答）     |
+ *          | POOL_BENCH     | 池分配与堆分配耗时对比 | 无参数（多行应答）     |
+ *          | LOCKS          | 打印共享外设锁争用统计 | 无参数（多行应答）     |
+ *          | CTRL           | 打印控制周期抖动/超时 | 无参数                 |
+ *          | CTRL_RATE[hz]  | 设定控制周期频率      | 频率(500-5000Hz)       |
+ *          | RAMFUNC        | SRAM热点函数位置/耗时 | 无参数（多行应答）     |
+ *          | BENCH[name]    | 微基准测量/列出测量项 | 名称或all（多行应答）  |
+ *          | BOOT           | 打印启动各阶段时间线  | 无参数（多行应答）     |
+ *          | DELAY          | 打印延时忙等/阻塞统计 | 无参数                 |
+ *          | JOURNAL        | 打印复位前后的事件日志 | 无参数（多行应答）     |
+ *          | JOURNAL_CLEAR  | 清空事件日志          | 无参数                 |
  *          +----------------+----------------------+------------------------+
  *
+ *          命令帧由UART1_recv_Task按'\r'/'\n'或空闲中断分帧后存入cmd_pool的一块，块指针送入uart1_cmd_queue，
+ *          本任务阻塞在队列上，收到即处理，处理完释放该块，不再有固定轮询间隔。
+ *          每条命令恰好回复一行（以"\r\n"结尾），回复顺序与接收顺序一致，
+ *          未识别的命令回复"Unknown CMD"。
+ *          上位机据此做信用流控：未应答命令不超过UART1_FLOW_WINDOW条（见Tools/uart_stream.py），
+ *          Tools/uart_stress.py按同样的窗口连续发送并逐条核对应答，测量命令吞吐（主机仿真中115200波特率下约880条/s）。
+ *          TELEM_STAT/UART_STAT/STATS/STACK/PERIODS/TRACE_DUMP/LAT/POOL/POOL_BENCH/LOCKS/RAMFUNC/BENCH/BOOT/JOURNAL为多行应答，不应放在流式脚本中。
+ *          以'!'开头的行是主动上报（栈告警等），不是命令应答。
+ *
  * @warning 安全机制：
- *          - 指令缓冲区强制清零：防止残留指令误触发
+ *          - 每帧独立拷贝：命令之间不会互相覆盖
  *          - 参数范围校验：蜂鸣器时间限制在1-1000ms
- *          - 互斥访问：Response_Read_data为临界资源，处理完成自动清零
- *
+ *          - 本任务是LED与蜂鸣器分区的所有者，修改后发布快照，LED/蜂鸣器任务只读快照
  */
 void StartLEDProcessedTaskFunction(void *argument)
 {
     SYS_USE_DATA *SYS = (SYS_USE_DATA *)argument;
+    UART_CMD_FRAME *cmd;
+    boot_begin(BOOT_CMD);
+    // 上电默认：LED自动闪烁，蜂鸣器关闭
+    SYS->led_control_num.Led_num       = LED_AUTO;
+    SYS->Beep_control.Beep_control_num = BEEP_OFF;
+    SYS->Beep_control.Beep_delay_num   = 0;
+    sys_publish(SYS_PART_LED, &SYS->led_control_num);
+    sys_publish(SYS_PART_BEEP, &SYS->Beep_control);
+    boot_end(BOOT_CMD);
     /* 指令处理主循环 */
     for (;;) {
-        osSemaphoreAcquire(uart1_data_handle_gsemHandle, osWaitForever);
+        osMessageQueueGet(uart1_cmd_queueHandle, &cmd, NULL, osWaitForever);
+#if LAT_ENABLE
+        lat_record(LAT_PATH_CMD, LAT_CMD_DEQUEUED, cmd->t_rx);
+#endif
         // ==================== LED指令处理 ====================
-        if (strcmp(SYS->usart_use_data.Response_Read_data, "LED_AUTO") == 0) {
-            myprintf("Now LED AUTO");
+        if (strcmp(cmd->data, "LED_AUTO") == 0) {
+            myprintf("Now LED AUTO\r\n");
             SYS->led_control_num.Led_num = LED_AUTO; // 更新全局状态机
-        } else if (strcmp(SYS->usart_use_data.Response_Read_data, "LED_OFF") == 0) {
-            myprintf("Now LED OFF");
+            LAT_POST(LAT_PATH_CMD, LAT_CMD_GPIO, cmd->t_rx); // 起点交给led_apply，写引脚后统计端到端延迟
+            sys_publish(SYS_PART_LED, &SYS->led_control_num);
+        } else if (strcmp(cmd->data, "LED_OFF") == 0) {
+            myprintf("Now LED OFF\r\n");
             SYS->led_control_num.Led_num = LED_OFF;
-        } else if (strcmp(SYS->usart_use_data.Response_Read_data, "LED_ON") == 0) {
-            myprintf("Now LED ON");
+            LAT_POST(LAT_PATH_CMD, LAT_CMD_GPIO, cmd->t_rx);
+            sys_publish(SYS_PART_LED, &SYS->led_control_num);
+        } else if (strcmp(cmd->data, "LED_ON") == 0) {
+            myprintf("Now LED ON\r\n");
             SYS->led_control_num.Led_num = LED_ON;
+            LAT_POST(LAT_PATH_CMD, LAT_CMD_GPIO, cmd->t_rx);
+            sys_publish(SYS_PART_LED, &SYS->led_control_num);
         }
         // ==================== 蜂鸣器指令处理 ====================
-        if (strncmp(SYS->usart_use_data.Response_Read_data, "BEEP_ON", 7) == 0) {
-            myprintf("Now BEEP ON");
-            // 定义一个临时接收变量
-            char param_str[UART1_DMA_RX_LEN - 7];
-            // 将剩余字符读出来到这个接受变量
-            strcpy(param_str, SYS->usart_use_data.Response_Read_data + 7);
+        else if (strncmp(cmd->data, "BEEP_ON", 7) == 0) {
+            myprintf("Now BEEP ON\r\n");
             // 定义读出来的数字变量
             unsigned int read_data_num = 0;
-            // 将读出来的字符数字送给这个数字变量
-            sscanf(param_str, "%u", &read_data_num);
+            // 将剩余的字符数字送给这个数字变量
+            read_data_num = my_atou(cmd->data + 7);
             // 将其送给系统变量，以供调用
+            if (read_data_num > 1000) read_data_num = 1000;
             SYS->Beep_control.Beep_control_num = BEEP_AUTO;
             SYS->Beep_control.Beep_delay_num   = read_data_num;
-        } else if (strncmp(SYS->usart_use_data.Response_Read_data, "BEEP_OFF", 8) == 0) {
-            myprintf("Now BEEP OFF");
+            sys_publish(SYS_PART_BEEP, &SYS->Beep_control);
+        } else if (strncmp(cmd->data, "BEEP_OFF", 8) == 0) {
+            myprintf("Now BEEP OFF\r\n");
             SYS->Beep_control.Beep_control_num = BEEP_OFF;
             SYS->Beep_control.Beep_delay_num   = 0;
+            sys_publish(SYS_PART_BEEP, &SYS->Beep_control);
+        }
+        // ==================== 遥测指令处理 ====================
+        else if (strncmp(cmd->data, "TELEM_ON", 8) == 0) {
+            unsigned int hz = my_atou(cmd->data + 8);
+            if (hz < TELEMETRY_MIN_HZ) hz = TELEMETRY_MIN_HZ;
+            if (hz > TELEMETRY_MAX_HZ) hz = TELEMETRY_MAX_HZ;
+            myprintf("Now TELEM %uHz\r\n", hz);
+            telemetry_set_rate(hz);
+        } else if (strcmp(cmd->data, "TELEM_OFF") == 0) {
+            myprintf("Now TELEM OFF\r\n");
+            telemetry_set_rate(0);
+        } else if (strcmp(cmd->data, "TELEM_STAT") == 0) {
+            telemetry_report();
+        }
+        // ==================== 流控状态 ====================
+        else if (strcmp(cmd->data, "FLOW") == 0) {
+            uart1_flow_report();
+        } else if (strcmp(cmd->data, "UART_STAT") == 0) {
+            uart_drv_report(&uart1_drv);
+            uart_drv_report(&uart2_drv);
+        } else if (strcmp(cmd->data, "WAKE") == 0) {
+            sys_wake_report();
+        }
+        // ==================== 运行时间统计 ====================
+        else if (strcmp(cmd->data, "STATS") == 0) {
+            cpu_stats_report();
+        } else if (strcmp(cmd->data, "SLEEP") == 0) {
+            power_report();
+        } else if (strcmp(cmd->data, "HEAP") == 0) {
+            cpu_stats_heap_report();
+        } else if (strcmp(cmd->data, "PERIODS") == 0) {
+            period_mon_report();
+        }
+        // ==================== 时间服务 ====================
+        else if (strcmp(cmd->data, "TIME") == 0) {
+            time_report();
+        } else if (strncmp(cmd->data, "TIME_SET", 8) == 0) {
+            const char *p     = cmd->data + 8;
+            unsigned int hour = my_atou(p), minute = 0, second = 0;
+            // hh:mm:ss，分秒可省略
+            if ((p = strchr(p, ':')) != NULL) {
+                minute = my_atou(++p);
+                if ((p = strchr(p, ':')) != NULL) second = my_atou(p + 1);
+            }
+            if (time_set(hour, minute, second) == 0) {
+                myprintf("Now TIME %02u:%02u:%02u\r\n", hour, minute, second);
+            } else {
+                myprintf("TIME_SET bad time\r\n");
+            }
+        }
+        // ==================== 事件跟踪 ====================
+        else if (strcmp(cmd->data, "TRACE") == 0) {
+            trace_report();
+        } else if (strcmp(cmd->data, "TRACE_ON") == 0) {
+            myprintf("Now TRACE ON\r\n");
+            trace_start();
+        } else if (strcmp(cmd->data, "TRACE_OFF") == 0) {
+            trace_stop();
+            myprintf("Now TRACE OFF\r\n");
+        } else if (strcmp(cmd->data, "TRACE_DUMP") == 0) {
+            trace_dump();
+        }
+        // ==================== 端到端延迟 ====================
+        else if (strcmp(cmd->data, "LAT") == 0) {
+            lat_report();
+        } else if (strcmp(cmd->data, "LAT_RESET") == 0) {
+            lat_reset();
+            myprintf("Now LAT RESET\r\n");
+        } else if (strcmp(cmd->data, "STACK") == 0) {
+            stack_mon_report("");
+        } else if (strncmp(cmd->data, "STACK_SOAK", 10) == 0) {
+            unsigned int sec = my_atou(cmd->data + 10);
+            if (sec == 0) sec = STACK_MON_SOAK_S;
+            myprintf("Now STACK SOAK %us\r\n", sec);
+            stack_mon_soak(sec);
+        } else if (strcmp(cmd->data, "LCD_STATS") == 0) {
+            myprintf("Now LCD STATS\r\n");
+            lcd_page = LCD_PAGE_STATS;
+            osSemaphoreRelease(LCD_refresh_gsemHandle);
+        } else if (strcmp(cmd->data, "LCD_MAIN") == 0) {
+            myprintf("Now LCD MAIN\r\n");
+            lcd_page = LCD_PAGE_MAIN;
+            osSemaphoreRelease(LCD_refresh_gsemHandle);
+        } else if (strcmp(cmd->data, "LCD_PERIODS") == 0) {
+            myprintf("Now LCD PERIODS\r\n");
+            lcd_page = LCD_PAGE_PERIODS;
+            osSemaphoreRelease(LCD_refresh_gsemHandle);
+        }
+        // ==================== 内存池 ====================
+        else if (strcmp(cmd->data, "POOL") == 0) {
+            mem_pool_report();
+        } else if (strcmp(cmd->data, "POOL_BENCH") == 0) {
+            mem_pool_bench();
+        } else if (strcmp(cmd->data, "LOCKS") == 0) {
+            res_lock_report();
+        }
+        // ==================== 控制周期 ====================
+        else if (strcmp(cmd->data, "CTRL") == 0) {
+            ctrl_loop_report();
+        } else if (strncmp(cmd->data, "CTRL_RATE", 9) == 0) {
+            unsigned int hz = my_atou(cmd->data + 9);
+            if (ctrl_loop_set_rate(hz) == 0) {
+                myprintf("Now CTRL %uHz\r\n", hz);
+            } else {
+                myprintf("CTRL_RATE %u-%uHz\r\n", CTRL_LOOP_HZ_MIN, CTRL_LOOP_HZ_MAX);
+            }
+        } else if (strcmp(cmd->data, "RAMFUNC") == 0) {
+            ramfunc_report();
+        } else if (strcmp(cmd->data, "BOOT") == 0) {
+            boot_report();
+        } else if (strcmp(cmd->data, "DELAY") == 0) {
+            delay_report();
+        } else if (strcmp(cmd->data, "JOURNAL") == 0) {
+            journal_report();
+        } else if (strcmp(cmd->data, "JOURNAL_CLEAR") == 0) {
+            journal_clear();
+            myprintf("Now JOURNAL CLEAR\r\n");
+        } else if (strncmp(cmd->data, "BENCH", 5) == 0) {
+            const char *p = cmd->data + 5;
+            while (*p == ' ') p++;
+            bench_command(p);
+        } else {
+            myprintf("Unknown CMD\r\n");
         }
-        /* 指令缓冲区安全擦除 */
-        memset(SYS->usart_use_data.Response_Read_data, 0, UART1_DMA_RX_LEN);
-        osDelay(100); // 指令轮询间隔
+        mem_pool_free(&cmd_pool, cmd);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   LCD统计页：显示最近一个统计窗口（与STATS命令相同的数据）
+ * @param   view: 窗口数据缓冲（调用者静态分配）
+ * @retval  None
+ * @note    12号字体每行40字符，任务名截断为10个字符；各列定宽，刷新时直接覆盖旧内容
+ */
+static void lcd_show_stats(CPU_STATS_VIEW *view)
+{
+    static char line[41];
+    char name[11];
+    unsigned int i;
+    CPU_STATS_TASK *t;
+
+    cpu_stats_get(view);
+    if (view->seq == 0) {
+        lcd_show_string(10, 10, 240, 12, 12, "STATS no window yet", BLACK);
+        return;
+    }
+    my_snprintf(line, sizeof(line), "CPU %3u.%u%%  win %4ums  sw %6u", view->busy_permille / 10,
+                view->busy_permille % 10, view->window_us / 1000, view->switches);
+    lcd_show_string(10, 10, 240, 12, 12, line, BLACK);
+    lcd_show_string(10, 28, 240, 12, 12, "TASK       S PR  CPU%     SW  STK", BLUE);
+    for (i = 0; i < view->num; i++) {
+        t = &view->task[i];
+        memcpy(name, t->name, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        my_snprintf(line, sizeof(line), "%-10s %c %2u %3u.%u %6u %4u", name, t->state, t->prio, t->permille / 10,
+                    t->permille % 10, t->switches, t->stack_free);
+        lcd_show_string(10, 44 + i * 14, 240, 12, 12, line, BLACK);
+    }
+}
+
+/**
+ * @brief   LCD周期页：各周期任务的抖动/最长执行时间/截止期限错过次数（与PERIODS命令相同的数据）
+ * @retval  None
+ * @note    12号字体每行40字符，时间单位us；各列定宽，刷新时直接覆盖旧内容
+ */
+static void lcd_show_periods(void)
+{
+    static char line[41];
+    unsigned int i;
+    const PERIOD_MON *m;
+
+    lcd_show_string(10, 10, 240, 12, 12, "PERIODS us", BLACK);
+    lcd_show_string(10, 28, 240, 12, 12, "NAME     T(us)      N   JIT  EXEC MISS", BLUE);
+    for (i = 0; (m = period_mon_get(i)) != NULL; i++) {
+        my_snprintf(line, sizeof(line), "%-6s %7u %6u %5u %5u %4u", m->name, m->period_us, m->n,
+                    period_mon_cyc_to_us(m->jit_max), period_mon_cyc_to_us(m->exec_max), m->miss);
+        lcd_show_string(10, 44 + i * 14, 240, 12, 12, line, BLACK);
     }
 }
 
@@ -125,10 +411,13 @@ void StartLEDProcessedTaskFunction(void *argument)
  *          | L0   | 时间显示       | 1Hz     |
  *          | L1   | 设备信息       | 静态     |
  *          | L2   | 串口数据       | 事件触发 |
+ *          统计页（LCD_STATS命令切换）：各任务CPU占用/切换次数/栈剩余，1Hz
+ *          周期页（LCD_PERIODS命令切换）：各周期任务的抖动/执行时间/超期次数，1Hz
  *
  * @warning 注意以下内存风险：
- *          - lcd_id缓冲区仅12字节，确保sprintf不溢出
- *          - SYS->usart_use_data.Read_data需外部保证非NULL且'\0'结尾
+ *          - lcd_id缓冲区仅12字节，my_snprintf会按缓冲区大小截断
+ *          - 每次刷新都持有lcd_lock，其他任务绘制前也必须先获取该锁
+ *          - 显示的数据全部来自sys_snapshot取得的一致副本，不直接读取其他任务的数据
  *
  * 硬件依赖:
  * - FSMC接口: Bank1 NE1 (PD7)
@@ -140,28 +429,60 @@ void StartLEDProcessedTaskFunction(void *argument)
  */
 void StartLCDDisplayTaskFunction(void *argument)
 {
-    SYS_USE_DATA *SYS = (SYS_USE_DATA *)argument;
     uint8_t lcd_id[12]; // LCD ID显示缓冲（注意大小限制！）
+    // 各分区快照（静态存放，节省任务栈）
+    static TIME_USE_DATA time;
+    static USART_USE_DATA uart;
+    static BEEP_USE_DATA beep;
+    static REMOTE_USE_DATA remote;
+    // 上次显示的串口数据（用于对比变更，避免相同数据重复刷新）
+    static char last_read_data[UART1_DMA_RX_LEN];
+    static CPU_STATS_VIEW stats;
+    unsigned char shown_page = LCD_PAGE_MAIN;
+    unsigned char first_frame = 1;
+    (void)argument;
 
-    /* 硬件初始化链 */
-    delay_init(72);   // 精准延时（基于SysTick）
-    lcd_init();       // ILI9341驱动初始化
-    lcd_clear(WHITE); // 清屏操作（防止残影）
+    /* 硬件初始化链（启动阶段BOOT_LCD，与红外/控制/指令任务的启动并行；其中的复位延时阻塞等待，不占CPU） */
+    boot_begin(BOOT_LCD);
+    lcd_init(); // ILI9341驱动初始化（含复位延时与清屏，在本任务刷新之前没有其他任务访问LCD，不加锁）
+    boot_end(BOOT_LCD);
+    boot_begin(BOOT_FRAME);
 
     // 获取LCD硬件ID（关键诊断信息）
-    sprintf((char *)lcd_id, "LCD ID:%04X", lcddev.id);
+    my_snprintf((char *)lcd_id, sizeof(lcd_id), "LCD ID:%04X", lcddev.id);
 
     /* 主刷新循环 */
     for (;;) {
         // 等待刷新信号量（最大等待时间可配置）
         osSemaphoreAcquire(LCD_refresh_gsemHandle, osWaitForever);
+        // 每次刷新持有一次LCD总线锁
+        res_lock_take(&lcd_lock, osWaitForever);
+        if (lcd_page != shown_page) {
+            shown_page = lcd_page;
+            lcd_clear(WHITE);
+            last_read_data[0] = '\0'; // 回到主页面时重画串口数据行
+        }
+        if (shown_page == LCD_PAGE_STATS) {
+            lcd_show_stats(&stats);
+            res_lock_give(&lcd_lock);
+            continue;
+        }
+        if (shown_page == LCD_PAGE_PERIODS) {
+            lcd_show_periods();
+            res_lock_give(&lcd_lock);
+            continue;
+        }
+        sys_snapshot(SYS_PART_TIME, &time);
+        sys_snapshot(SYS_PART_UART, &uart);
+        sys_snapshot(SYS_PART_BEEP, &beep);
+        sys_snapshot(SYS_PART_REMOTE, &remote);
 
         /* ----- 时间显示区域（L0层）----- */
-        lcd_show_xnum(10, 10, SYS->Time_use_data.hours, 2, 24, 0x80, BLACK);  // 小时
-        lcd_show_string(34, 10, 240, 32, 24, ":", BLACK);                     // 冒号
-        lcd_show_xnum(46, 10, SYS->Time_use_data.minute, 2, 24, 0x80, BLACK); // 分钟
+        lcd_show_xnum(10, 10, time.hours, 2, 24, 0x80, BLACK);  // 小时
+        lcd_show_string(34, 10, 240, 32, 24, ":", BLACK);       // 冒号
+        lcd_show_xnum(46, 10, time.minute, 2, 24, 0x80, BLACK); // 分钟
         lcd_show_string(70, 10, 240, 32, 24, ":", BLACK);
-        lcd_show_xnum(82, 10, SYS->Time_use_data.second, 2, 24, 0x80, BLACK); // 秒
+        lcd_show_xnum(82, 10, time.second, 2, 24, 0x80, BLACK); // 秒
 
         /* ----- 设备信息区域（L1层）----- */
         lcd_show_string(10, 40, 240, 32, 32, "STM32F103ZET6", RED);  // 主控型号
@@ -173,85 +494,31 @@ void StartLCDDisplayTaskFunction(void *argument)
         lcd_show_string(10, 150, 240, 16, 16, "UART read data is :", BLACK);
         lcd_show_string(10, 190, 240, 16, 16, "Beep read data is :", BLACK);
 
-        if (strcmp(SYS->usart_use_data.Read_data, SYS->usart_use_data.Last_Read_data) != 0) {
+        if (strcmp(uart.Read_data, last_read_data) != 0) {
             // 将上次接受USART的数据改为当前数据
             // 这样可以阻止当数据相同时的再次刷新，节约CPU资源
-            strcpy(SYS->usart_use_data.Last_Read_data, SYS->usart_use_data.Read_data);
+            strcpy(last_read_data, uart.Read_data);
 
-            lcd_show_string(10, 170, 240, 16, 16, "              ", BLACK);                      // 清空当前行显示
-            lcd_show_string(10, 170, 240, 16, 16, (char *)SYS->usart_use_data.Read_data, BLACK); // 串口数据
+            lcd_show_string(10, 170, 240, 16, 16, "              ", BLACK); // 清空当前行显示
+            lcd_show_string(10, 170, 240, 16, 16, uart.Read_data, BLACK);   // 串口数据
 
-            lcd_show_string(10, 210, 240, 16, 16, "              ", BLACK);               // 清空当前行显示
-            lcd_show_xnum(10, 210, SYS->Beep_control.Beep_delay_num, 4, 16, 0X80, BLACK); // 读取出来的Beep延时数据（单位ms）
+            lcd_show_string(10, 210, 240, 16, 16, "              ", BLACK);  // 清空当前行显示
+            lcd_show_xnum(10, 210, beep.Beep_delay_num, 4, 16, 0X80, BLACK); // 读取出来的Beep延时数据（单位ms）
         }
         
         // 这里建议也改成检查当前按键按下时长和上次按下时长检测
         // 以此降低CPU占用率
-        lcd_show_num(10, 230, SYS->Remote_use_data.key, 3, 16, BLUE);          /* 显示键值 */
-        lcd_show_num(10, 250, SYS->Remote_use_data.g_remote_cnt, 3, 16, BLUE); /* 显示按键次数 */
-        lcd_fill(10, 270, 116 + 8 * 8, 170 + 16, WHITE);                       /* 清楚之前的显示 */
-        lcd_show_string(10, 270, 200, 16, 16, SYS->Remote_use_data.str, BLUE); /* 显示SYMBOL */
-
-        // 调试输出（建议使用条件编译控制）
-        // myprintf("LCD refresh data is :%s", SYS->usart_use_data.Read_data);
-    }
-}
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/**
- * @brief   系统时间维护任务（RTC模拟层）
- * @param   argument: 时间数据结构体指针
- * @retval  None
- * @note    实现以下功能：
- *          - 提供软件级RTC功能（精度依赖系统节拍）
- *          - 时间递增逻辑（23:59:50 → 00:00:00）
- *          - 触发LCD刷新信号
- *
- * 关键逻辑:
- * 1. 初始化时间为23:59:50（便于测试跨日场景）
- * 2. 每1000个系统节拍（1秒）触发时间递增
- * 3. 通过信号量同步LCD刷新
- *
- * @warning 注意：
- * - 需确保与LCD任务的优先级关系（建议本任务优先级更高）
- * - 长时间运行可能存在累积误差（建议定期同步）
- *
- * 改进建议:
- * 可添加RTC硬件同步接口（备份寄存器存取）
- */
-void StartTimeSetTaskFunction(void *argument)
-{
-    SYS_USE_DATA *SYS = (SYS_USE_DATA *)argument;
-
-    /* 初始化模拟RTC */
-    // 修改初始参数请前往mytask.h
-    SYS->Time_use_data.hours  = Set_Time_hours;  // 初始小时（测试跨日场景）
-    SYS->Time_use_data.minute = Set_Time_minute; // 初始分钟
-    SYS->Time_use_data.second = Set_Time_second; // 初始秒数
-
-    /* 时间维护主循环 */
-    for (;;) {
-        // 秒递增（原子操作建议）
-        SYS->Time_use_data.second++;
-
-        /* 时间进位逻辑链 */
-        if (SYS->Time_use_data.second >= 60) { // 分钟进位
-            SYS->Time_use_data.second = 0;
-            SYS->Time_use_data.minute++;
-
-            if (SYS->Time_use_data.minute >= 60) { // 小时进位
-                SYS->Time_use_data.minute = 0;
-                SYS->Time_use_data.hours++;
-
-                if (SYS->Time_use_data.hours >= 24) { // 日进位
-                    SYS->Time_use_data.hours = 0;
-                }
-            }
+        lcd_show_num(10, 230, remote.key, 3, 16, BLUE);          /* 显示键值 */
+        lcd_show_num(10, 250, remote.g_remote_cnt, 3, 16, BLUE); /* 显示按键次数 */
+        lcd_fill(10, 270, 116 + 8 * 8, 170 + 16, WHITE);         /* 清楚之前的显示 */
+        if (remote.str) lcd_show_string(10, 270, 200, 16, 16, remote.str, BLUE); /* 显示SYMBOL */
+        res_lock_give(&lcd_lock);
+        if (first_frame) {
+            first_frame = 0;
+            boot_end(BOOT_FRAME);
         }
 
-        /* 触发LCD刷新 */
-        osSemaphoreRelease(LCD_refresh_gsemHandle); // 释放信号量
-
-        // 精确延时（误差<1个系统节拍）
-        osDelay(1000); // 1000 ticks = 1秒（假设configTICK_RATE_HZ=1000）
+        // 调试输出（建议使用条件编译控制）
+        // myprintf("LCD refresh data is :%s", uart.Read_data);
     }
 }
@@ -0,0 +1,184 @@
+/**
+ * @file    period_mon.c
+ * @brief   周期任务的截止期限与抖动监视
+ * @note    周期任务（或周期回调）在初始化时用period_mon_init登记标称周期与截止期限，
+ *          每个周期开头调用period_mon_begin、做完本周期的工作后调用period_mon_end，
+ *          模块据此统计开始时刻的抖动与累计漂移、执行时间、响应时间与截止期限错过次数。
+ *          两个标记函数只读一次周期计数器（cpu_stats_cycles）并做几次整数加减比较，周期与期限预先换算为CPU周期，
+ *          72MHz下一对标记远小于1us（PERIODS命令首行的cost是现场实测值）。
+ *          PERIODS命令按登记顺序逐行打印，LCD周期页（LCD_PERIODS命令）显示同样的数据。
+ *          错过截止期限的周期同时写入事件日志（journal.c）：每个任务只记第1、2、4、8……次错过，
+ *          频繁错过的1kHz控制周期不会在几十毫秒内冲掉日志中的其他记录，准确的次数见PERIODS的miss。
+ *          已登记：clock（秒节拍刷新）、led（自动模式闪烁）、robot（控制周期，期限为执行预算）、stack（栈水位采样）、
+ *          beep（鸣叫周期，exec为实际鸣叫时长，期限为设定时长加BEEP_DEADLINE_MS）。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "period_mon.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+#include "journal.h"
+
+static PERIOD_MON *period_mon_table[PERIOD_MON_MAX];
+static unsigned char period_mon_num;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   CPU周期数换算为微秒
+ */
+unsigned int period_mon_cyc_to_us(unsigned int cyc)
+{
+    return cyc / (SystemCoreClock / 1000000U);
+}
+
+/**
+ * @brief   设定标称周期与截止期限并清零统计
+ * @param   m: 监视对象
+ * @param   period_us: 标称周期（us）
+ * @param   deadline_us: 相对释放时刻的截止期限（us）
+ * @retval  None
+ * @note    由该周期任务自己调用（例如控制频率改变时），下一个周期重新起算抖动
+ */
+void period_mon_set(PERIOD_MON *m, unsigned int period_us, unsigned int deadline_us)
+{
+    m->period_us    = period_us;
+    m->deadline_us  = deadline_us;
+    m->period_cyc   = period_us * (SystemCoreClock / 1000000U);
+    m->deadline_cyc = deadline_us * (SystemCoreClock / 1000000U);
+    m->t_prev       = 0;
+    m->late         = 0;
+    m->n            = 0;
+    m->miss         = 0;
+    m->jit_max      = 0;
+    m->drift        = 0;
+    m->exec_min     = ~0U;
+    m->exec_max     = 0;
+    m->exec_sum     = 0;
+    m->resp_max     = 0;
+}
+
+/**
+ * @brief   登记一个周期任务
+ * @param   m: 监视对象（静态分配）
+ * @param   name: 名称（PERIODS命令中显示，不超过6个字符对齐最好）
+ * @param   period_us: 标称周期（us）
+ * @param   deadline_us: 相对释放时刻的截止期限（us）
+ * @retval  None
+ * @note    在模块初始化时调用；超过PERIOD_MON_MAX的对象照常统计，但不出现在PERIODS中
+ */
+void period_mon_init(PERIOD_MON *m, const char *name, unsigned int period_us, unsigned int deadline_us)
+{
+    m->name = name;
+    m->id   = PERIOD_MON_MAX;
+    period_mon_set(m, period_us, deadline_us);
+    taskENTER_CRITICAL();
+    if (period_mon_num < PERIOD_MON_MAX) {
+        m->id                              = period_mon_num;
+        period_mon_table[period_mon_num++] = m;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief   下一个周期不统计抖动（周期定时器停止后重新启动时调用）
+ * @param   m: 监视对象
+ * @retval  None
+ */
+void period_mon_restart(PERIOD_MON *m)
+{
+    m->t_prev = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   标记一个周期开始
+ * @param   m: 监视对象
+ * @retval  None
+ * @note    释放时刻按上一周期开始时刻 + 标称周期推算，开始得比它晚的部分计入本周期的响应时间
+ */
+void period_mon_begin(PERIOD_MON *m)
+{
+    const unsigned int now = cpu_stats_cycles();
+    unsigned int jit;
+    int dev;
+
+    m->t_start = now;
+    m->late    = 0;
+    if (m->t_prev != 0) {
+        dev = (int)(now - m->t_prev - m->period_cyc);
+        m->drift += dev;
+        if (dev > 0) m->late = (unsigned int)dev;
+        jit = dev < 0 ? (unsigned int)-dev : (unsigned int)dev;
+        if (jit > m->jit_max) m->jit_max = jit;
+    }
+    m->t_prev = now | 1U;
+}
+
+/**
+ * @brief   标记一个周期结束
+ * @param   m: 监视对象
+ * @retval  None
+ */
+void period_mon_end(PERIOD_MON *m)
+{
+    const unsigned int exec = cpu_stats_cycles() - m->t_start;
+    const unsigned int resp = m->late + exec;
+
+    if (exec < m->exec_min) m->exec_min = exec;
+    if (exec > m->exec_max) m->exec_max = exec;
+    m->exec_sum += exec;
+    if (resp > m->resp_max) m->resp_max = resp;
+    if (resp > m->deadline_cyc) {
+        m->miss++;
+        if ((m->miss & (m->miss - 1U)) == 0U) journal_log(JOURNAL_DEADLINE, m->id, resp);
+    }
+    m->n++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   按登记顺序取监视对象（LCD周期页）
+ * @param   i: 序号
+ * @retval  监视对象，超出登记数时为NULL
+ */
+const PERIOD_MON *period_mon_get(unsigned int i)
+{
+    return i < period_mon_num ? period_mon_table[i] : NULL;
+}
+
+/**
+ * @brief   打印各周期任务的统计（PERIODS命令，多行应答，时间单位us）
+ * @note    首行cost为一对begin/end标记的实测开销（CPU周期，含抖动统计分支）
+ *          T/D  : 标称周期/截止期限
+ *          jit  : 最大开始抖动，drift为累计漂移
+ *          exec : 执行时间min/平均/max
+ *          resp : 最大响应时间，miss为错过截止期限的周期数
+ */
+void period_mon_report(void)
+{
+    PERIOD_MON probe;
+    const PERIOD_MON *m;
+    unsigned int i, t0, cost;
+
+    probe.id = PERIOD_MON_MAX;
+    period_mon_set(&probe, 1000U, 1000U);
+    period_mon_begin(&probe);
+    t0 = cpu_stats_cycles();
+    period_mon_begin(&probe);
+    period_mon_end(&probe);
+    cost = cpu_stats_cycles() - t0;
+
+    myprintf("PERIODS n=%u cost=%ucyc us\r\n", period_mon_num, cost);
+    for (i = 0; i < period_mon_num; i++) {
+        m = period_mon_table[i];
+        // 执行时间为毫秒级时（beep）整行超过UART_DRV_FMT_LEN，分两次输出
+        myprintf("  %-6s T=%u D=%u n=%u jit=%u drift=%d ", m->name, m->period_us, m->deadline_us, m->n,
+                 period_mon_cyc_to_us(m->jit_max), (int)(m->drift / (long long)(SystemCoreClock / 1000000U)));
+        myprintf("exec=%u/%u/%u resp=%u miss=%u\r\n", m->n ? period_mon_cyc_to_us(m->exec_min) : 0U,
+                 m->n ? period_mon_cyc_to_us((unsigned int)(m->exec_sum / m->n)) : 0U,
+                 period_mon_cyc_to_us(m->exec_max), period_mon_cyc_to_us(m->resp_max), m->miss);
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * @file    power.c
+ * @brief   无节拍空闲（configUSE_TICKLESS_IDLE）的睡眠前后处理与统计
+ * @note    所有任务都阻塞时，内核用SysTick一次定时到下一个任务唤醒时刻，空闲任务执行WFI进入睡眠模式，
+ *          醒来后由内核按实际经过的时间补齐节拍（vTaskStepTick）。
+ *          睡眠模式下外设照常运行（串口DMA、红外输入捕获、PWM都能唤醒CPU），所以不使用停止模式。
+ *          本文件负责：
+ *          - HAL时基TIM6：睡眠期间关闭其更新中断（否则每1ms唤醒一次），醒来后按TIM6计数补齐uwTick
+ *          - 运行时间统计：DWT周期计数在睡眠期间不增加时，把少计的周期补给cpu_stats
+ *          - 统计睡眠时长、唤醒原因与被跳过的节拍中断数（SLEEP命令）
+ *          PreSleepProcessing/PostSleepProcessing都在关中断（PRIMASK）状态下调用
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "power.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+
+extern TIM_HandleTypeDef htim6;
+
+static POWER_STAT power_stat;
+// 本次睡眠前的现场（仅空闲任务访问）
+static unsigned int power_dwt_pre;
+static unsigned int power_tim6_pre;
+static unsigned int power_hal_ticks;
+static unsigned int power_st_pending_pre;
+
+/**
+ * @brief   按挂起的中断判断唤醒原因（关中断状态下中断仍处于挂起）
+ */
+static POWER_WAKE_ID power_wake_source(void)
+{
+    unsigned int i, pend;
+
+    for (i = 0; i < 2; i++) {
+        pend = NVIC->ISPR[i] & NVIC->ISER[i];
+        if (pend == 0) continue;
+        switch (i * 32 + __CLZ(__RBIT(pend))) {
+            case USART1_IRQn:
+                return POWER_WAKE_UART1;
+            case USART2_IRQn:
+                return POWER_WAKE_UART2;
+            case DMA1_Channel4_IRQn:
+            case DMA1_Channel5_IRQn:
+            case DMA1_Channel6_IRQn:
+            case DMA1_Channel7_IRQn:
+                return POWER_WAKE_DMA;
+            case TIM4_IRQn:
+                return POWER_WAKE_IR;
+            case TIM8_UP_IRQn:
+            case TIM8_CC_IRQn:
+                return POWER_WAKE_PWM;
+            default:
+                return POWER_WAKE_OTHER;
+        }
+    }
+    return POWER_WAKE_OTHER;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   睡眠前处理（configPRE_SLEEP_PROCESSING）
+ * @param   ulExpectedIdleTime: 预计空闲节拍数（未使用，实际时长在醒来后由SysTick计算）
+ * @retval  None
+ * @note    调用时SysTick已按预计空闲时间重新装载并从LOAD开始递减
+ */
+void PreSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+    (void)ulExpectedIdleTime;
+    // HAL时基在睡眠期间不产生中断；睡前已到期还没处理的一个节拍先记下，避免它立即唤醒CPU
+    HAL_SuspendTick();
+    power_hal_ticks = 0;
+    if (__HAL_TIM_GET_FLAG(&htim6, TIM_FLAG_UPDATE)) {
+        __HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
+        HAL_NVIC_ClearPendingIRQ(TIM6_IRQn);
+        power_hal_ticks = 1;
+    }
+    power_tim6_pre       = __HAL_TIM_GET_COUNTER(&htim6);
+    power_st_pending_pre = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    power_dwt_pre        = DWT->CYCCNT;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   醒来后处理（configPOST_SLEEP_PROCESSING）
+ * @param   ulExpectedIdleTime: 预计空闲节拍数（未使用）
+ * @retval  None
+ * @note    只读取SysTick的LOAD/VAL与ICSR，不读CTRL（读CTRL会清除内核随后要检查的COUNTFLAG）
+ *          SysTick已经计到0（节拍中断挂起）说明预计的空闲时间到期，否则是其他中断提前唤醒
+ */
+void PostSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+    unsigned int load = SysTick->LOAD, val = SysTick->VAL;
+    unsigned int dwt = DWT->CYCCNT - power_dwt_pre;
+    unsigned int cyc, us, n;
+    POWER_WAKE_ID wake;
+    (void)ulExpectedIdleTime;
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && !power_st_pending_pre) {
+        cyc  = load + 1 + (load - val);
+        wake = POWER_WAKE_TICK;
+    } else {
+        cyc  = load - val;
+        wake = power_st_pending_pre ? POWER_WAKE_TICK : power_wake_source();
+    }
+    power_stat.sleeps++;
+    power_stat.sleep_cycles += cyc;
+    power_stat.wake[wake]++;
+
+    // DWT周期计数在睡眠中停止时，把少计的周期补给运行时间统计（空闲任务的运行时间包含睡眠）
+    if (cyc > dwt) cpu_stats_add_sleep(cyc - dwt);
+
+    // 按TIM6计数补齐睡眠期间的HAL节拍：TIM6一直在计数，溢出次数 = (睡前计数 + 睡眠us - 当前计数) / 1000
+    us = cyc / (SystemCoreClock / 1000000U);
+    n  = power_hal_ticks + (power_tim6_pre + us + 500U - __HAL_TIM_GET_COUNTER(&htim6)) / 1000U;
+    __HAL_TIM_CLEAR_FLAG(&htim6, TIM_FLAG_UPDATE);
+    HAL_NVIC_ClearPendingIRQ(TIM6_IRQn);
+    uwTick += n * uwTickFreq;
+    HAL_ResumeTick();
+}
+
+/**
+ * @brief   内核补齐节拍钩子（traceINCREASE_TICK_COUNT），参数即本次被跳过的节拍中断数
+ */
+void power_ticks_skipped(uint32_t ticks)
+{
+    power_stat.ticks_avoided += ticks;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印无节拍空闲统计（SLEEP命令，单行应答）
+ * @note    累计睡眠时长与各唤醒原因为上电以来的总数；
+ *          睡眠占比与每秒跳过的节拍数按距上一次SLEEP命令的时间计算
+ */
+void power_report(void)
+{
+    static unsigned int last_tick, last_avoided;
+    static unsigned long long last_cycles;
+    POWER_STAT st;
+    unsigned int now, dt, cyc_ms, slp_permille, skip_rate;
+
+    taskENTER_CRITICAL();
+    st = power_stat;
+    taskEXIT_CRITICAL();
+
+    now          = osKernelGetTickCount();
+    dt           = now - last_tick ? now - last_tick : 1;
+    cyc_ms       = SystemCoreClock / 1000U;
+    slp_permille = (unsigned int)((st.sleep_cycles - last_cycles) * 1000U / cyc_ms / dt);
+    if (slp_permille > 1000) slp_permille = 1000;
+    skip_rate    = (unsigned int)((unsigned long long)(st.ticks_avoided - last_avoided) * 1000U / dt);
+    myprintf("SLEEP %ums %u.%u%% n=%u skip/s=%u tick=%u u1=%u u2=%u dma=%u ir=%u pwm=%u oth=%u\r\n",
+             (unsigned int)(st.sleep_cycles / cyc_ms), slp_permille / 10, slp_permille % 10, st.sleeps,
+             skip_rate, st.wake[POWER_WAKE_TICK], st.wake[POWER_WAKE_UART1],
+             st.wake[POWER_WAKE_UART2], st.wake[POWER_WAKE_DMA], st.wake[POWER_WAKE_IR], st.wake[POWER_WAKE_PWM],
+             st.wake[POWER_WAKE_OTHER]);
+    last_tick    = now;
+    last_avoided = st.ticks_avoided;
+    last_cycles  = st.sleep_cycles;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file    ramfunc.c
+ * @brief   SRAM执行的热点函数：所在位置与执行时间测量（RAMFUNC命令）
+ * @note    用RAMFUNC标记（见ramfunc.h）的函数：
+ *          - LCD写GRAM与像素循环：lcd_wr_data/lcd_wr_regno/lcd_write_ram_prepare/lcd_set_cursor/lcd_draw_point/
+ *            lcd_clear/lcd_fill/lcd_show_char（lcd.c）
+ *          - PWM脉冲完成回调HAL_TIM_PWM_PulseFinishedCallback（robot.c）
+ *          - 红外输入捕获回调HAL_TIM_IC_CaptureCallback（remote.c）
+ *          RAMFUNC命令用微基准登记表（bench.c）中的对应测量项测每个函数，给出最短与中位数CPU周期数，
+ *          并按函数地址给出实际所在的存储器。RAMFUNC_ENABLE改为0重新编译后再测一次即为放入SRAM之前的数据。
+ *          各函数放入SRAM前后的周期数尚未在目标板上测量，上面列出的函数能否获益未经验证；
+ *          主机仿真中RAMFUNC为空，命令只输出host行，周期是主机时间，不能作为前后对比。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include <stdint.h>
+
+#include "ramfunc.h"
+#include "bench.h"
+#include "myprintf.h"
+#include "lcd.h"
+#include "remote.h"
+#include "robot.h"
+
+// RAMFUNC是否生效（主机仿真构建中为空）
+#if defined(HOST_SIM)
+#define RAMFUNC_STATE "host"
+#elif RAMFUNC_ENABLE
+#define RAMFUNC_STATE "on"
+#else
+#define RAMFUNC_STATE "off"
+#endif
+
+/**
+ * @brief   按地址判断函数所在的存储器
+ */
+static const char *ramfunc_where(uintptr_t addr)
+{
+#ifdef HOST_SIM
+    (void)addr;
+    return "host";
+#else
+    return (addr >= SRAM_BASE && addr < SRAM_BASE + 0x10000U) ? "sram" : "flash";
+#endif
+}
+
+/**
+ * @brief   RAMFUNC函数与测量它的BENCH测量项
+ */
+typedef struct {
+    const char *name;
+    uintptr_t addr;
+    const char *bench;
+} RAMFUNC_ITEM;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   测量各RAMFUNC函数的执行时间（RAMFUNC命令，多行应答，单位CPU周期）
+ * @retval  None
+ * @note    每行为所在存储器、最短/中位数周期数，当时不能测量的打印busy（见bench_command）
+ */
+void ramfunc_report(void)
+{
+    const RAMFUNC_ITEM item[] = {
+        {"lcd_fill 64x16", (uintptr_t)lcd_fill, "lcd_fill"},
+        {"lcd_show_char", (uintptr_t)lcd_show_char, "lcd_char"},
+        {"lcd_draw_point", (uintptr_t)lcd_draw_point, "lcd_point"},
+        {"pwm_pulse_cb", (uintptr_t)HAL_TIM_PWM_PulseFinishedCallback, "pwm_cb"},
+        {"ir_capture_cb", (uintptr_t)HAL_TIM_IC_CaptureCallback, "ir_capture"},
+    };
+    BENCH_RESULT r;
+    unsigned int i;
+
+    myprintf("RAMFUNC " RAMFUNC_STATE " min/med cyc\r\n");
+    for (i = 0; i < sizeof(item) / sizeof(item[0]); i++) {
+        if (bench_measure(bench_find(item[i].bench), &r) != 0) {
+            myprintf("  %-16s %-5s busy\r\n", item[i].name, ramfunc_where(item[i].addr));
+        } else {
+            myprintf("  %-16s %-5s %u/%u\r\n", item[i].name, ramfunc_where(item[i].addr), r.min, r.med);
+        }
+    }
+}
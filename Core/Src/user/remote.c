@@ -23,21 +23,54 @@
  */
 
 #include "remote.h"
+#include "timers.h"
+#include "time_srv.h"
+#include "trace.h"
+#include "latency.h"
+#include "ctrl_loop.h"
+#include "ramfunc.h"
 
 extern osSemaphoreId_t LCD_refresh_gsemHandle;
 
 TIM_HandleTypeDef g_tim4_handle; /* 定时器4句柄 */
+static void (*g_remote_handler)(void); /* 解码事件处理函数（在定时器服务任务中执行） */
+
+/**
+ * @brief       在定时器服务任务中执行解码事件处理函数（xTimerPendFunctionCallFromISR的目标）
+ */
+static void remote_dispatch(void *unused1, uint32_t unused2)
+{
+    (void)unused1;
+    (void)unused2;
+    g_remote_handler();
+}
+
+/**
+ * @brief       把新的红外事件挂到定时器服务任务处理（中断中调用）
+ */
+static void remote_notify(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (g_remote_handler) {
+        xTimerPendFunctionCallFromISR(remote_dispatch, NULL, 0, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
 
 /**
  * @brief       红外遥控初始化
  *   @note      设置IO以及定时器的输入捕获
- * @param       无
+ *              此后按键按下、重复码和松开时handler在定时器服务任务中执行一次，无需轮询remote_scan
+ * @param       handler: 解码事件处理函数（通常调用Read_remote_data并发布红外分区）
  * @retval      无
  */
-void remote_init(void)
+void remote_init(void (*handler)(void))
 {
     TIM_IC_InitTypeDef tim_ic_init_handle;
 
+    g_remote_handler = handler;
+
     g_tim4_handle.Instance           = REMOTE_IN_TIMX;     /* 通用定时器4 */
     g_tim4_handle.Init.Prescaler     = (72 - 1);           /* 预分频器,1M的计数频率,1us加1 */
     g_tim4_handle.Init.CounterMode   = TIM_COUNTERMODE_UP; /* 向上计数器 */
@@ -52,7 +85,7 @@ void remote_init(void)
     tim_ic_init_handle.ICFilter    = 0x03;                                             /* IC1F=0003 8个定时器时钟周期滤波 */
     HAL_TIM_IC_ConfigChannel(&g_tim4_handle, &tim_ic_init_handle, REMOTE_IN_TIMX_CHY); /* 配置TIM4通道4 */
     HAL_TIM_IC_Start_IT(&g_tim4_handle, REMOTE_IN_TIMX_CHY);                           /* 开始捕获TIM的通道值 */
-    __HAL_TIM_ENABLE_IT(&g_tim4_handle, TIM_IT_UPDATE);                                /* 使能更新中断 */
+    /* 更新（溢出）中断只在收到引导码后才打开，没有遥控信号时TIM4不再每10ms唤醒一次CPU */
 }
 
 /**
@@ -76,7 +109,7 @@ void HAL_TIM_IC_MspInit(TIM_HandleTypeDef *htim)
         gpio_init_struct.Speed = GPIO_SPEED_FREQ_HIGH;         /* 高速 */
         HAL_GPIO_Init(REMOTE_IN_GPIO_PORT, &gpio_init_struct); /* 初始化定时器通道引脚 */
 
-        HAL_NVIC_SetPriority(REMOTE_IN_TIMX_IRQn, 1, 3); /* 设置中断优先级，抢占优先级1，子优先级3 */
+        HAL_NVIC_SetPriority(REMOTE_IN_TIMX_IRQn, 5, 0); /* 抢占优先级5（与.ioc一致），不高于configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY才能在中断中通知任务 */
         HAL_NVIC_EnableIRQ(REMOTE_IN_TIMX_IRQn);         /* 开启ITM4中断 */
     }
 }
@@ -99,7 +132,9 @@ uint8_t g_remote_cnt   = 0; /* 按键按下的次数 */
  */
 void REMOTE_IN_TIMX_IRQHandler(void)
 {
+    TRACE_ISR_ENTER(REMOTE_IN_TIMX_IRQn);
     HAL_TIM_IRQHandler(&g_tim4_handle); /* 定时器共用处理函数 */
+    TRACE_ISR_EXIT(REMOTE_IN_TIMX_IRQn);
 }
 
 /**
@@ -112,12 +147,22 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     if (htim->Instance == TIM6) {
         HAL_IncTick();
     }
+    if (htim->Instance == TIM3) {
+        time_srv_second_isr(); /* 时间服务的硬件秒节拍 */
+    }
+    if (htim->Instance == TIM7) {
+        ctrl_loop_isr(); /* 释放控制周期 */
+    }
     if (htim->Instance == REMOTE_IN_TIMX) {
         if (g_remote_sta & 0x80) /* 上次有数据被接收到了 */
         {
             g_remote_sta &= ~0X10; /* 取消上升沿已经被捕获标记 */
 
             if ((g_remote_sta & 0X0F) == 0X00) {
+                if ((g_remote_sta & (1 << 6)) == 0) {
+                    LAT_PASS(LAT_PATH_IR, LAT_IR_NOTIFY, LAT_IR_DECODED);
+                    remote_notify(); /* 新按键 */
+                }
                 g_remote_sta |= 1 << 6; /* 标记已经完成一次按键的键值信息采集 */
             }
 
@@ -126,6 +171,8 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
             } else {
                 g_remote_sta &= ~(1 << 7); /* 清空引导标识 */
                 g_remote_sta &= 0XF0;      /* 清空计数器 */
+                remote_notify();           /* 按键松开 */
+                __HAL_TIM_DISABLE_IT(&g_tim4_handle, TIM_IT_UPDATE); /* 松开后停止溢出计时，等待下一个引导码 */
             }
         }
     }
@@ -135,8 +182,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
  * @brief       定时器输入捕获中断回调函数
  * @param       htim:定时器句柄
  * @retval      无
+ * @note        每个红外边沿进入一次（一帧约70个边沿），放在SRAM执行
  */
-void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
+RAMFUNC void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
 {
     if (htim->Instance == REMOTE_IN_TIMX) {
         uint16_t dval; /* 下降沿时计数器的值 */
@@ -150,6 +198,7 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
         {
             dval = HAL_TIM_ReadCapturedValue(&g_tim4_handle, REMOTE_IN_TIMX_CHY);                               /* 读取CCR4也可以清CC4IF标志位 */
             __HAL_TIM_SET_CAPTUREPOLARITY(&g_tim4_handle, REMOTE_IN_TIMX_CHY, TIM_INPUTCHANNELPOLARITY_RISING); /* 配置TIM4通道4上升沿捕获 */
+            LAT_START(LAT_PATH_IR, LAT_IR_NOTIFY); /* 红外路径起点：每个下降沿刷新，解码事件发出时为最后一次捕获 */
 
             if (g_remote_sta & 0X10) /* 完成一次高电平捕获 */
             {
@@ -168,11 +217,15 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
                     {
                         g_remote_cnt++;       /* 按键次数增加1次 */
                         g_remote_sta &= 0XF0; /* 清空计时器 */
+                        LAT_PASS(LAT_PATH_IR, LAT_IR_NOTIFY, LAT_IR_DECODED);
+                        remote_notify();      /* 重复码 */
                     }
                 } else if (dval > 4200 && dval < 4700) /* 4500为标准值4.5ms */
                 {
                     g_remote_sta |= 1 << 7; /* 标记成功接收到了引导码 */
                     g_remote_cnt = 0;       /* 清除按键次数计数器 */
+                    __HAL_TIM_CLEAR_IT(&g_tim4_handle, TIM_IT_UPDATE);  /* 丢弃空闲期间的溢出标志 */
+                    __HAL_TIM_ENABLE_IT(&g_tim4_handle, TIM_IT_UPDATE); /* 开始溢出计时（按键信息采集完成/松开检测） */
                 }
             }
 
@@ -181,6 +234,72 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
     }
 }
 
+/* 测量期间保存的定时器状态（BENCH命令，临界区内访问） */
+static uint32_t g_bench_cnt, g_bench_ccer, g_bench_data;
+
+/**
+ * @brief       ir_capture测量：正在接收一帧或引脚为低电平时不测量
+ * @note        空闲时引脚为高，测的是上升沿路径（改捕获极性、清计数器、置标记）：
+ *              整组测量在临界区内（TIM4中断同样被屏蔽），每次测量前恢复接收状态与捕获极性，最后恢复计数器
+ */
+static int remote_bench_capture_setup(void)
+{
+    if (g_remote_sta != 0 || !RDATA) return -1;
+    g_bench_cnt  = REMOTE_IN_TIMX->CNT;
+    g_bench_ccer = REMOTE_IN_TIMX->CCER;
+    return 0;
+}
+
+static void remote_bench_capture_prepare(void)
+{
+    g_remote_sta         = 0;
+    REMOTE_IN_TIMX->CCER = g_bench_ccer;
+}
+
+static void remote_bench_capture_run(void)
+{
+    HAL_TIM_IC_CaptureCallback(&g_tim4_handle);
+}
+
+static void remote_bench_capture_teardown(void)
+{
+    remote_bench_capture_prepare();
+    REMOTE_IN_TIMX->CNT = g_bench_cnt;
+}
+
+/**
+ * @brief       ir_scan测量：正在接收一帧时不测量
+ * @note        每次测量前放入一帧按键仍按下的有效数据（REMOTE_ID，键值70），测完恢复接收状态与数据
+ */
+static int remote_bench_scan_setup(void)
+{
+    if (g_remote_sta != 0) return -1;
+    g_bench_data = g_remote_data;
+    return 0;
+}
+
+static void remote_bench_scan_prepare(void)
+{
+    g_remote_sta  = 0xC0;
+    g_remote_data = ((uint32_t)(uint8_t)~70 << 24) | (70U << 16) | ((uint32_t)(uint8_t)~REMOTE_ID << 8) | REMOTE_ID;
+}
+
+static void remote_bench_scan_run(void)
+{
+    (void)remote_scan();
+}
+
+static void remote_bench_scan_teardown(void)
+{
+    g_remote_sta  = 0;
+    g_remote_data = g_bench_data;
+}
+
+const BENCH_CASE remote_bench_capture = {"ir_capture", remote_bench_capture_setup, remote_bench_capture_prepare,
+                                         remote_bench_capture_run, remote_bench_capture_teardown, 0, BENCH_F_ATOMIC};
+const BENCH_CASE remote_bench_scan    = {"ir_scan", remote_bench_scan_setup, remote_bench_scan_prepare,
+                                         remote_bench_scan_run, remote_bench_scan_teardown, 0, BENCH_F_ATOMIC};
+
 /**
  * @brief       处理红外按键(类似按键扫描)
  * @param       无
@@ -216,7 +335,7 @@ uint8_t remote_scan(void)
 
     return sta;
 }
-// 读取并处理红外遥控器收到的信号
+// 读取并处理红外遥控器收到的信号（收到REMOTE_EVT_FLAG后调用，本身不再延时等待）
 void Read_remote_data(REMOTE_USE_DATA *data)
 {
     data->key = remote_scan();
@@ -296,8 +415,9 @@ void Read_remote_data(REMOTE_USE_DATA *data)
         }
         // lcd_fill(86, 270, 116 + 8 * 8, 170 + 16, WHITE);  /* 清楚之前的显示 */
         // lcd_show_string(86, 270, 200, 16, 16, str, BLUE); /* 显示SYMBOL */
-    } else
-        osDelay(100);
+        // 已经松开：remote_scan松开后还会再返回一次键值，事件驱动下之后不会再有扫描，这里直接报告松开
+        if ((g_remote_sta & 0x80) == 0) data->key = 0;
+    }
     // 如果上一次统计的按下的时间和这一次统计的时间不一致，就刷新LCD
     if (data->g_remote_cnt != data->old_remote_cnt) {
         // 释放LCD刷新信号量
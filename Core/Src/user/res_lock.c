@@ -0,0 +1,134 @@
+/**
+ * @file    res_lock.c
+ * @brief   共享外设锁：优先级继承互斥量，附带等待/持有时间统计
+ * @note    保护跨任务共享的外设总线（串口发送环、FSMC LCD）。二值信号量没有优先级继承，
+ *          低优先级任务持有期间被中等优先级任务抢占时，高优先级等待者会被无限期拖延（优先级反转）；
+ *          互斥量让持有者临时继承等待者的优先级，等待时间不超过持有时间。
+ *          每把锁在res_lock_init时登记，LOCKS命令打印各锁的获取/等待次数、最长等待与最长持有（及其任务）、
+ *          超过持有预算的次数与当前持有者。
+ *          系统数据分区（SYS_USE_DATA）是单写者双缓冲快照，读写双方都不阻塞，不需要加锁（见my_sys_data.c）。
+ *          主机仿真构建（HOST_SIM）的控制台命令"pi"分别用二值信号量和本模块复现/验证优先级反转。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "res_lock.h"
+#include "myprintf.h"
+#include "cpu_stats.h"
+
+static RES_LOCK *res_lock_table[RES_LOCK_MAX];
+static unsigned char res_lock_num;
+
+/**
+ * @brief   DWT周期差转换为微秒
+ */
+static unsigned int res_lock_cyc_to_us(unsigned int cyc)
+{
+    return cyc / (SystemCoreClock / 1000000U);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   在锁对象内的静态控制块上创建互斥量并登记
+ * @param   lock: 锁对象
+ * @param   name: 名称（LOCKS命令中显示）
+ * @param   budget_us: 持有时间预算（us），0表示不检查
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中调用（调度器启动前）；超过RES_LOCK_MAX的锁照常可用，但不出现在LOCKS中
+ */
+void res_lock_init(RES_LOCK *lock, const char *name, unsigned int budget_us)
+{
+    const osMutexAttr_t attr = {
+        .name      = name,
+        .attr_bits = osMutexPrioInherit,
+        .cb_mem    = &lock->cb,
+        .cb_size   = sizeof(lock->cb),
+    };
+
+    lock->name      = name;
+    lock->budget_us = budget_us;
+    lock->id        = osMutexNew(&attr);
+    configASSERT(lock->id != NULL);
+    taskENTER_CRITICAL();
+    if (res_lock_num < RES_LOCK_MAX) res_lock_table[res_lock_num++] = lock;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief   获取锁
+ * @param   lock: 锁对象
+ * @param   timeout: 最长等待时间（节拍），osWaitForever表示一直等待
+ * @retval  0: 成功，-1: 超时
+ * @warning 禁止在中断中调用
+ */
+int res_lock_take(RES_LOCK *lock, unsigned int timeout)
+{
+    unsigned int t0 = 0, wait;
+
+    // 先不等待地尝试一次，失败才记录等待起点
+    if (osMutexAcquire(lock->id, 0) != osOK) {
+        t0 = cpu_stats_cycles() | 1U;
+        if (timeout == 0 || osMutexAcquire(lock->id, timeout) != osOK) {
+            taskENTER_CRITICAL();
+            lock->timeouts++;
+            taskEXIT_CRITICAL();
+            return -1;
+        }
+    }
+    // 以下只有持有者执行
+    lock->t_take = cpu_stats_cycles();
+    lock->owner  = osThreadGetId();
+    lock->takes++;
+    if (t0) {
+        lock->waits++;
+        wait = res_lock_cyc_to_us(lock->t_take - t0);
+        if (wait > lock->wait_max_us) lock->wait_max_us = wait;
+    }
+    return 0;
+}
+
+/**
+ * @brief   释放锁，统计本次持有时间
+ * @param   lock: 锁对象（必须由持有者释放）
+ * @retval  None
+ * @warning 禁止在中断中调用
+ */
+void res_lock_give(RES_LOCK *lock)
+{
+    unsigned int hold = res_lock_cyc_to_us(cpu_stats_cycles() - lock->t_take);
+
+    if (hold > lock->hold_max_us) {
+        lock->hold_max_us   = hold;
+        lock->hold_max_task = pcTaskGetName(NULL);
+    }
+    if (lock->budget_us && hold > lock->budget_us) lock->over++;
+    lock->owner = NULL;
+    osMutexRelease(lock->id);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印各锁的争用统计（LOCKS命令，多行应答，时间单位us）
+ * @note    take : 获取次数/其中需要等待的次数/等待超时次数
+ *          wait : 最长等待
+ *          hold : 最长持有及当时的持有者
+ *          over : 持有超过预算的次数/预算
+ *          owner: 当前持有者，'-'表示空闲
+ */
+void res_lock_report(void)
+{
+    unsigned int i;
+    RES_LOCK *l;
+    osThreadId_t owner;
+
+    myprintf("LOCKS n=%u us\r\n", res_lock_num);
+    for (i = 0; i < res_lock_num; i++) {
+        l     = res_lock_table[i];
+        owner = l->owner;
+        myprintf("  %-6s take=%u/%u/%u wait=%u hold=%u(%s) over=%u/%u owner=%s\r\n", l->name, l->takes, l->waits,
+                 l->timeouts, l->wait_max_us, l->hold_max_us, l->hold_max_task ? l->hold_max_task : "-", l->over,
+                 l->budget_us, owner ? pcTaskGetName((TaskHandle_t)owner) : "-");
+    }
+}
@@ -1,6 +1,11 @@
 #include "my_sys_data.h"
 #include "FreeRTOS.h"
 #include "string.h"
+#include "latency.h"
+#include "ctrl_loop.h"
+#include "ramfunc.h"
+#include "boot.h"
+#include "journal.h"
 
 // 定义PWM要输出的数周期数量
 // ROBOT.c私有变量
@@ -15,6 +20,15 @@ unsigned char Robot_Motor3_Ready = Robot_Motor_Ready;
 // 定义当前是否是自动模式
 // ROBOT.c私有变量
 unsigned char Robot_Mod_TIM_PWM = Robot_Mod_NULL;
+// 红外遥控数据快照（所有者是定时器服务任务（beep.c），本任务订阅该分区，每次发布后读取一次一致副本）
+// ROBOT.c私有变量
+static REMOTE_USE_DATA robot_remote;
+// 底盘方向键按住以来经过的控制周期数（决定P引脚脉冲的相位，松开清零）
+// ROBOT.c私有变量
+static unsigned int Car_Pulse_cycles = 0;
+// 最近一次发布的机械臂分区（只在数据变化时发布，不按控制频率唤醒订阅者）
+// ROBOT.c私有变量
+static ROBOT_USE_TYPE robot_published;
 /******************************************************************************************************************************************/
 // 变量传递函数，将要执行的PWM传递给这个C文件的私有变量
 // ROBOT.c私有函数
@@ -40,6 +54,10 @@ void Write_PWM_Num_to_local(unsigned char which_one, unsigned int inputnum)
 // 公共函数
 void Start_Robot_PWM_Function(SYS_USE_DATA *SYS, unsigned char channel_num)
 {
+    // 上一组脉冲还没有输出完（控制周期比一组脉冲短）时不重新装载计数，等它结束后由之后的控制周期再启动
+    if ((channel_num == 1 && Robot_Motor1_Ready == Robot_Motor_Busy) ||
+        (channel_num == 2 && Robot_Motor2_Ready == Robot_Motor_Busy) ||
+        (channel_num == 3 && Robot_Motor3_Ready == Robot_Motor_Busy)) return;
     // 这里需要将控制参数传递给这边自定义变量，否则无法直接调用SYS当中的参数
     Write_PWM_Num_to_local(1, SYS->Robot_use_data.Motor1.PWM_execution_count);
     Write_PWM_Num_to_local(2, SYS->Robot_use_data.Motor2.PWM_execution_count);
@@ -68,12 +86,16 @@ void Start_Robot_PWM_Function(SYS_USE_DATA *SYS, unsigned char channel_num)
         default:
             break;
     }
+    // 红外路径终点：PWM已启动
+    LAT_PASS(LAT_PATH_IR, LAT_IR_PWM, 0);
 }
 /******************************************************************************************************************************************/
 // 中断处理函数必须是先进行判断再进行自减，否则执行次数将会少1
-// 中断处理函数
-void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
+// 中断处理函数（每个PWM脉冲进入一次，是机械臂输出时最频繁的中断，放在SRAM执行）
+RAMFUNC void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
 {
+    // HAL对所有输出比较事件都调用本回调，TIM5的比较事件是延时服务的（delay.c）
+    if (htim->Instance != TIM8) return;
     // 确保计数不会超过限定，导致数据溢出
     // 所以我在这里引入了标志位，这个定时器同一时刻只能控制1个通道，当通道标志位为忙的时候才可以进行计数
     if ((Robot_Motor1_PWM_execution_num > 0) && (Robot_Motor1_Ready == Robot_Motor_Busy)) Robot_Motor1_PWM_execution_num = Robot_Motor1_PWM_execution_num - 1;
@@ -117,6 +139,62 @@ void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
         }
     }
 }
+
+// pwm_cb测量期间保存的电机1状态（BENCH命令，临界区内访问）
+static unsigned int robot_bench_num;
+static unsigned char robot_bench_ready;
+
+/**
+ * @brief   pwm_cb测量：任一电机正在输出时不测量，否则临时把电机1置忙
+ * @note    测的是脉冲计数递减的路径（输出过程中绝大多数脉冲走这条路径）：
+ *          整组测量在临界区内（TIM8中断同样被屏蔽），每次测量前给足计数，计数不会减到0，不会操作定时器。
+ *          回调同样会递减电机2/3的计数并在减到0时停止其PWM，所以三个电机都空闲时才测量，
+ *          此时电机2/3的状态与计数不会被回调改动
+ */
+static int robot_bench_setup(void)
+{
+    if (Robot_Motor1_Ready == Robot_Motor_Busy || Robot_Motor2_Ready == Robot_Motor_Busy ||
+        Robot_Motor3_Ready == Robot_Motor_Busy) return -1;
+    robot_bench_ready  = Robot_Motor1_Ready;
+    robot_bench_num    = Robot_Motor1_PWM_execution_num;
+    Robot_Motor1_Ready = Robot_Motor_Busy;
+    return 0;
+}
+
+static void robot_bench_prepare(void)
+{
+    Robot_Motor1_PWM_execution_num = 2;
+}
+
+static void robot_bench_run(void)
+{
+    HAL_TIM_PWM_PulseFinishedCallback(&htim8);
+}
+
+static void robot_bench_teardown(void)
+{
+    Robot_Motor1_PWM_execution_num = robot_bench_num;
+    Robot_Motor1_Ready             = robot_bench_ready;
+}
+
+// PWM脉冲完成回调的执行时间（BENCH命令中的pwm_cb）
+const BENCH_CASE robot_bench_pwm_cb = {"pwm_cb", robot_bench_setup, robot_bench_prepare, robot_bench_run,
+                                       robot_bench_teardown, 0, BENCH_F_ATOMIC};
+/**********************************************************************************************************************************************/
+// 底盘P引脚脉冲：方向键按住期间低电平、高电平各Car_Pulse_half_ms交替输出，每个控制周期调用一次
+// 原来在一次调用中用两次osDelay(10)输出一个脉冲，会阻塞控制周期；现在按周期计数推进相位，不阻塞
+// ROBOT.c私有函数
+static void Car_Motor_Pulse(void)
+{
+    const unsigned int half   = Car_Pulse_half_ms * ctrl_loop_hz() / 1000U;
+    const GPIO_PinState level = (Car_Pulse_cycles / half) & 1U ? GPIO_PIN_SET : GPIO_PIN_RESET;
+
+    Car_Pulse_cycles++;
+    HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, level);
+    HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, level);
+    HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, level);
+    HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, level);
+}
 /**********************************************************************************************************************************************/
 // 为了实现低内聚高耦合，因此在这里设定按键检测判断函数
 // Key_num是红外读取的key值
@@ -126,33 +204,33 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
     switch (Motor_num) {
         case 1:
             // 判断left
-            if (SYS->Remote_use_data.key == 68) {
+            if (robot_remote.key == 68) {
                 // 首先完成当前电机旋转方向值给予
                 // 也可以直接操作IO口（没写代码，需要写上）(IO低电平)
                 /**************************************/
                 HAL_GPIO_WritePin(Motor_GPIO_CH1_GPIO_Port, Motor_GPIO_CH1_Pin, GPIO_PIN_RESET);
                 /**************************************/
                 SYS->Robot_use_data.Motor1.Motor_rotation_direction = Robot_rotation_left;
-                // 输出PWM，因为osdelay为2，因此每个周期应该也为2
+                // 每组输出2个PWM脉冲，按住期间上一组结束后由之后的控制周期继续启动
                 SYS->Robot_use_data.Motor1.PWM_execution_count = 2;
                 // 这个红外遥控按钮遥控的是1号电机，因此操作一号电机启动
                 Start_Robot_PWM_Function(SYS, 1);
             }
             // 判断right
-            if (SYS->Remote_use_data.key == 67) {
+            if (robot_remote.key == 67) {
                 // 首先完成当前电机旋转方向值给予
                 // 也可以直接操作IO口（没写代码，需要写上）(IO高电平)
                 /**************************************/
                 HAL_GPIO_WritePin(Motor_GPIO_CH1_GPIO_Port, Motor_GPIO_CH1_Pin, GPIO_PIN_SET);
                 /**************************************/
                 SYS->Robot_use_data.Motor1.Motor_rotation_direction = Robot_rotation_right;
-                // 输出PWM，因为osdelay为2，因此每个周期应该也为2
+                // 每组输出2个PWM脉冲，按住期间上一组结束后由之后的控制周期继续启动
                 SYS->Robot_use_data.Motor1.PWM_execution_count = 2;
                 // 这个红外遥控按钮遥控的是1号电机，因此操作一号电机启动
                 Start_Robot_PWM_Function(SYS, 1);
             }
             // 自动清空PWM波参数
-            if (SYS->Remote_use_data.key == 0) {
+            if (robot_remote.key == 0) {
                 // 将PWM执行的参数清零
                 SYS->Robot_use_data.Motor1.PWM_execution_count = 0;
                 // 在这里清除IO口到默认设置（没写代码，需要写上，默认高电平）
@@ -163,40 +241,40 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
             break;
         case 2:
             // 判断up（低电平往前）
-            if (SYS->Remote_use_data.key == 70) {
+            if (robot_remote.key == 70) {
                 HAL_GPIO_WritePin(Motor_GPIO_CH2_GPIO_Port, Motor_GPIO_CH2_Pin, GPIO_PIN_RESET);
                 SYS->Robot_use_data.Motor2.Motor_rotation_direction = Robot_rotation_left;
                 SYS->Robot_use_data.Motor2.PWM_execution_count      = 2;
                 Start_Robot_PWM_Function(SYS, 2);
             }
             // 判断down（高电平往后）
-            if (SYS->Remote_use_data.key == 21) {
+            if (robot_remote.key == 21) {
                 HAL_GPIO_WritePin(Motor_GPIO_CH2_GPIO_Port, Motor_GPIO_CH2_Pin, GPIO_PIN_SET);
                 SYS->Robot_use_data.Motor2.Motor_rotation_direction = Robot_rotation_right;
                 SYS->Robot_use_data.Motor2.PWM_execution_count      = 2;
                 Start_Robot_PWM_Function(SYS, 2);
             }
-            if (SYS->Remote_use_data.key == 0) {
+            if (robot_remote.key == 0) {
                 SYS->Robot_use_data.Motor2.PWM_execution_count = 0;
                 HAL_GPIO_WritePin(Motor_GPIO_CH2_GPIO_Port, Motor_GPIO_CH2_Pin, GPIO_PIN_SET);
             }
             break;
         case 3:
             // 判断up（低电平上高）
-            if (SYS->Remote_use_data.key == 70) {
+            if (robot_remote.key == 70) {
                 HAL_GPIO_WritePin(Motor_GPIO_CH3_GPIO_Port, Motor_GPIO_CH3_Pin, GPIO_PIN_RESET);
                 SYS->Robot_use_data.Motor3.Motor_rotation_direction = Robot_rotation_left;
                 SYS->Robot_use_data.Motor3.PWM_execution_count      = 2;
                 Start_Robot_PWM_Function(SYS, 3);
             }
             // 判断down（高电平下低）
-            if (SYS->Remote_use_data.key == 21) {
+            if (robot_remote.key == 21) {
                 HAL_GPIO_WritePin(Motor_GPIO_CH3_GPIO_Port, Motor_GPIO_CH3_Pin, GPIO_PIN_SET);
                 SYS->Robot_use_data.Motor3.Motor_rotation_direction = Robot_rotation_right;
                 SYS->Robot_use_data.Motor3.PWM_execution_count      = 2;
                 Start_Robot_PWM_Function(SYS, 3);
             }
-            if (SYS->Remote_use_data.key == 0) {
+            if (robot_remote.key == 0) {
                 SYS->Robot_use_data.Motor3.PWM_execution_count = 0;
                 HAL_GPIO_WritePin(Motor_GPIO_CH3_GPIO_Port, Motor_GPIO_CH3_Pin, GPIO_PIN_SET);
             }
@@ -204,9 +282,9 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
             // 注意！从这里开始就是对小车底盘的控制了！
         case 4:
             // 按下left键，小车进行左转运动
-            if (SYS->Remote_use_data.key == 68) {
+            if (robot_remote.key == 68) {
                 // 对于小车左转，需要分别对电机1、电机2正转，电机3和电机4反转
-                // 并且需要将PWM信号进行正常输出，在这里表现为osDelay(2)即可，如果频率太高可以进行调整
+                // 并且需要将PWM信号进行正常输出，脉冲宽度见Car_Pulse_half_ms
                 // 电机1反转
                 HAL_GPIO_WritePin(Car_Motor_1IN1_GPIO_Port, Car_Motor_1IN1_Pin, GPIO_PIN_SET);
                 HAL_GPIO_WritePin(Car_Motor_1IN2_GPIO_Port, Car_Motor_1IN2_Pin, GPIO_PIN_RESET);
@@ -219,20 +297,11 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
                 // 电机4正转
                 HAL_GPIO_WritePin(Car_Motor_4IN1_GPIO_Port, Car_Motor_4IN1_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_4IN2_GPIO_Port, Car_Motor_4IN2_Pin, GPIO_PIN_SET);
-                // 对对应通道输出PWM信号
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_RESET);
-                osDelay(10);
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_SET);
-                osDelay(10);
+                // 对对应通道输出PWM信号（脉冲相位按控制周期推进）
+                Car_Motor_Pulse();
             }
             // 按下right键，小车进行右转运动
-            if (SYS->Remote_use_data.key == 67) {
+            if (robot_remote.key == 67) {
                 // 电机1反转
                 HAL_GPIO_WritePin(Car_Motor_1IN1_GPIO_Port, Car_Motor_1IN1_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_1IN2_GPIO_Port, Car_Motor_1IN2_Pin, GPIO_PIN_SET);
@@ -245,20 +314,11 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
                 // 电机4正转
                 HAL_GPIO_WritePin(Car_Motor_4IN1_GPIO_Port, Car_Motor_4IN1_Pin, GPIO_PIN_SET);
                 HAL_GPIO_WritePin(Car_Motor_4IN2_GPIO_Port, Car_Motor_4IN2_Pin, GPIO_PIN_RESET);
-                // 对对应通道输出PWM信号
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_RESET);
-                osDelay(10);
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_SET);
-                osDelay(10);
+                // 对对应通道输出PWM信号（脉冲相位按控制周期推进）
+                Car_Motor_Pulse();
             }
             // 按下up键，小车前进
-            if (SYS->Remote_use_data.key == 70) {
+            if (robot_remote.key == 70) {
                 // 电机1正转
                 HAL_GPIO_WritePin(Car_Motor_1IN1_GPIO_Port, Car_Motor_1IN1_Pin, GPIO_PIN_SET);
                 HAL_GPIO_WritePin(Car_Motor_1IN2_GPIO_Port, Car_Motor_1IN2_Pin, GPIO_PIN_RESET);
@@ -271,20 +331,11 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
                 // 电机4反转
                 HAL_GPIO_WritePin(Car_Motor_4IN1_GPIO_Port, Car_Motor_4IN1_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_4IN2_GPIO_Port, Car_Motor_4IN2_Pin, GPIO_PIN_SET);
-                // 对对应通道输出PWM信号
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_RESET);
-                osDelay(10);
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_SET);
-                osDelay(10);
+                // 对对应通道输出PWM信号（脉冲相位按控制周期推进）
+                Car_Motor_Pulse();
             }
             // 按下down键，小车后退
-            if (SYS->Remote_use_data.key == 21) {
+            if (robot_remote.key == 21) {
 
                 // 电机1正转
                 HAL_GPIO_WritePin(Car_Motor_1IN1_GPIO_Port, Car_Motor_1IN1_Pin, GPIO_PIN_RESET);
@@ -298,20 +349,11 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
                 // 电机4反转
                 HAL_GPIO_WritePin(Car_Motor_4IN1_GPIO_Port, Car_Motor_4IN1_Pin, GPIO_PIN_SET);
                 HAL_GPIO_WritePin(Car_Motor_4IN2_GPIO_Port, Car_Motor_4IN2_Pin, GPIO_PIN_RESET);
-                // 对对应通道输出PWM信号
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_RESET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_RESET);
-                osDelay(10);
-                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_SET);
-                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_SET);
-                osDelay(10);
+                // 对对应通道输出PWM信号（脉冲相位按控制周期推进）
+                Car_Motor_Pulse();
             }
             // 没有按下任何按键的时候，需要将所有IO全部放置于0
-            if (SYS->Remote_use_data.key == 0) {
+            if (robot_remote.key == 0) {
                 HAL_GPIO_WritePin(Car_Motor_1IN1_GPIO_Port, Car_Motor_1IN1_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_1IN2_GPIO_Port, Car_Motor_1IN2_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_2IN1_GPIO_Port, Car_Motor_2IN1_Pin, GPIO_PIN_RESET);
@@ -320,7 +362,12 @@ void Infrared_directional_button_detection(SYS_USE_DATA *SYS, unsigned char Moto
                 HAL_GPIO_WritePin(Car_Motor_3IN2_GPIO_Port, Car_Motor_3IN2_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_4IN1_GPIO_Port, Car_Motor_4IN1_Pin, GPIO_PIN_RESET);
                 HAL_GPIO_WritePin(Car_Motor_4IN2_GPIO_Port, Car_Motor_4IN2_Pin, GPIO_PIN_RESET);
-                osDelay(5);
+                // P引脚回到空闲高电平，下次按键从脉冲低电平开始
+                HAL_GPIO_WritePin(Car_Motor_1P1_GPIO_Port, Car_Motor_1P1_Pin, GPIO_PIN_SET);
+                HAL_GPIO_WritePin(Car_Motor_2P1_GPIO_Port, Car_Motor_2P1_Pin, GPIO_PIN_SET);
+                HAL_GPIO_WritePin(Car_Motor_3P1_GPIO_Port, Car_Motor_3P1_Pin, GPIO_PIN_SET);
+                HAL_GPIO_WritePin(Car_Motor_4P1_GPIO_Port, Car_Motor_4P1_Pin, GPIO_PIN_SET);
+                Car_Pulse_cycles = 0;
             }
 
             break;
@@ -339,23 +386,23 @@ void remote_control_robot(SYS_USE_DATA *SYS)
     // 当红外按钮为ALIENTEK时设定为手动模式
     // 自动模式可以后期加上
     // 注意这里可千万别用switch，因为switch没有办法判断字符串！
-    if (strcmp(SYS->Remote_use_data.str, "POWER") == 0) {
+    if (strcmp(robot_remote.str, "POWER") == 0) {
         // 启动空模式
         SYS->Robot_use_data.Motor_Mod = Robot_Mod_NULL;
     }
-    if (strcmp(SYS->Remote_use_data.str, "PLAY") == 0) {
+    if (strcmp(robot_remote.str, "PLAY") == 0) {
         // 启动小车移动控制模式（这个需要4个通道控制）
         SYS->Robot_use_data.Motor_Mod = Robot_Mod_Move;
     }
-    if (strcmp(SYS->Remote_use_data.str, "1") == 0) {
+    if (strcmp(robot_remote.str, "1") == 0) {
         // 启动电机1单独控制模式
         SYS->Robot_use_data.Motor_Mod = Robot_Mod_Motor1;
     }
-    if (strcmp(SYS->Remote_use_data.str, "2") == 0) {
+    if (strcmp(robot_remote.str, "2") == 0) {
         // 启动电机2单独控制模式
         SYS->Robot_use_data.Motor_Mod = Robot_Mod_Motor2;
     }
-    if (strcmp(SYS->Remote_use_data.str, "3") == 0) {
+    if (strcmp(robot_remote.str, "3") == 0) {
         // 启动电机3单独控制模式
         SYS->Robot_use_data.Motor_Mod = Robot_Mod_Motor3;
     }
@@ -383,8 +430,7 @@ void remote_control_robot(SYS_USE_DATA *SYS)
             Infrared_directional_button_detection(SYS, 4);
             break;
         case Robot_Mod_NULL:
-            // 空模式这里目前什么都不执行
-            osDelay(2);
+            // 空模式这里目前什么都不执行（任务随后阻塞等待红外事件）
             break;
         // 如果是自动模式或者其他就退出函数
         default:
@@ -393,16 +439,53 @@ void remote_control_robot(SYS_USE_DATA *SYS)
 }
 
 /******************************************************************************************************************************************/
-// 任务执行函数
+// 任务执行函数（控制周期由TIM7定时释放，见ctrl_loop.c；周期内不能调用任何会阻塞的接口）
 // 任务函数
 void StartRobotmainControlTask(void *argument)
 {
     SYS_USE_DATA *SYS = (SYS_USE_DATA *)argument;
-    osDelay(500);
+    unsigned int remote_ver, ver;
+    // 启动阶段：原来固定等待500ms，现在只等它真正依赖的红外接收初始化（见boot.c）
+    boot_begin(BOOT_ROBOT);
     // 首先需要将mod模式设定为NULL
     SYS->Robot_use_data.Motor_Mod = Robot_Mod_NULL;
+    sys_publish(SYS_PART_ROBOT, &SYS->Robot_use_data);
+    memcpy(&robot_published, &SYS->Robot_use_data, sizeof(robot_published));
+    sys_subscribe(SYS_PART_REMOTE);
+    // 第一个周期无条件读取一次红外快照
+    remote_ver = sys_part_version(SYS_PART_REMOTE) - 1U;
+    ctrl_loop_start();
+    boot_end(BOOT_ROBOT);
     for (;;) {
+        // 周期之间唯一的阻塞点：等待定时器释放下一个控制周期
+        ctrl_loop_wait();
+        // 红外分区有新发布才拷贝快照
+        ver = sys_part_version(SYS_PART_REMOTE);
+        if (ver != remote_ver) {
+            remote_ver = ver;
+            sys_snapshot(SYS_PART_REMOTE, &robot_remote);
+            if (robot_remote.str == 0) robot_remote.str = "";
+            LAT_PASS(LAT_PATH_IR, LAT_IR_ROBOT, LAT_IR_PWM);
+        }
         remote_control_robot(SYS);
-        osDelay(2);
+        // 本次按键没有启动PWM（非控制键、空模式或上一组脉冲未结束），不让它的起点留给之后的PWM启动
+        LAT_CANCEL(LAT_PATH_IR, LAT_IR_PWM);
+        // 本任务是机械臂分区的所有者，数据变化后发布快照
+        if (memcmp(&robot_published, &SYS->Robot_use_data, sizeof(robot_published)) != 0) {
+            if (robot_published.Motor_Mod != SYS->Robot_use_data.Motor_Mod) {
+                journal_log(JOURNAL_MODE, SYS->Robot_use_data.Motor_Mod, robot_published.Motor_Mod);
+            }
+            memcpy(&robot_published, &SYS->Robot_use_data, sizeof(robot_published));
+            sys_publish(SYS_PART_ROBOT, &SYS->Robot_use_data);
+        }
+        // 松开或空模式时没有需要控制的对象：停止控制周期，阻塞到红外分区下一次发布后再继续
+        if (!robot_remote.key || SYS->Robot_use_data.Motor_Mod == Robot_Mod_NULL) {
+            ctrl_loop_stop();
+            osThreadFlagsClear(SYS_EVT(SYS_PART_REMOTE));
+            if (sys_part_version(SYS_PART_REMOTE) == remote_ver) {
+                sys_wait(SYS_WAKE_ROBOT, SYS_EVT(SYS_PART_REMOTE), osWaitForever);
+            }
+            ctrl_loop_start();
+        }
     }
 }
@@ -0,0 +1,175 @@
+/**
+ * @file    stack_mon.c
+ * @brief   任务栈水位监视与栈大小建议
+ * @note    各任务在freertos.c创建后用stack_mon_add登记栈大小，IDLE与定时器服务任务在首次采样时自动登记。
+ *          defauleTask每STACK_MON_PERIOD_MS调用一次stack_mon_sample，用uxTaskGetStackHighWaterMark
+ *          读取每个任务的历史最低剩余，换算为峰值用量：
+ *          - 峰值超过STACK_MON_WARN_PCT时在串口1主动告警（行首为STACK_MON_ASYNC）
+ *          - 记录峰值最后一次增长的时刻，浸泡期结束时若仍在增长说明浸泡时间不够
+ *          - 浸泡期（默认STACK_MON_SOAK_S）结束后自动打印一次建议栈大小，STACK命令随时查看
+ *          水位由内核在栈填充值0xA5上计算，是上电以来的峰值，重新开始浸泡不会清零峰值。
+ *          主机仿真构建（HOST_SIM）中可以编译运行，但POSIX移植的任务运行在各自的线程栈上，
+ *          登记的栈缓冲区不会被使用，峰值恒为0，建议大小没有意义；STACK首行标出"host"以免误用。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "stack_mon.h"
+#include "myprintf.h"
+#include "time_srv.h"
+#include "period_mon.h"
+
+// 主机仿真中栈水位不可测（见文件说明）
+#ifdef HOST_SIM
+#define STACK_MON_HOST " host:peak n/a"
+#else
+#define STACK_MON_HOST ""
+#endif
+
+/**
+ * @brief  单个任务的栈监视数据
+ */
+typedef struct {
+    TaskHandle_t handle;
+    unsigned short size;   //!< 栈大小（字）
+    unsigned short peak;   //!< 峰值用量（字）
+    unsigned short warned; //!< 已告警的峰值（字），0表示未告警
+    unsigned int grown_s;  //!< 峰值最后一次增长的时刻（浸泡开始后的秒数）
+} STACK_MON_TASK;
+
+static STACK_MON_TASK stack_mon_task[STACK_MON_MAX_TASKS];
+static unsigned char stack_mon_num;
+static unsigned char stack_mon_kernel_added;
+// 采样周期监视（PERIODS命令）
+static PERIOD_MON stack_mon_period;
+// 浸泡期（仅defauleTask与指令处理任务访问，单字读写）
+static volatile unsigned int stack_mon_soak_start;
+static volatile unsigned int stack_mon_soak_len = STACK_MON_SOAK_S;
+static volatile unsigned char stack_mon_soak_done;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   登记一个任务的栈
+ * @param   thread: 任务句柄
+ * @param   stack_bytes: 栈大小（字节，与osThreadAttr_t.stack_size一致）
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中创建任务之后调用；超过STACK_MON_MAX_TASKS的任务不监视
+ */
+void stack_mon_add(osThreadId_t thread, unsigned int stack_bytes)
+{
+    STACK_MON_TASK *t;
+
+    if (thread == NULL || stack_mon_num >= STACK_MON_MAX_TASKS) return;
+    taskENTER_CRITICAL();
+    t         = &stack_mon_task[stack_mon_num];
+    t->handle = (TaskHandle_t)thread;
+    t->size   = stack_bytes / sizeof(StackType_t);
+    t->peak   = 0;
+    t->warned = 0;
+    stack_mon_num++;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief   浸泡开始后经过的秒数
+ */
+static unsigned int stack_mon_elapsed_s(void)
+{
+    return (osKernelGetTickCount() - stack_mon_soak_start) / configTICK_RATE_HZ;
+}
+
+/**
+ * @brief   建议栈大小（字）
+ */
+static unsigned int stack_mon_recommend(const STACK_MON_TASK *t)
+{
+    unsigned int rec = (unsigned int)t->peak * (100 + STACK_MON_MARGIN_PCT) / 100 + STACK_MON_GUARD_WORDS;
+
+    return (rec + 7) & ~7U;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   采样所有登记任务的栈水位（defauleTask中周期调用）
+ * @retval  None
+ * @note    峰值创新高且超过告警阈值时主动上报；浸泡期结束时主动打印一次报告
+ */
+void stack_mon_sample(void)
+{
+    STACK_MON_TASK *t;
+    unsigned int i, used, now_s;
+
+    // IDLE与定时器服务任务由调度器创建，调度器运行后才能取得句柄
+    if (!stack_mon_kernel_added) {
+        stack_mon_kernel_added = 1;
+        // 采样周期由osDelay给出，间隔包含本次采样的执行时间，drift随之累积；期限取一个采样周期
+        period_mon_init(&stack_mon_period, "stack", STACK_MON_PERIOD_MS * 1000U, STACK_MON_PERIOD_MS * 1000U);
+        stack_mon_add(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE * sizeof(StackType_t));
+        stack_mon_add(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH * sizeof(StackType_t));
+    }
+    period_mon_begin(&stack_mon_period);
+
+    now_s = stack_mon_elapsed_s();
+    for (i = 0; i < stack_mon_num; i++) {
+        t    = &stack_mon_task[i];
+        used = t->size - uxTaskGetStackHighWaterMark(t->handle);
+        if (used <= t->peak) continue;
+        t->peak    = used;
+        t->grown_s = now_s;
+        if (used * 100 >= (unsigned int)t->size * STACK_MON_WARN_PCT) {
+            t->warned = used;
+            myprintf(STACK_MON_ASYNC "STACK WARN @%us %s %u/%u words (%u%%) rec=%u\r\n", time_uptime_s(),
+                     pcTaskGetName(t->handle), used, t->size, used * 100 / t->size, stack_mon_recommend(t));
+        }
+    }
+
+    if (!stack_mon_soak_done && now_s >= stack_mon_soak_len) {
+        stack_mon_soak_done = 1;
+        stack_mon_report(STACK_MON_ASYNC);
+    }
+    period_mon_end(&stack_mon_period);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   重新开始浸泡期
+ * @param   seconds: 浸泡时长（s）
+ * @retval  None
+ * @note    峰值不清零，只重新计时；到期后自动打印一次报告
+ */
+void stack_mon_soak(unsigned int seconds)
+{
+    stack_mon_soak_done  = 0;
+    stack_mon_soak_len   = seconds;
+    stack_mon_soak_start = osKernelGetTickCount();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印各任务栈峰值与建议大小（STACK命令，多行应答）
+ * @param   prefix: 每行的前缀，命令应答为""，主动上报为STACK_MON_ASYNC
+ * @retval  None
+ * @note    每个任务一行：名称 栈大小 峰值 使用率 建议大小 峰值最后增长时刻（浸泡开始后的秒数），单位为字；
+ *          浸泡结束前最后增长时刻接近当前时刻的任务，峰值可能还没有出现
+ */
+void stack_mon_report(const char *prefix)
+{
+    STACK_MON_TASK *t;
+    unsigned int i, total = 0, total_rec = 0;
+
+    myprintf("%sSTACK soak=%u/%us%s warn=%u%% margin=%u%%+%u" STACK_MON_HOST "\r\n", prefix, stack_mon_elapsed_s(),
+             stack_mon_soak_len, stack_mon_soak_done ? " done" : "", STACK_MON_WARN_PCT, STACK_MON_MARGIN_PCT,
+             STACK_MON_GUARD_WORDS);
+    for (i = 0; i < stack_mon_num; i++) {
+        t = &stack_mon_task[i];
+        myprintf("%s  %-16s size=%3u peak=%3u %3u%% rec=%3u grown@%us%s\r\n", prefix, pcTaskGetName(t->handle),
+                 t->size, t->peak, t->peak * 100 / t->size, stack_mon_recommend(t), t->grown_s,
+                 t->warned ? " WARN" : "");
+        total += t->size;
+        total_rec += stack_mon_recommend(t);
+    }
+    myprintf("%s  total size=%u rec=%u words\r\n", prefix, total, total_rec);
+}
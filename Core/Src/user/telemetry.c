@@ -0,0 +1,304 @@
+/**
+ * @file    telemetry.c
+ * @brief   SYS_USE_DATA遥测快照流
+ * @note    按设定频率（1~200Hz）采样系统数据，与上一次成功发送的快照做逐字节差分，
+ *          通过TELEMETRY_UART端口发送紧凑的二进制帧。写入发送环时不等待，
+ *          发送环空间不足时直接丢弃本次采样（下次仍与上一次成功发送的快照比较），
+ *          因此不会阻塞任何控制任务。
+ *          命令：TELEM_ON<hz> 开启，TELEM_OFF 关闭，TELEM_STAT 打印带宽与抖动统计
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+#include "my_sys_data.h"
+#include "telemetry.h"
+#include "uart_drv.h"
+#include "cpu_stats.h"
+
+extern osThreadId_t TelemetryTaskHandle;
+
+// 快照字段描述（顺序即为快照中的字节顺序，上位机解码器需保持一致）
+typedef struct {
+    const char *name;
+    unsigned char size;
+} TELEMETRY_FIELD;
+
+static const TELEMETRY_FIELD telemetry_fields[] = {
+    {"robot_mod", 1},
+    {"m1_dir", 1},
+    {"m1_deg", 1},
+    {"m1_pwm", 4},
+    {"m2_dir", 1},
+    {"m2_deg", 1},
+    {"m2_pwm", 4},
+    {"m3_dir", 1},
+    {"m3_deg", 1},
+    {"m3_pwm", 4},
+    {"car_dir", 1},
+    {"car_pwm", 4},
+    {"hours", 1},
+    {"minute", 1},
+    {"second", 1},
+    {"led", 1},
+    {"beep_ctrl", 1},
+    {"beep_ms", 2},
+    {"ir_key", 1},
+    {"ir_cnt", 1},
+};
+#define TELEMETRY_FIELD_NUM    (sizeof(telemetry_fields) / sizeof(telemetry_fields[0]))
+#define TELEMETRY_SNAPSHOT_LEN 33
+#define TELEMETRY_BITMAP_LEN   ((TELEMETRY_SNAPSHOT_LEN + 7) / 8)
+#define TELEMETRY_HEADER_LEN   9
+#define TELEMETRY_FRAME_MAX    (TELEMETRY_HEADER_LEN + TELEMETRY_BITMAP_LEN + TELEMETRY_SNAPSHOT_LEN + 1)
+
+// 遥测统计
+typedef struct {
+    unsigned int frames;      // 已发送帧数
+    unsigned int keyframes;   // 其中关键帧数
+    unsigned int bytes;       // 已发送字节数
+    unsigned int busy_drops;  // 串口忙导致丢弃的采样数
+    unsigned int unchanged;   // 无变化而省略的采样数
+    unsigned int samples;     // 总采样数
+    unsigned int jitter_max;  // 采样间隔相对标称周期的最大偏差（us）
+    unsigned int jitter_sum;  // 偏差累加（us），用于求平均
+    unsigned int start_tick;  // 统计开始时刻
+    unsigned int field_bytes[TELEMETRY_FIELD_NUM]; // 每个字段占用的负载字节数
+} TELEMETRY_STAT;
+
+static volatile unsigned int telemetry_hz = TELEMETRY_DEFAULT_HZ;
+static TELEMETRY_STAT telemetry_stat;
+// 快照中每个字节所属的字段
+static unsigned char telemetry_byte_field[TELEMETRY_SNAPSHOT_LEN];
+// 帧组装缓冲区（写入时拷入发送环）
+static unsigned char telemetry_tx_buf[TELEMETRY_FRAME_MAX];
+
+static unsigned char *put_u8(unsigned char *p, unsigned char v)
+{
+    *p++ = v;
+    return p;
+}
+
+static unsigned char *put_u16(unsigned char *p, unsigned short v)
+{
+    *p++ = (unsigned char)v;
+    *p++ = (unsigned char)(v >> 8);
+    return p;
+}
+
+static unsigned char *put_u32(unsigned char *p, unsigned int v)
+{
+    *p++ = (unsigned char)v;
+    *p++ = (unsigned char)(v >> 8);
+    *p++ = (unsigned char)(v >> 16);
+    *p++ = (unsigned char)(v >> 24);
+    return p;
+}
+
+/**
+ * @brief   按telemetry_fields顺序采样系统数据
+ * @note    各分区先用sys_snapshot取一致副本，不会采到所有者写了一半的数据
+ */
+static void telemetry_sample(unsigned char *snap)
+{
+    static SYS_USE_DATA view;
+    SYS_USE_DATA *SYS = &view;
+    unsigned char *p  = snap;
+
+    sys_snapshot(SYS_PART_ROBOT, &view.Robot_use_data);
+    sys_snapshot(SYS_PART_TIME, &view.Time_use_data);
+    sys_snapshot(SYS_PART_LED, &view.led_control_num);
+    sys_snapshot(SYS_PART_BEEP, &view.Beep_control);
+    sys_snapshot(SYS_PART_REMOTE, &view.Remote_use_data);
+    p = put_u8(p, SYS->Robot_use_data.Motor_Mod);
+    p = put_u8(p, SYS->Robot_use_data.Motor1.Motor_rotation_direction);
+    p = put_u8(p, SYS->Robot_use_data.Motor1.Motor_rotation_degrees);
+    p = put_u32(p, SYS->Robot_use_data.Motor1.PWM_execution_count);
+    p = put_u8(p, SYS->Robot_use_data.Motor2.Motor_rotation_direction);
+    p = put_u8(p, SYS->Robot_use_data.Motor2.Motor_rotation_degrees);
+    p = put_u32(p, SYS->Robot_use_data.Motor2.PWM_execution_count);
+    p = put_u8(p, SYS->Robot_use_data.Motor3.Motor_rotation_direction);
+    p = put_u8(p, SYS->Robot_use_data.Motor3.Motor_rotation_degrees);
+    p = put_u32(p, SYS->Robot_use_data.Motor3.PWM_execution_count);
+    p = put_u8(p, SYS->Robot_use_data.Car_Motor.Movement_direction);
+    p = put_u32(p, SYS->Robot_use_data.Car_Motor.PWM_execution_count);
+    p = put_u8(p, SYS->Time_use_data.hours);
+    p = put_u8(p, SYS->Time_use_data.minute);
+    p = put_u8(p, SYS->Time_use_data.second);
+    p = put_u8(p, SYS->led_control_num.Led_num);
+    p = put_u8(p, SYS->Beep_control.Beep_control_num);
+    p = put_u16(p, (unsigned short)SYS->Beep_control.Beep_delay_num);
+    p = put_u8(p, SYS->Remote_use_data.key);
+    p = put_u8(p, SYS->Remote_use_data.g_remote_cnt);
+}
+
+/**
+ * @brief   组帧：关键帧发送完整快照，差分帧只发送变化的字节
+ * @retval  帧长度，0表示与上一帧相比没有变化
+ */
+static unsigned int telemetry_build(unsigned char *frame, const unsigned char *snap, const unsigned char *prev,
+                                    unsigned char key, unsigned char seq, unsigned int tick)
+{
+    unsigned char *p = frame + TELEMETRY_HEADER_LEN;
+    unsigned char *bitmap;
+    unsigned char sum = 0;
+    unsigned int i, len;
+
+    if (key) {
+        memcpy(p, snap, TELEMETRY_SNAPSHOT_LEN);
+        p += TELEMETRY_SNAPSHOT_LEN;
+        for (i = 0; i < TELEMETRY_FIELD_NUM; i++) telemetry_stat.field_bytes[i] += telemetry_fields[i].size;
+    } else {
+        bitmap = p;
+        memset(bitmap, 0, TELEMETRY_BITMAP_LEN);
+        p += TELEMETRY_BITMAP_LEN;
+        for (i = 0; i < TELEMETRY_SNAPSHOT_LEN; i++) {
+            if (snap[i] != prev[i]) {
+                bitmap[i >> 3] |= (unsigned char)(1u << (i & 7));
+                *p++ = snap[i];
+            }
+        }
+        if (p == bitmap + TELEMETRY_BITMAP_LEN) return 0;
+        for (i = 0; i < TELEMETRY_SNAPSHOT_LEN; i++) {
+            if (bitmap[i >> 3] & (1u << (i & 7))) telemetry_stat.field_bytes[telemetry_byte_field[i]]++;
+        }
+    }
+
+    len = (unsigned int)(p - frame);
+    frame[0] = TELEMETRY_SYNC0;
+    frame[1] = TELEMETRY_SYNC1;
+    frame[2] = key ? TELEMETRY_FRAME_KEY : TELEMETRY_FRAME_DELTA;
+    frame[3] = seq;
+    put_u32(&frame[4], tick);
+    frame[8] = (unsigned char)(len - TELEMETRY_HEADER_LEN);
+    for (i = 2; i < len; i++) sum += frame[i];
+    frame[len] = sum;
+    return len + 1;
+}
+
+/**
+ * @brief   设置遥测采样频率
+ * @param   hz: 0关闭，其余限制在TELEMETRY_MIN_HZ~TELEMETRY_MAX_HZ
+ * @note    同时清零统计数据，并唤醒遥测任务
+ */
+void telemetry_set_rate(unsigned int hz)
+{
+    if (hz > TELEMETRY_MAX_HZ) hz = TELEMETRY_MAX_HZ;
+    telemetry_hz = hz;
+    osThreadFlagsSet(TelemetryTaskHandle, 0x01);
+}
+
+/**
+ * @brief   通过串口打印遥测统计（带宽按字段拆分，采样抖动）
+ * @warning 禁止在中断中调用
+ */
+void telemetry_report(void)
+{
+    unsigned int i, elapsed, samples;
+
+    elapsed = osKernelGetTickCount() - telemetry_stat.start_tick;
+    if (elapsed == 0) elapsed = 1;
+    samples = telemetry_stat.samples ? telemetry_stat.samples : 1;
+
+    myprintf("TELEM %uHz frames=%u key=%u bytes=%u B/s=%u\r\n", telemetry_hz, telemetry_stat.frames,
+             telemetry_stat.keyframes, telemetry_stat.bytes, (unsigned int)((unsigned long long)telemetry_stat.bytes * 1000 / elapsed));
+    myprintf("TELEM samples=%u busy=%u same=%u jit_max=%uus jit_avg=%uus\r\n", telemetry_stat.samples,
+             telemetry_stat.busy_drops, telemetry_stat.unchanged, telemetry_stat.jitter_max,
+             telemetry_stat.jitter_sum / samples);
+    for (i = 0; i < TELEMETRY_FIELD_NUM; i++) {
+        myprintf("  %s %u B/s\r\n", telemetry_fields[i].name,
+                 (unsigned int)((unsigned long long)telemetry_stat.field_bytes[i] * 1000 / elapsed));
+    }
+}
+
+/**
+ * @brief   遥测任务
+ * @param   argument: 系统数据聚合指针
+ * @retval  None
+ * @note    按绝对时刻（next_tick）计算等待时间，采样周期不受自身执行时间影响；
+ *          第n次采样安排在base_tick + n*configTICK_RATE_HZ/hz（向下取整），hz不能整除1000时各周期在
+ *          相邻两个整数节拍间交替，平均频率准确；每满hz次（正好1秒）把base_tick前移一秒，n不会溢出。
+ *          采样抖动相对本次安排的节拍间隔测量（同一基准换算成DWT周期），而不是相对1/hz，
+ *          避免把节拍取整误差计成抖动。
+ *          等待期间可被telemetry_set_rate的线程标志提前唤醒；抖动用经过睡眠补偿的DWT周期计数（cpu_stats_cycles）测量
+ */
+void StartTelemetryTaskFunction(void *argument)
+{
+    (void)argument;
+    static unsigned char snap[TELEMETRY_SNAPSHOT_LEN];
+    static unsigned char prev[TELEMETRY_SNAPSHOT_LEN];
+    unsigned int i, j, k, hz, n, base_tick, next_tick, prev_tick, last_key_tick = 0, len;
+    unsigned int now_cyc, last_cyc = 0, period_cyc, dev, wait;
+    unsigned char seq = 0, have_prev = 0, key;
+
+    // 建立快照字节到字段的映射
+    for (i = 0, k = 0; i < TELEMETRY_FIELD_NUM; i++) {
+        for (j = 0; j < telemetry_fields[i].size; j++) telemetry_byte_field[k++] = (unsigned char)i;
+    }
+    configASSERT(k == TELEMETRY_SNAPSHOT_LEN);
+    for (;;) {
+        hz = telemetry_hz;
+        if (hz == 0) {
+            // 关闭状态下一直阻塞，直到telemetry_set_rate唤醒
+            osThreadFlagsWait(0x01, osFlagsWaitAny, osWaitForever);
+            continue;
+        }
+        // 频率改变：重新开始统计并从关键帧开始
+        memset(&telemetry_stat, 0, sizeof(telemetry_stat));
+        telemetry_stat.start_tick = osKernelGetTickCount();
+        have_prev = 0;
+        n         = 0;
+        base_tick = osKernelGetTickCount();
+        next_tick = base_tick;
+        last_cyc  = cpu_stats_cycles();
+
+        while (telemetry_hz == hz) {
+            prev_tick = next_tick;
+            if (++n == hz) {
+                base_tick += configTICK_RATE_HZ;
+                n = 0;
+            }
+            next_tick  = base_tick + n * configTICK_RATE_HZ / hz;
+            period_cyc = (next_tick - prev_tick) * (SystemCoreClock / configTICK_RATE_HZ);
+            // 等待下一个采样时刻，期间若频率被修改则提前醒来（已经落后则不等待）
+            wait = next_tick - osKernelGetTickCount();
+            if ((int)wait < 0) wait = 0;
+            if (osThreadFlagsWait(0x01, osFlagsWaitAny, wait) == 0x01) break;
+
+            now_cyc = cpu_stats_cycles();
+            if (telemetry_stat.samples) {
+                dev = now_cyc - last_cyc;
+                dev = (dev > period_cyc) ? dev - period_cyc : period_cyc - dev;
+                dev /= (SystemCoreClock / 1000000);
+                if (dev > telemetry_stat.jitter_max) telemetry_stat.jitter_max = dev;
+                telemetry_stat.jitter_sum += dev;
+            }
+            last_cyc = now_cyc;
+            telemetry_stat.samples++;
+
+            telemetry_sample(snap);
+            key = (!have_prev) || (next_tick - last_key_tick >= TELEMETRY_KEYFRAME_MS);
+            if (!key && memcmp(snap, prev, TELEMETRY_SNAPSHOT_LEN) == 0) {
+                telemetry_stat.unchanged++;
+                continue;
+            }
+            // 只尝试写入，不等待：发送环满就丢弃本次采样
+            len = telemetry_build(telemetry_tx_buf, snap, prev, key, seq, next_tick);
+            if (uart_drv_write(&TELEMETRY_UART, telemetry_tx_buf, len, 0) < 0) {
+                telemetry_stat.busy_drops++;
+                continue;
+            }
+            memcpy(prev, snap, TELEMETRY_SNAPSHOT_LEN);
+            have_prev = 1;
+            seq++;
+            telemetry_stat.frames++;
+            telemetry_stat.bytes += len;
+            if (key) {
+                telemetry_stat.keyframes++;
+                last_key_tick = next_tick;
+            }
+        }
+    }
+}
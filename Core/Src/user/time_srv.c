@@ -0,0 +1,178 @@
+/**
+ * @file    time_srv.c
+ * @brief   时间服务：单调微秒时间戳、可设定的墙钟与无漂移的1Hz秒节拍
+ * @note    TIM2以1MHz计数、每1ms溢出一次，溢出经TRGO驱动TIM3（外部时钟模式1，ITR1），
+ *          TIM3每1000ms溢出一次进入更新中断，软件只在中断里把秒计数加1，三级合起来是64位微秒时间戳。
+ *          秒节拍直接取自硬件溢出，与中断延迟、定时器服务任务的调度延迟都无关，长时间重负载下也不会累积误差；
+ *          原TimeSetTask在工作之后osDelay(1000)，每秒都多出这部分时间。
+ *          墙钟不单独计数：时分秒 = (上电秒数 + 偏移) % 一天，TIME_SET命令只改偏移。
+ *          秒中断把刷新挂到定时器服务任务执行（xTimerPendFunctionCallFromISR），在那里发布时间分区并触发LCD刷新，
+ *          回调被推迟时按当时的秒数计算，晚到的一次不会让时间少走或多走。
+ *          主机仿真构建（HOST_SIM）同样走TIM2→TIM3的级联，由仿真层按主机时间推进（CNT按仿真节拍更新，分辨率约1ms）。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "mytask.h"
+#include "time_srv.h"
+#include "myprintf.h"
+#include "period_mon.h"
+
+#include "tim.h"
+
+extern osSemaphoreId_t LCD_refresh_gsemHandle;
+
+// 秒刷新回调的截止期限（ms）：显示的秒数晚于此值肉眼可见
+#define TIME_SRV_DEADLINE_MS 100
+
+// 秒刷新的周期监视（PERIODS命令）：以CPU周期计数为基准衡量刷新回调的到达时刻
+static PERIOD_MON time_srv_mon;
+
+// 时间分区的所有者是定时器服务任务
+static SYS_USE_DATA *time_sys;
+// 上电以来的秒数（TIM3更新中断中递增，单字读写）
+static volatile unsigned int time_sec;
+// 墙钟偏移（s），时分秒 = (time_sec + time_wall_offset) % TIME_SRV_DAY_S
+static volatile unsigned int time_wall_offset;
+// 调度器节拍（ms）与time_us的初始差值，TIME命令据此给出节拍的累计误差
+static unsigned int time_tick_base;
+// 定时器命令队列满，没能挂出的秒刷新次数
+static volatile unsigned int time_pend_lost;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   读取单调时间戳
+ * @retval  time_init以来的微秒数（64位，不回绕）
+ * @note    任务与中断中都可调用，不关中断：两次读TIM3计数之间TIM2溢出、或读取期间秒计数变化都重读。
+ *          关中断期间跨过秒边界时秒中断还没执行，由挂起的UIF补上这1s；
+ *          在优先级高于TIM3的中断里，恰好在HAL清除UIF与秒计数加1之间读取会少1s
+ */
+unsigned long long time_us(void)
+{
+    unsigned int sec, ms, us, wrap;
+
+    do {
+        sec  = time_sec;
+        ms   = TIM3->CNT;
+        us   = TIM2->CNT;
+        wrap = (TIM3->SR & TIM_SR_UIF) && ms < 500;
+    } while (ms != TIM3->CNT || sec != time_sec);
+
+    return ((unsigned long long)(sec + wrap) * 1000U + ms) * 1000U + us;
+}
+
+/**
+ * @brief   按当前秒数发布时间分区
+ */
+static void time_publish(void)
+{
+    TIME_USE_DATA *t  = &time_sys->Time_use_data;
+    unsigned int wall = (time_sec + time_wall_offset) % TIME_SRV_DAY_S;
+
+    t->hours  = wall / 3600U;
+    t->minute = wall / 60U % 60U;
+    t->second = wall % 60U;
+    // 时分秒一起发布，读者不会看到进位到一半的时间
+    sys_publish(SYS_PART_TIME, t);
+}
+
+/**
+ * @brief   时间刷新（在定时器服务任务中执行）
+ * @param   param: 未使用
+ * @param   tick: 1为秒节拍，0为TIME_SET后的立即刷新
+ * @retval  None
+ */
+static void time_refresh(void *param, uint32_t tick)
+{
+    (void)param;
+
+    if (tick) period_mon_begin(&time_srv_mon);
+    time_publish();
+
+    /* 触发LCD刷新 */
+    osSemaphoreRelease(LCD_refresh_gsemHandle);
+    if (tick) period_mon_end(&time_srv_mon);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   硬件秒节拍（TIM3更新中断，由HAL_TIM_PeriodElapsedCallback调用）
+ * @retval  None
+ */
+void time_srv_second_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    time_sec++;
+    if (xTimerPendFunctionCallFromISR(time_refresh, NULL, 1, &woken) != pdPASS) time_pend_lost++;
+    portYIELD_FROM_ISR(woken);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   时间服务初始化：发布初始时间并启动TIM2/TIM3
+ * @param   SYS: 系统数据（只写时间分区）
+ * @retval  None
+ * @note    在MX_FREERTOS_Init中调用（定时器命令队列已由cpu_stats_init创建）；初始时间见my_sys_data.h（Set_Time_xxx）
+ */
+void time_init(SYS_USE_DATA *SYS)
+{
+    time_sys         = SYS;
+    time_wall_offset = Set_Time_hours * 3600U + Set_Time_minute * 60U + Set_Time_second;
+    time_publish();
+    period_mon_init(&time_srv_mon, "clock", 1000000U, TIME_SRV_DEADLINE_MS * 1000U);
+
+    // 初始化时的UG事件置位了UIF，先清掉；先启动TIM3再启动TIM2，第一个1ms溢出不会丢
+    __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+    HAL_TIM_Base_Start_IT(&htim3);
+    HAL_TIM_Base_Start(&htim2);
+    time_tick_base = (unsigned int)time_us() - osKernelGetTickCount() * 1000U;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   上电以来的秒数
+ */
+unsigned int time_uptime_s(void)
+{
+    return time_sec;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   设定墙钟（TIME_SET命令）
+ * @param   hours/minute/second: 新的时分秒
+ * @retval  0成功，-1参数超出范围
+ * @note    只修改偏移，秒节拍与单调时间戳不受影响；设定后立即刷新一次时间分区与LCD
+ */
+int time_set(unsigned int hours, unsigned int minute, unsigned int second)
+{
+    unsigned int wall;
+
+    if (hours >= 24 || minute >= 60 || second >= 60) return -1;
+    wall             = hours * 3600U + minute * 60U + second;
+    time_wall_offset = (wall + TIME_SRV_DAY_S - time_sec % TIME_SRV_DAY_S) % TIME_SRV_DAY_S;
+    xTimerPendFunctionCall(time_refresh, NULL, 0, 0);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印墙钟、单调时间与节拍误差（TIME命令）
+ * @retval  None
+ * @note    tick_err = 调度器节拍计数 - 单调时间戳，反映无节拍空闲的节拍补偿误差（正值表示节拍走快）；
+ *          lost为没能挂到定时器服务任务的秒刷新次数，丢失只会让LCD少刷新一次，时间本身不受影响
+ */
+void time_report(void)
+{
+    unsigned long long now = time_us();
+    unsigned int sec       = (unsigned int)(now / 1000000U);
+    unsigned int wall      = (sec + time_wall_offset) % TIME_SRV_DAY_S;
+    int tick_err           = (int)(osKernelGetTickCount() * 1000U + time_tick_base - (unsigned int)now);
+
+    myprintf("TIME %02u:%02u:%02u up=%u.%06us tick_err=%dus lost=%u\r\n", wall / 3600U, wall / 60U % 60U,
+             wall % 60U, sec, (unsigned int)(now % 1000000U), tick_err, time_pend_lost);
+}
@@ -0,0 +1,196 @@
+/**
+ * @file    trace.c
+ * @brief   调度器与中断事件跟踪（RAM环形缓冲）
+ * @note    FreeRTOS跟踪宏（任务切入/切出、队列与信号量的收发/阻塞/失败，见FreeRTOSConfig.h）和
+ *          中断入口/出口钩子（TRACE_ISR_ENTER/EXIT，见stm32f1xx_it.c与remote.c）调用trace_event，
+ *          每个事件写一条8字节记录：时间戳（睡眠补偿后的CPU周期）、事件类型、任务/对象/IRQ编号、参数。
+ *          写入只做一次LDREX/STREX取槽位加四次存储，不关中断，任务、PendSV与各级中断可以任意嵌套写入；
+ *          缓冲写满后覆盖最旧的记录，始终保留最近TRACE_BUF_RECORDS个事件。
+ *          上电即开始记录，出现延迟尖峰后发TRACE_DUMP：先停止记录再把任务名、对象名与全部记录以十六进制输出，
+ *          Tools/trace_to_perfetto.py把输出转换为Chrome/Perfetto可打开的trace JSON；TRACE_ON清空后重新开始。
+ *          队列与信号量在创建时（traceQUEUE_CREATE）登记编号，名称取自队列注册表（CMSIS按osXxxAttr_t.name注册）。
+ *          主机仿真构建（HOST_SIM）时间戳为CLOCK_MONOTONIC微秒。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include "trace.h"
+#include "cpu_stats.h"
+#include "myprintf.h"
+
+#ifdef HOST_SIM
+#include <time.h>
+#define TRACE_HZ 1000000U
+#else
+#define TRACE_HZ SystemCoreClock
+#endif
+
+/**
+ * @brief  一条跟踪记录（8字节）
+ */
+typedef struct {
+    unsigned int ts;    //!< 时间戳（CPU周期，32位回绕，转换脚本按记录顺序展开）
+    unsigned char ev;   //!< 事件类型（TRACE_EV_*）
+    unsigned char id;   //!< 任务编号/对象编号/IRQ编号
+    unsigned short arg; //!< 事件参数
+} TRACE_RECORD;
+
+static TRACE_RECORD trace_buf[TRACE_BUF_RECORDS];
+// 累计写入的记录数，低位取模即写入位置
+static volatile unsigned int trace_head;
+static volatile unsigned char trace_on = TRACE_ENABLE;
+// 登记的内核对象（下标+1为编号）
+static void *trace_obj[TRACE_MAX_OBJS];
+static unsigned char trace_obj_type[TRACE_MAX_OBJS];
+static unsigned int trace_obj_num;
+// TRACE_DUMP取任务名用（仅指令处理任务访问）
+static TaskStatus_t trace_tasks[CPU_STATS_MAX_TASKS];
+
+/**
+ * @brief   时间戳
+ */
+static unsigned int trace_now(void)
+{
+#ifdef HOST_SIM
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int)((unsigned long long)ts.tv_sec * 1000000U + (unsigned long long)ts.tv_nsec / 1000U);
+#else
+    return cpu_stats_cycles();
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   记录一个事件
+ * @param   ev: 事件类型（TRACE_EV_*）
+ * @param   id: 任务编号/对象编号/IRQ编号（取低8位）
+ * @param   arg: 事件参数（取低16位）
+ * @retval  None
+ * @note    内核跟踪宏在临界区、PendSV与中断中展开，这里不能调用任何内核API；
+ *          时间戳先于取槽位读取，被更高优先级中断打断时相邻记录的时间戳可能略微逆序，转换脚本按有符号差值展开
+ */
+void trace_event(unsigned int ev, unsigned int id, unsigned int arg)
+{
+    TRACE_RECORD *r;
+    unsigned int ts, i;
+
+    if (!trace_on) return;
+    ts = trace_now();
+#ifdef HOST_SIM
+    i = __atomic_fetch_add(&trace_head, 1U, __ATOMIC_RELAXED);
+#else
+    do {
+        i = __LDREXW(&trace_head);
+    } while (__STREXW(i + 1, &trace_head));
+#endif
+    r      = &trace_buf[i & (TRACE_BUF_RECORDS - 1)];
+    r->ts  = ts;
+    r->ev  = (unsigned char)ev;
+    r->id  = (unsigned char)id;
+    r->arg = (unsigned short)arg;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   登记新建的队列/信号量/互斥量（traceQUEUE_CREATE）
+ * @param   queue: 队列句柄
+ * @param   type: 队列类型（queueQUEUE_TYPE_*）
+ * @retval  对象编号（写入uxQueueNumber），超过TRACE_MAX_OBJS时为0
+ * @note    只在创建时调用（任务上下文，调度器启动前后都可能），登记表只增不减
+ */
+unsigned int trace_queue_created(void *queue, unsigned int type)
+{
+    unsigned int n;
+
+    taskENTER_CRITICAL();
+    n = trace_obj_num;
+    if (n < TRACE_MAX_OBJS) {
+        trace_obj[n]      = queue;
+        trace_obj_type[n] = (unsigned char)type;
+        trace_obj_num     = ++n;
+    } else {
+        n = 0;
+    }
+    taskEXIT_CRITICAL();
+    return n;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   清空缓冲并开始记录（TRACE_ON命令）
+ */
+void trace_start(void)
+{
+    trace_on   = 0;
+    trace_head = 0;
+    trace_on   = TRACE_ENABLE;
+}
+
+/**
+ * @brief   停止记录（TRACE_OFF命令），缓冲内容保留到下一次trace_start
+ */
+void trace_stop(void)
+{
+    trace_on = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   打印记录状态（TRACE命令）
+ * @note    lost为已被覆盖的最旧记录数
+ */
+void trace_report(void)
+{
+    unsigned int head = trace_head;
+
+    myprintf("TRACE %s n=%u lost=%u buf=%u objs=%u\r\n", trace_on ? "on" : "off",
+             head < TRACE_BUF_RECORDS ? head : TRACE_BUF_RECORDS,
+             head > TRACE_BUF_RECORDS ? head - TRACE_BUF_RECORDS : 0, TRACE_BUF_RECORDS, trace_obj_num);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   停止记录并输出全部记录（TRACE_DUMP命令，多行应答）
+ * @retval  None
+ * @note    输出格式（Tools/trace_to_perfetto.py解析）：
+ *            TRACE DUMP n=<记录数> lost=<被覆盖数> hz=<时间戳频率>
+ *            TRACE TASK <编号> <任务名>                每个任务一行
+ *            TRACE OBJ <编号> <类型> <名称>            每个登记对象一行，未注册名称为"-"
+ *            TRACE D <ts8><ev2><id2><arg4> ...        每行4条记录，十六进制，从最旧到最新
+ *            TRACE END
+ *          115200波特率下输出全部512条记录约需1s；输出期间不记录，完成后保持停止，TRACE_ON重新开始
+ */
+void trace_dump(void)
+{
+    TRACE_RECORD *r[4];
+    unsigned int head, start, i, j, num;
+    const char *name;
+
+    trace_stop();
+    head  = trace_head;
+    start = head > TRACE_BUF_RECORDS ? head - TRACE_BUF_RECORDS : 0;
+    myprintf("TRACE DUMP n=%u lost=%u hz=%u\r\n", head - start, start, (unsigned int)TRACE_HZ);
+
+    num = uxTaskGetSystemState(trace_tasks, CPU_STATS_MAX_TASKS, NULL);
+    for (i = 0; i < num; i++) {
+        myprintf("TRACE TASK %u %s\r\n", (unsigned int)trace_tasks[i].xTaskNumber, trace_tasks[i].pcTaskName);
+    }
+    for (i = 0; i < trace_obj_num; i++) {
+        name = pcQueueGetName((QueueHandle_t)trace_obj[i]);
+        myprintf("TRACE OBJ %u %u %s\r\n", i + 1, trace_obj_type[i], name ? name : "-");
+    }
+
+    for (i = start; i < head; i += 4) {
+        for (j = 0; j < 4; j++) r[j] = &trace_buf[(i + (i + j < head ? j : 0)) & (TRACE_BUF_RECORDS - 1)];
+        // 不足4条的最后一行用第一条补齐，转换脚本按n截断
+        myprintf("TRACE D %08x%02x%02x%04x %08x%02x%02x%04x %08x%02x%02x%04x %08x%02x%02x%04x\r\n",
+                 r[0]->ts, r[0]->ev, r[0]->id, r[0]->arg, r[1]->ts, r[1]->ev, r[1]->id, r[1]->arg,
+                 r[2]->ts, r[2]->ev, r[2]->id, r[2]->arg, r[3]->ts, r[3]->ev, r[3]->id, r[3]->arg);
+    }
+    myprintf("TRACE END\r\n");
+}
@@ -0,0 +1,420 @@
+/**
+ * @file    uart_drv.c
+ * @brief   多实例串口驱动（DMA环形收发）
+ * @note    每个端口一个UART_DRV对象，持有HAL句柄、收发环形缓冲区、信号量与统计。
+ *          HAL回调按huart查表分发到对应实例；stm32f1xx_it.c中的USARTx_IRQHandler
+ *          只需调用uart_drv_irq(&uartx_drv)处理空闲中断。
+ *          新增端口：在CubeMX中打开USARTx及其收发DMA，在此文件定义缓冲区与实例并加入uart_drv_table，
+ *          在freertos.c中调用uart_drv_init。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "string.h"
+
+#include "usart.h"
+#include "uart_drv.h"
+#include "myprintf.h"
+#include "cpu_stats.h"
+#include "latency.h"
+
+static unsigned char uart1_rx_ring[UART1_DRV_RX_LEN];
+static unsigned char uart1_tx_ring[UART1_DRV_TX_LEN];
+static unsigned char uart2_rx_ring[UART2_DRV_RX_LEN];
+static unsigned char uart2_tx_ring[UART2_DRV_TX_LEN];
+
+UART_DRV uart1_drv = {
+    .huart   = &huart1,
+    .name    = "USART1",
+    .rx_ring = uart1_rx_ring,
+    .rx_len  = UART1_DRV_RX_LEN,
+    .tx_ring = uart1_tx_ring,
+    .tx_len  = UART1_DRV_TX_LEN,
+};
+
+UART_DRV uart2_drv = {
+    .huart   = &huart2,
+    .name    = "USART2",
+    .rx_ring = uart2_rx_ring,
+    .rx_len  = UART2_DRV_RX_LEN,
+    .tx_ring = uart2_tx_ring,
+    .tx_len  = UART2_DRV_TX_LEN,
+};
+
+static UART_DRV *const uart_drv_table[] = {&uart1_drv, &uart2_drv};
+#define UART_DRV_NUM (sizeof(uart_drv_table) / sizeof(uart_drv_table[0]))
+
+/**
+ * @brief   由HAL句柄查找驱动实例，未托管的端口返回NULL
+ */
+static UART_DRV *uart_drv_find(UART_HandleTypeDef *huart)
+{
+    unsigned int i;
+    for (i = 0; i < UART_DRV_NUM; i++) {
+        if (uart_drv_table[i]->huart == huart) return uart_drv_table[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief   DWT周期差转换为微秒
+ */
+static unsigned int uart_drv_cyc_to_us(unsigned int cyc)
+{
+    return cyc / (SystemCoreClock / 1000000);
+}
+
+/**
+ * @brief   记录接收事件时刻并唤醒读取者（中断上下文）
+ * @note    只记录第一个未处理事件的时刻，读取者据此计算中断到处理的延迟
+ */
+static void uart_drv_rx_notify(UART_DRV *drv)
+{
+    if (drv->rx_evt_cyc == 0) drv->rx_evt_cyc = cpu_stats_cycles() | 1;
+    osSemaphoreRelease(drv->rx_sem);
+}
+
+/**
+ * @brief   发送环中有数据且DMA空闲时启动下一段发送
+ * @note    每次只发送一段连续区间（到环尾或写指针为止），剩余部分在发送完成中断中继续
+ * @warning 调用者需处于临界区或串口中断中
+ */
+static void uart_drv_tx_kick(UART_DRV *drv)
+{
+    unsigned short head = drv->tx_head, tail = drv->tx_tail, n;
+
+    if (drv->tx_busy || head == tail) return;
+    n = (head > tail) ? head - tail : drv->tx_len - tail;
+    if (HAL_UART_Transmit_DMA(drv->huart, drv->tx_ring + tail, n) == HAL_OK) drv->tx_busy = n;
+}
+
+/**
+ * @brief   一段DMA发送结束（成功或出错），释放该段空间并继续发送（中断上下文）
+ */
+static void uart_drv_tx_done(UART_DRV *drv)
+{
+    unsigned short n = drv->tx_busy;
+
+    drv->tx_tail = (unsigned short)((drv->tx_tail + n) % drv->tx_len);
+    drv->tx_busy = 0;
+    drv->stat.tx_bytes += n;
+    uart_drv_tx_kick(drv);
+    osSemaphoreRelease(drv->tx_done);
+}
+
+/**
+ * @brief   发送环剩余空间（保留1字节区分空/满）
+ */
+static unsigned int uart_drv_tx_free(UART_DRV *drv)
+{
+    return drv->tx_len - 1 - (unsigned int)((drv->tx_head + drv->tx_len - drv->tx_tail) % drv->tx_len);
+}
+
+/**
+ * @brief   计算读指针从rd移动到now时越过的半区边界数
+ * @note    边界为rx_len/2和rx_len(即0)，与DMA半满/全满中断一一对应
+ */
+static unsigned int uart_drv_crossed(UART_DRV *drv, unsigned short rd, unsigned short now)
+{
+    const unsigned short half = drv->rx_len / 2;
+    if (now >= rd) return (rd < half && now >= half) ? 1 : 0;
+    return (rd < half ? 1 : 0) + 1 + (now >= half ? 1 : 0);
+}
+
+/**
+ * @brief   当前DMA写指针
+ */
+static unsigned short uart_drv_rx_pos(UART_DRV *drv)
+{
+    unsigned short now = drv->rx_len - (unsigned short)__HAL_DMA_GET_COUNTER(drv->huart->hdmarx);
+    return (now >= drv->rx_len) ? 0 : now;
+}
+
+/**
+ * @brief   把数据拷入发送环并启动发送
+ * @param   timeout: 发送环空间不足时每次等待的最长时间，0表示不等待直接丢弃
+ * @retval  写入字节数，失败返回-1
+ * @warning 调用者需持有tx_lock
+ */
+static int uart_drv_put(UART_DRV *drv, const void *data, unsigned int len, unsigned int timeout)
+{
+    const unsigned char *src = (const unsigned char *)data;
+    unsigned int start = cpu_stats_cycles(), first, waited = 0, us;
+    unsigned short head;
+
+    while (uart_drv_tx_free(drv) < len) {
+        if (timeout == 0 || osSemaphoreAcquire(drv->tx_done, timeout) != osOK) {
+            drv->stat.tx_drop++;
+            return -1;
+        }
+        waited = 1;
+    }
+    head  = drv->tx_head;
+    first = drv->tx_len - head;
+    if (first > len) first = len;
+    memcpy(drv->tx_ring + head, src, first);
+    memcpy(drv->tx_ring, src + first, len - first);
+
+    taskENTER_CRITICAL();
+    drv->tx_head = (unsigned short)((head + len) % drv->tx_len);
+    uart_drv_tx_kick(drv);
+    taskEXIT_CRITICAL();
+
+    if (waited) {
+        us = uart_drv_cyc_to_us(cpu_stats_cycles() - start);
+        if (us > drv->stat.tx_wait_max) drv->stat.tx_wait_max = us;
+    }
+    return (int)len;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   初始化串口驱动实例并启动DMA接收
+ * @param   drv: 驱动实例
+ * @retval  None
+ * @note    需在MX_USARTx_UART_Init之后、使用该端口的任务运行之前调用（freertos.c）
+ *          信号量与写锁建立在驱动实例内的静态控制块上，不从FreeRTOS堆分配
+ *          写锁的持有预算取发送环按波特率排空的时间（每字节10位）：
+ *          持有者最多等待整个发送环发完，DMA发送不受任务优先级影响，因此持有时间有上界
+ *          同时打开DWT周期计数器用于延迟统计
+ */
+void uart_drv_init(UART_DRV *drv)
+{
+    const osSemaphoreAttr_t rx_sem_attr  = {.name = "rx_sem", .cb_mem = &drv->rx_sem_cb, .cb_size = sizeof(drv->rx_sem_cb)};
+    const osSemaphoreAttr_t tx_done_attr = {.name = "tx_done", .cb_mem = &drv->tx_done_cb, .cb_size = sizeof(drv->tx_done_cb)};
+
+    drv->rx_sem  = osSemaphoreNew(1, 0, &rx_sem_attr);
+    drv->tx_done = osSemaphoreNew(1, 0, &tx_done_attr);
+    configASSERT(drv->rx_sem && drv->tx_done);
+    res_lock_init(&drv->tx_lock, drv->name, drv->tx_len * 10U * 1000U / (drv->huart->Init.BaudRate / 1000U));
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // 打开串口空闲中断并使能DMA循环接收
+    __HAL_UART_ENABLE_IT(drv->huart, UART_IT_IDLE);
+    HAL_UART_Receive_DMA(drv->huart, drv->rx_ring, drv->rx_len);
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   串口中断入口（空闲中断检测）
+ * @param   drv: 驱动实例
+ * @retval  None
+ * @note    放在stm32f1xx_it.c的USARTx_IRQHandler中、HAL_UART_IRQHandler之前调用
+ * @warning 此函数在中断上下文中执行（保持简短）
+ */
+void uart_drv_irq(UART_DRV *drv)
+{
+    if (__HAL_UART_GET_FLAG(drv->huart, UART_FLAG_IDLE) != RESET) {
+        // 产生空闲中断就清除中断
+        __HAL_UART_CLEAR_IDLEFLAG(drv->huart);
+        // 标记本次唤醒来自空闲中断（一次突发传输已结束）
+        drv->rx_idle = 1;
+#if LAT_ENABLE
+        // 命令路径起点：一次突发传输（一条或多条命令）接收完毕
+        if (drv == &uart1_drv) LAT_START(LAT_PATH_CMD, LAT_CMD_FRAMED);
+#endif
+        uart_drv_rx_notify(drv);
+    }
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   DMA循环接收半满/全满回调
+ * @note    连续高速发送时线路不会空闲，依靠半满/全满中断及时唤醒读取者；
+ *          每次回调代表DMA写指针越过了一个半区边界，用于检测接收环被覆盖
+ * @warning 此函数在中断上下文中执行（保持简短）
+ */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    UART_DRV *drv = uart_drv_find(huart);
+    if (drv) {
+        drv->rx_half_evt++;
+        uart_drv_rx_notify(drv);
+    }
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    UART_DRV *drv = uart_drv_find(huart);
+    if (drv) {
+        drv->rx_half_evt++;
+        uart_drv_rx_notify(drv);
+    }
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   串口发送完成回调：释放已发送的区间并继续发送剩余数据
+ * @warning 此函数在中断上下文中执行（保持简短）
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    UART_DRV *drv = uart_drv_find(huart);
+    if (drv) uart_drv_tx_done(drv);
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   串口错误回调
+ * @note    HAL在DMA接收模式下遇到ORE/FE/NE/PE会直接终止DMA接收，这里计数后立即重新启动，
+ *          并通知读取者复位读指针；发送DMA出错时丢弃当前段，继续发送后续数据
+ * @warning 此函数在中断上下文中执行（保持简短）
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    UART_DRV *drv = uart_drv_find(huart);
+    if (drv == NULL) return;
+    drv->stat.rx_error++;
+    if (huart->RxState == HAL_UART_STATE_READY) {
+        drv->rx_restart = 1;
+        HAL_UART_Receive_DMA(huart, drv->rx_ring, drv->rx_len);
+        uart_drv_rx_notify(drv);
+    }
+    if (drv->tx_busy && huart->gState == HAL_UART_STATE_READY) uart_drv_tx_done(drv);
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   向端口写入一段数据（整段写入，不会与其他写入者交错）
+ * @param   drv: 驱动实例
+ * @param   data: 数据
+ * @param   len: 长度，不能超过发送环大小-1
+ * @param   timeout: 等待写锁及发送环空间的最长时间，0表示不等待（忙则丢弃）
+ * @retval  写入字节数，失败返回-1（计入tx_drop）
+ * @note    数据拷入发送环后立即返回，不等待发送完成
+ * @warning 禁止在中断中调用
+ */
+int uart_drv_write(UART_DRV *drv, const void *data, unsigned int len, unsigned int timeout)
+{
+    int ret;
+
+    if (len == 0) return 0;
+    if (len >= drv->tx_len || res_lock_take(&drv->tx_lock, timeout) != 0) {
+        drv->stat.tx_drop++;
+        return -1;
+    }
+    ret = uart_drv_put(drv, data, len, timeout);
+    res_lock_give(&drv->tx_lock);
+    return ret;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   格式化输出到端口
+ * @param   drv: 驱动实例
+ * @param   format: 格式化字符串（见myformat.h），单次输出最长UART_DRV_FMT_LEN-1字节，超长截断
+ * @retval  写入字节数
+ * @note    发送环空间不足时阻塞等待，保证命令应答不丢失
+ * @warning 禁止在中断中调用
+ */
+int uart_drv_vprintf(UART_DRV *drv, const char *format, va_list ap)
+{
+    int len;
+
+    res_lock_take(&drv->tx_lock, osWaitForever);
+    len = my_vsnprintf(drv->fmt_buf, sizeof(drv->fmt_buf), format, ap);
+    if (len > 0) len = uart_drv_put(drv, drv->fmt_buf, (unsigned int)len, osWaitForever);
+    res_lock_give(&drv->tx_lock);
+    return len;
+}
+
+int uart_drv_printf(UART_DRV *drv, const char *format, ...)
+{
+    va_list ap;
+    int len;
+
+    va_start(ap, format);
+    len = uart_drv_vprintf(drv, format, ap);
+    va_end(ap);
+    return len;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   等待接收事件
+ * @param   drv: 驱动实例
+ * @param   timeout: 最长等待时间
+ * @retval  事件标志（UART_DRV_EVT_*），超时返回0
+ * @note    返回后可用uart_drv_read读出本次到达的数据；
+ *          半满/全满事件比读指针实际越过的边界多，说明DMA已经套圈覆盖了未读数据（UART_DRV_EVT_OVERRUN）
+ * @warning 每个端口只能有一个读取者
+ */
+unsigned int uart_drv_rx_wait(UART_DRV *drv, unsigned int timeout)
+{
+    unsigned int evt = 0, half_evt, crossed, cyc, us;
+    unsigned short now;
+
+    if (osSemaphoreAcquire(drv->rx_sem, timeout) != osOK) return 0;
+
+    cyc = drv->rx_evt_cyc;
+    drv->rx_evt_cyc = 0;
+    if (cyc) {
+        us = uart_drv_cyc_to_us(cpu_stats_cycles() - cyc);
+        if (us > drv->stat.rx_lat_max) drv->stat.rx_lat_max = us;
+        drv->stat.rx_lat_sum += us;
+        drv->stat.rx_lat_cnt++;
+    }
+    // 先取走空闲标志和半区事件再读DMA指针，保证它们描述的数据都在本次读取范围内
+    if (drv->rx_idle) {
+        drv->rx_idle = 0;
+        evt |= UART_DRV_EVT_IDLE;
+    }
+    half_evt = drv->rx_half_evt;
+    if (drv->rx_restart) {
+        // 出错后DMA从缓冲区开头重新接收
+        drv->rx_restart   = 0;
+        drv->rx_rd        = 0;
+        drv->rx_half_seen = half_evt;
+        evt |= UART_DRV_EVT_RESTART;
+    }
+    now     = uart_drv_rx_pos(drv);
+    crossed = uart_drv_crossed(drv, drv->rx_rd, now);
+    if ((int)(half_evt - drv->rx_half_seen - crossed) > 0) {
+        drv->stat.rx_overrun++;
+        drv->rx_half_seen = half_evt;
+        evt |= UART_DRV_EVT_OVERRUN;
+    } else {
+        drv->rx_half_seen += crossed;
+    }
+    drv->rx_wr = now;
+    if (now != drv->rx_rd) evt |= UART_DRV_EVT_DATA;
+    return evt;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   读出上一次uart_drv_rx_wait时已到达的数据
+ * @param   drv: 驱动实例
+ * @param   buf: 输出缓冲
+ * @param   max: 最多读出的字节数
+ * @retval  读出的字节数，0表示已读完
+ */
+unsigned int uart_drv_read(UART_DRV *drv, char *buf, unsigned int max)
+{
+    unsigned int n = 0;
+    unsigned short rd = drv->rx_rd;
+
+    while (rd != drv->rx_wr && n < max) {
+        buf[n++] = (char)drv->rx_ring[rd++];
+        if (rd >= drv->rx_len) rd = 0;
+    }
+    drv->rx_rd = rd;
+    drv->stat.rx_bytes += n;
+    return n;
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   接收环当前剩余空间（字节）
+ */
+unsigned int uart_drv_rx_free(UART_DRV *drv)
+{
+    return drv->rx_len - (unsigned int)((uart_drv_rx_pos(drv) + drv->rx_len - drv->rx_rd) % drv->rx_len);
+}
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   通过命令口打印端口统计（单行）
+ * @note    rx/tx: 收发字节数  ovr: 接收环覆盖  err: 硬件错误  drop: 发送丢弃
+ *          lat: 中断到读取者取走数据的延迟（最大/平均）  wait: 写入者等待发送环空间的最长时间
+ * @warning 禁止在中断中调用
+ */
+void uart_drv_report(UART_DRV *drv)
+{
+    UART_DRV_STAT *st = &drv->stat;
+    myprintf("%s rx=%u tx=%u ovr=%u err=%u drop=%u lat=%u/%uus wait=%uus\r\n", drv->name, st->rx_bytes, st->tx_bytes,
+             st->rx_overrun, st->rx_error, st->tx_drop, st->rx_lat_max, st->rx_lat_cnt ? st->rx_lat_sum / st->rx_lat_cnt : 0,
+             st->tx_wait_max);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file    cmsis_compiler.h
+ * @brief   主机仿真构建的CMSIS编译器抽象层（替代Drivers/CMSIS/Include/cmsis_compiler.h）
+ * @note    与原文件使用同一个包含保护，stm32f1xx.h包装头先包含本文件，core_cm3.h随后包含的原文件即被跳过。
+ *          内核寄存器访问指令在主机上没有对应物：中断开关只维护PRIMASK的仿真值，
+ *          IPSR返回仿真中断的异常号（HostSim/Src/sim_core.c），CMSIS-RTOS2据此选择FromISR接口；
+ *          屏障与独占访问映射为GCC原子内建函数。
+ */
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+
+#include <stdint.h>
+
+#define __ASM                  __asm
+#define __INLINE               inline
+#define __STATIC_INLINE        static inline
+#define __STATIC_FORCEINLINE   __attribute__((always_inline)) static inline
+#define __NO_RETURN            __attribute__((__noreturn__))
+#define __USED                 __attribute__((used))
+#define __WEAK                 __attribute__((weak))
+#define __PACKED               __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT        struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION         union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)           __attribute__((aligned(x)))
+#define __RESTRICT             __restrict
+#define __COMPILER_BARRIER()   __ASM volatile("" ::: "memory")
+
+#define __UNALIGNED_UINT16_READ(addr)       (*(const uint16_t *)(const void *)(addr))
+#define __UNALIGNED_UINT16_WRITE(addr, val) (void)(*(uint16_t *)(void *)(addr) = (val))
+#define __UNALIGNED_UINT32_READ(addr)       (*(const uint32_t *)(const void *)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val) (void)(*(uint32_t *)(void *)(addr) = (val))
+#define __UNALIGNED_UINT32(x)               (*(uint32_t *)(x))
+
+// 仿真的中断状态（sim_core.c）
+extern volatile uint32_t sim_ipsr;
+extern volatile uint32_t sim_primask;
+
+__STATIC_FORCEINLINE void __enable_irq(void)
+{
+    sim_primask = 0U;
+}
+
+__STATIC_FORCEINLINE void __disable_irq(void)
+{
+    sim_primask = 1U;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void)
+{
+    return sim_ipsr;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)
+{
+    return sim_primask;
+}
+
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)
+{
+    sim_primask = priMask & 1U;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void)
+{
+    return 0U;
+}
+
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basePri)
+{
+    (void)basePri;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void)
+{
+    return 0U;
+}
+
+#define __NOP()         __ASM volatile("nop")
+#define __WFI()         __COMPILER_BARRIER()
+#define __WFE()         __COMPILER_BARRIER()
+#define __SEV()         __COMPILER_BARRIER()
+#define __BKPT(value)   __builtin_trap()
+
+__STATIC_FORCEINLINE void __ISB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_FORCEINLINE void __DSB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_FORCEINLINE void __DMB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value)
+{
+    return ((value & 0x00FF00FFU) << 8) | ((value >> 8) & 0x00FF00FFU);
+}
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+    uint32_t r = 0U, i;
+
+    for (i = 0U; i < 32U; i++, value >>= 1) r = (r << 1) | (value & 1U);
+    return r;
+}
+
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value)
+{
+    return value ? (uint8_t)__builtin_clz(value) : 32U;
+}
+
+// 独占访问：LDREX记下读到的值，STREX以它为期望值做比较交换，期间被仿真中断改写时返回1让调用方重试
+static __thread uint32_t sim_excl_val __attribute__((unused));
+
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr)
+{
+    sim_excl_val = __atomic_load_n(addr, __ATOMIC_ACQUIRE);
+    return sim_excl_val;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+    uint32_t expected = sim_excl_val;
+
+    return __atomic_compare_exchange_n(addr, &expected, value, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ? 0U : 1U;
+}
+
+__STATIC_FORCEINLINE void __CLREX(void)
+{
+}
+
+#endif /* __CMSIS_COMPILER_H */
@@ -0,0 +1,36 @@
+/**
+ * @file    cmsis_nvic_virtual.h
+ * @brief   主机仿真构建的NVIC函数（core_cm3.h在定义CMSIS_NVIC_VIRTUAL时包含本文件）
+ * @note    NVIC_xxx改由仿真中断控制器实现（HostSim/Src/sim_core.c）：记录使能、挂起与优先级，
+ *          仿真外设只在对应IRQ使能时调用中断服务函数。负数异常号（SVCall、PendSV、SysTick）只记录不生效。
+ */
+#ifndef __CMSIS_NVIC_VIRTUAL_H
+#define __CMSIS_NVIC_VIRTUAL_H
+
+#define NVIC_SetPriorityGrouping sim_nvic_set_priority_grouping
+#define NVIC_GetPriorityGrouping sim_nvic_get_priority_grouping
+#define NVIC_EnableIRQ           sim_nvic_enable_irq
+#define NVIC_GetEnableIRQ        sim_nvic_get_enable_irq
+#define NVIC_DisableIRQ          sim_nvic_disable_irq
+#define NVIC_GetPendingIRQ       sim_nvic_get_pending_irq
+#define NVIC_SetPendingIRQ       sim_nvic_set_pending_irq
+#define NVIC_ClearPendingIRQ     sim_nvic_clear_pending_irq
+#define NVIC_GetActive           sim_nvic_get_active
+#define NVIC_SetPriority         sim_nvic_set_priority
+#define NVIC_GetPriority         sim_nvic_get_priority
+#define NVIC_SystemReset         sim_nvic_system_reset
+
+void sim_nvic_set_priority_grouping(uint32_t PriorityGroup);
+uint32_t sim_nvic_get_priority_grouping(void);
+void sim_nvic_enable_irq(IRQn_Type IRQn);
+uint32_t sim_nvic_get_enable_irq(IRQn_Type IRQn);
+void sim_nvic_disable_irq(IRQn_Type IRQn);
+uint32_t sim_nvic_get_pending_irq(IRQn_Type IRQn);
+void sim_nvic_set_pending_irq(IRQn_Type IRQn);
+void sim_nvic_clear_pending_irq(IRQn_Type IRQn);
+uint32_t sim_nvic_get_active(IRQn_Type IRQn);
+void sim_nvic_set_priority(IRQn_Type IRQn, uint32_t priority);
+uint32_t sim_nvic_get_priority(IRQn_Type IRQn);
+__NO_RETURN void sim_nvic_system_reset(void);
+
+#endif /* __CMSIS_NVIC_VIRTUAL_H */
@@ -0,0 +1,60 @@
+/**
+ * @file    sim.h
+ * @brief   主机仿真层内部接口（HAL替身、仿真外设、中断调度、控制台）
+ * @note    仿真层只在HOST_SIM构建中编译，固件源码不包含本文件；
+ *          固件需要的少数仿真入口（LCD数据口、断言）在各自头文件的HOST_SIM分支中单独声明。
+ */
+#ifndef __SIM_H
+#define __SIM_H
+
+#include "main.h"
+
+// 仿真中断任务的周期（调度器节拍数），所有仿真外设在这个节拍上推进
+#define SIM_POLL_TICKS   1
+// 调度器节拍的时长（ns）
+#define SIM_TICK_NS      (1000000000ULL / configTICK_RATE_HZ)
+// 定时器事件积压上限（ns）：主机卡顿超过这个时长时丢弃更早的事件，不再逐个补发
+#define SIM_BACKLOG_NS   1000000000ULL
+// 串口单次可累积的发送/接收额度上限（ns），避免主机卡顿后瞬间灌入远超波特率的数据
+#define SIM_UART_BURST_NS 20000000ULL
+
+/* sim_core.c */
+unsigned long long sim_now_ns(void);
+void sim_irq_raise(IRQn_Type irqn);
+uint32_t sim_rcc_hclk(void);
+uint32_t sim_rcc_tim_clock(const TIM_TypeDef *tim);
+void sim_assert_failed(const char *file, int line);
+void sim_tick_report(void);
+
+/* sim_gpio.c */
+void sim_gpio_input(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState level);
+void sim_gpio_report(void);
+void sim_gpio_trace(int on);
+
+/* sim_tim.c */
+void sim_tim_poll(unsigned long long now);
+int sim_ir_send(uint8_t key, unsigned int hold_ms);
+void sim_tim_report(void);
+
+/* sim_uart.c */
+void sim_uart_open(UART_HandleTypeDef *huart);
+void sim_uart_poll(unsigned long long now);
+void sim_uart_report(void);
+
+/* sim_lcd.c */
+void sim_lcd_write_reg(uint16_t regno);
+void sim_lcd_write_ram(uint16_t data);
+uint16_t sim_lcd_read_ram(void);
+int sim_lcd_dump(const char *path);
+
+/* sim_prio_inv.c */
+void sim_prio_inv_start(void);
+
+/* sim_seqlock.c */
+void sim_seqlock_start(unsigned int ms);
+
+/* sim_console.c */
+void sim_console_init(void);
+void sim_console_poll(void);
+
+#endif /* __SIM_H */
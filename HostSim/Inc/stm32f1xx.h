@@ -0,0 +1,47 @@
+/**
+ * @file    stm32f1xx.h
+ * @brief   主机仿真构建的器件头包装：包含原器件头后把外设与内核寄存器基址重定位到仿真内存
+ * @note    HostSim/Inc排在包含路径最前面，所有"stm32f1xx.h"都先到这里。
+ *          寄存器结构体、位定义与__HAL_xxx宏保持原样，只是基址指向sim_core.c中的数组，
+ *          应用代码的寄存器读写落在普通内存上，由仿真外设（sim_*.c）读取配置并回写状态。
+ *          需要由"写入"触发动作的寄存器（FSMC上的LCD数据口、SysTick计数值）无法这样仿真，
+ *          见lcd.h的LCD_REG_WRITE/LCD_RAM_WRITE与delay.c的HOST_SIM分支。
+ */
+#ifndef __SIM_STM32F1XX_H
+#define __SIM_STM32F1XX_H
+
+#include "cmsis_compiler.h"
+
+#include_next "stm32f1xx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 仿真寄存器空间（sim_core.c）
+#define SIM_PERIPH_SIZE 0x24000U // APB1/APB2/AHB外设：0x40000000 ~ 0x40023FFF
+#define SIM_SCS_SIZE    0x1000U  // 系统控制空间：0xE000E000 ~ 0xE000EFFF（SysTick/NVIC/SCB/CoreDebug）
+#define SIM_DWT_SIZE    0x100U
+#define SIM_FSMC_SIZE   0x200U
+
+extern uint32_t sim_periph[SIM_PERIPH_SIZE / 4U];
+extern uint32_t sim_scs[SIM_SCS_SIZE / 4U];
+extern uint32_t sim_dwt[SIM_DWT_SIZE / 4U];
+extern uint32_t sim_fsmc[SIM_FSMC_SIZE / 4U];
+
+#undef PERIPH_BASE
+#define PERIPH_BASE ((uintptr_t)sim_periph)
+#undef FSMC_R_BASE
+#define FSMC_R_BASE ((uintptr_t)sim_fsmc)
+#undef SCS_BASE
+#define SCS_BASE ((uintptr_t)sim_scs)
+#undef CoreDebug_BASE
+#define CoreDebug_BASE (SCS_BASE + 0x0DF0UL)
+#undef DWT_BASE
+#define DWT_BASE ((uintptr_t)sim_dwt)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_STM32F1XX_H */
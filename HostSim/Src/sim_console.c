@@ -0,0 +1,92 @@
+/**
+ * @file    sim_console.c
+ * @brief   主机仿真层控制台：从标准输入读取命令，注入外部事件并查看仿真外设状态
+ * @note    标准输入设为非阻塞，由仿真中断任务每个节拍查询一次，命令以换行结束。
+ *          固件的串口数据走伪终端（见sim_uart.c），与控制台互不干扰。
+ */
+#include "main.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+static char sim_console_line[128];
+static unsigned int sim_console_len;
+
+static void sim_console_help(void)
+{
+    fprintf(stderr, "commands:\n"
+                    "  ir <key> [hold_ms]   press a remote key (NEC, decimal or 0x..), hold for repeat codes\n"
+                    "  lcd <file.ppm>       save the LCD frame buffer\n"
+                    "  gpio [trace on|off]  show GPIO ports / log output pin changes\n"
+                    "  tim                  show timers and the scheduler tick\n"
+                    "  uart                 show serial ports\n"
+                    "  pi                   run the priority inversion scenario (semaphore vs res_lock)\n"
+                    "  seqlock [ms]         run the concurrent publish/snapshot scenario (default 2000 ms)\n"
+                    "  quit                 exit the simulation\n");
+}
+
+static void sim_console_exec(char *line)
+{
+    char *cmd = strtok(line, " \t"), *a1 = strtok(NULL, " \t"), *a2 = strtok(NULL, " \t");
+
+    if (cmd == NULL) return;
+    if (strcmp(cmd, "ir") == 0 && a1 != NULL) {
+        if (sim_ir_send((uint8_t)strtoul(a1, NULL, 0), a2 != NULL ? (unsigned int)strtoul(a2, NULL, 0) : 0U) != 0) {
+            fprintf(stderr, "sim: ir queue full\n");
+        }
+    } else if (strcmp(cmd, "lcd") == 0 && a1 != NULL) {
+        if (sim_lcd_dump(a1) != 0) perror(a1);
+    } else if (strcmp(cmd, "gpio") == 0) {
+        if (a1 != NULL && strcmp(a1, "trace") == 0) {
+            sim_gpio_trace(a2 != NULL && strcmp(a2, "on") == 0);
+        } else {
+            sim_gpio_report();
+        }
+    } else if (strcmp(cmd, "tim") == 0) {
+        sim_tim_report();
+        sim_tick_report();
+    } else if (strcmp(cmd, "uart") == 0) {
+        sim_uart_report();
+    } else if (strcmp(cmd, "pi") == 0) {
+        sim_prio_inv_start();
+    } else if (strcmp(cmd, "seqlock") == 0) {
+        sim_seqlock_start(a1 != NULL ? (unsigned int)strtoul(a1, NULL, 0) : 0U);
+    } else if (strcmp(cmd, "quit") == 0 || strcmp(cmd, "exit") == 0) {
+        exit(EXIT_SUCCESS);
+    } else {
+        sim_console_help();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void sim_console_init(void)
+{
+    int flags = fcntl(STDIN_FILENO, F_GETFL);
+
+    if (flags >= 0) fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+    setvbuf(stderr, NULL, _IOLBF, 0);
+    fprintf(stderr, "sim: host simulation started, type 'help' for commands\n");
+}
+
+/**
+ * @brief   读取标准输入并执行完整的命令行（仿真中断任务中调用）
+ */
+void sim_console_poll(void)
+{
+    char c;
+
+    while (read(STDIN_FILENO, &c, 1) == 1) {
+        if (c == '\n' || c == '\r') {
+            sim_console_line[sim_console_len] = '\0';
+            sim_console_len                   = 0;
+            sim_console_exec(sim_console_line);
+        } else if (sim_console_len < sizeof(sim_console_line) - 1U) {
+            sim_console_line[sim_console_len++] = c;
+        }
+    }
+}
@@ -0,0 +1,408 @@
+/**
+ * @file    sim_core.c
+ * @brief   主机仿真层核心：仿真寄存器空间、NVIC与中断调度、HAL核心/RCC/NVIC替身、仿真中断任务
+ * @note    固件在主机上作为一个FreeRTOS POSIX移植的进程运行，每个任务是一个pthread，同一时刻只有一个在执行。
+ *          硬件中断由优先级最高的仿真中断任务"sim"模拟：它每SIM_POLL_TICKS个节拍醒来一次，
+ *          挂起调度器并把IPSR置为对应的异常号后直接调用stm32f1xx_it.c/remote.c中的中断服务函数，
+ *          CMSIS-RTOS2据IPSR走FromISR接口，被唤醒的任务在调度器恢复后运行，效果等同于中断返回后的任务切换。
+ *          外设事件按各自的时间线（CLOCK_MONOTONIC）排序后依次投递，事件的时间戳与主机调度的抖动无关。
+ *          中断不嵌套，也不受NVIC优先级影响；IRQ未使能时事件只置挂起位后丢弃。
+ *          POSIX移植的节拍来自SIGALRM，信号到达时若不是当前任务的线程在运行就丢掉这一拍，负载高时节拍会慢于真实时间；
+ *          仿真中断任务每次醒来按CLOCK_MONOTONIC补上丢掉的节拍（xTaskCatchUpTicks），与硬件SysTick一样不累积误差。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "stm32f1xx_it.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sim.h"
+
+// 仿真寄存器空间（stm32f1xx.h包装头把外设与内核基址指向这里）
+uint32_t sim_periph[SIM_PERIPH_SIZE / 4U] __attribute__((aligned(1024)));
+uint32_t sim_scs[SIM_SCS_SIZE / 4U] __attribute__((aligned(1024)));
+uint32_t sim_dwt[SIM_DWT_SIZE / 4U] __attribute__((aligned(256)));
+uint32_t sim_fsmc[SIM_FSMC_SIZE / 4U] __attribute__((aligned(256)));
+
+// 当前仿真中断的异常号（0为线程模式）与PRIMASK（cmsis_compiler.h）
+volatile uint32_t sim_ipsr;
+volatile uint32_t sim_primask;
+
+// HAL时基（stm32f1xx_hal.c的同名变量），由TIM6更新中断经HAL_IncTick递增
+__IO uint32_t uwTick;
+uint32_t uwTickPrio            = (1UL << __NVIC_PRIO_BITS);
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_DEFAULT;
+
+// 固件使用的中断向量（与startup_stm32f103xe.s中的同名入口对应）
+static void (*const sim_vectors[])(void) = {
+    [DMA1_Channel4_IRQn] = DMA1_Channel4_IRQHandler,
+    [DMA1_Channel5_IRQn] = DMA1_Channel5_IRQHandler,
+    [DMA1_Channel6_IRQn] = DMA1_Channel6_IRQHandler,
+    [DMA1_Channel7_IRQn] = DMA1_Channel7_IRQHandler,
+    [TIM3_IRQn]          = TIM3_IRQHandler,
+    [TIM4_IRQn]          = TIM4_IRQHandler,
+    [USART1_IRQn]        = USART1_IRQHandler,
+    [USART2_IRQn]        = USART2_IRQHandler,
+    [TIM8_CC_IRQn]       = TIM8_CC_IRQHandler,
+    [TIM5_IRQn]          = TIM5_IRQHandler,
+    [TIM6_IRQn]          = TIM6_IRQHandler,
+    [TIM7_IRQn]          = TIM7_IRQHandler,
+};
+#define SIM_VECTOR_NUM (sizeof(sim_vectors) / sizeof(sim_vectors[0]))
+
+static unsigned long long sim_t0;
+// 补上的节拍数（POSIX移植丢掉的SIGALRM）
+static unsigned long sim_ticks_lost;
+
+static StaticTask_t sim_task_tcb;
+// POSIX移植在栈不小于PTHREAD_STACK_MIN时直接用这块内存作为线程栈
+static StackType_t sim_task_stack[65536 / sizeof(StackType_t)];
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   仿真时间（ns，从HAL_Init开始计）
+ */
+unsigned long long sim_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec - sim_t0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   投递一次中断：IRQ使能且PRIMASK为0时以中断上下文调用对应的中断服务函数
+ * @param   irqn: 外设中断号
+ * @retval  None
+ * @note    只能在仿真中断任务中（调度器已挂起）调用；调用前后由仿真外设设置/清除状态寄存器中的事件标志
+ */
+void sim_irq_raise(IRQn_Type irqn)
+{
+    uint32_t prev;
+
+    if (irqn < 0 || (unsigned int)irqn >= SIM_VECTOR_NUM || sim_vectors[irqn] == NULL) return;
+    if (!NVIC_GetEnableIRQ(irqn) || sim_primask) {
+        NVIC_SetPendingIRQ(irqn);
+        return;
+    }
+    NVIC_ClearPendingIRQ(irqn);
+    prev     = sim_ipsr;
+    sim_ipsr = (uint32_t)irqn + NVIC_USER_IRQ_OFFSET;
+    sim_vectors[irqn]();
+    sim_ipsr = prev;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   仿真中断任务：按节拍推进各仿真外设并投递到期的中断
+ */
+static void sim_task(void *argument)
+{
+    TickType_t last = xTaskGetTickCount();
+    // 节拍计数为0的时刻
+    const unsigned long long tick0 = sim_now_ns() - (unsigned long long)last * SIM_TICK_NS;
+    unsigned long long now;
+    TickType_t due;
+    (void)argument;
+
+    for (;;) {
+        vTaskDelayUntil(&last, SIM_POLL_TICKS);
+        now = sim_now_ns();
+        vTaskSuspendAll();
+        sim_tim_poll(now);
+        sim_uart_poll(now);
+        sim_console_poll();
+        (void)xTaskResumeAll();
+        due = (TickType_t)((now - tick0) / SIM_TICK_NS);
+        if ((int32_t)(due - xTaskGetTickCount()) > 0) {
+            sim_ticks_lost += due - xTaskGetTickCount();
+            (void)xTaskCatchUpTicks(due - xTaskGetTickCount());
+        }
+    }
+}
+
+/**
+ * @brief   打印调度器节拍与补上的节拍数（控制台tim命令）
+ */
+void sim_tick_report(void)
+{
+    fprintf(stderr, "tick=%lu sim_ms=%llu caught_up=%lu\n", (unsigned long)xTaskGetTickCount(),
+            sim_now_ns() / 1000000ULL, sim_ticks_lost);
+}
+
+/**
+ * @brief   空闲钩子：所有任务都阻塞时让出主机CPU，节拍信号（SIGALRM）到来时提前返回
+ */
+void vApplicationIdleHook(void)
+{
+    const struct timespec ts = {.tv_sec = 0, .tv_nsec = 1000000};
+
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief   cmsis_os2.c中SysTick_Handler引用的内核节拍入口
+ * @note    POSIX移植的节拍来自SIGALRM，SysTick_Handler不会被调用
+ */
+void xPortSysTickHandler(void)
+{
+}
+
+/**
+ * @brief   configASSERT失败（FreeRTOSConfig.h的HOST_SIM分支）：报告位置后中止，便于在调试器中查看调用栈
+ */
+void sim_assert_failed(const char *file, int line)
+{
+    fprintf(stderr, "sim: assert failed at %s:%d\n", file, line);
+    abort();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* NVIC（cmsis_nvic_virtual.h），状态保存在仿真的NVIC寄存器中，power.c等直接读寄存器的代码看到的是同一份 */
+void sim_nvic_set_priority_grouping(uint32_t PriorityGroup)
+{
+    SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | ((PriorityGroup & 7UL) << SCB_AIRCR_PRIGROUP_Pos);
+}
+
+uint32_t sim_nvic_get_priority_grouping(void)
+{
+    return (SCB->AIRCR & SCB_AIRCR_PRIGROUP_Msk) >> SCB_AIRCR_PRIGROUP_Pos;
+}
+
+void sim_nvic_enable_irq(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) NVIC->ISER[(uint32_t)IRQn >> 5] |= 1UL << ((uint32_t)IRQn & 0x1FUL);
+}
+
+uint32_t sim_nvic_get_enable_irq(IRQn_Type IRQn)
+{
+    return IRQn >= 0 ? (NVIC->ISER[(uint32_t)IRQn >> 5] >> ((uint32_t)IRQn & 0x1FUL)) & 1UL : 0UL;
+}
+
+void sim_nvic_disable_irq(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) NVIC->ISER[(uint32_t)IRQn >> 5] &= ~(1UL << ((uint32_t)IRQn & 0x1FUL));
+}
+
+uint32_t sim_nvic_get_pending_irq(IRQn_Type IRQn)
+{
+    return IRQn >= 0 ? (NVIC->ISPR[(uint32_t)IRQn >> 5] >> ((uint32_t)IRQn & 0x1FUL)) & 1UL : 0UL;
+}
+
+void sim_nvic_set_pending_irq(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) NVIC->ISPR[(uint32_t)IRQn >> 5] |= 1UL << ((uint32_t)IRQn & 0x1FUL);
+}
+
+void sim_nvic_clear_pending_irq(IRQn_Type IRQn)
+{
+    if (IRQn >= 0) NVIC->ISPR[(uint32_t)IRQn >> 5] &= ~(1UL << ((uint32_t)IRQn & 0x1FUL));
+}
+
+uint32_t sim_nvic_get_active(IRQn_Type IRQn)
+{
+    return IRQn >= 0 && sim_ipsr == (uint32_t)IRQn + NVIC_USER_IRQ_OFFSET;
+}
+
+void sim_nvic_set_priority(IRQn_Type IRQn, uint32_t priority)
+{
+    if (IRQn >= 0) NVIC->IP[(uint32_t)IRQn] = (uint8_t)((priority << (8U - __NVIC_PRIO_BITS)) & 0xFFUL);
+}
+
+uint32_t sim_nvic_get_priority(IRQn_Type IRQn)
+{
+    return IRQn >= 0 ? (uint32_t)NVIC->IP[(uint32_t)IRQn] >> (8U - __NVIC_PRIO_BITS) : 0UL;
+}
+
+void sim_nvic_system_reset(void)
+{
+    fprintf(stderr, "sim: system reset requested\n");
+    exit(EXIT_FAILURE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* HAL核心（stm32f1xx_hal.c） */
+/**
+ * @brief   HAL初始化，同时启动仿真层：记录时间零点、打开控制台并创建仿真中断任务
+ * @note    仿真中断任务在osKernelStart之后才开始运行，调度器启动前没有任何中断
+ */
+HAL_StatusTypeDef HAL_Init(void)
+{
+    sim_t0 = 0;
+    sim_t0 = sim_now_ns();
+    sim_console_init();
+    configASSERT(xTaskCreateStatic(sim_task, "sim", sizeof(sim_task_stack) / sizeof(sim_task_stack[0]), NULL,
+                                   configMAX_PRIORITIES - 1, sim_task_stack, &sim_task_tcb) != NULL);
+
+    HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+    HAL_InitTick(TICK_INT_PRIORITY);
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+__weak void HAL_MspInit(void)
+{
+}
+
+__weak HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority)
+{
+    uwTickPrio = TickPriority;
+    return HAL_OK;
+}
+
+void HAL_IncTick(void)
+{
+    uwTick += uwTickFreq;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return uwTick;
+}
+
+uint32_t HAL_GetTickPrio(void)
+{
+    return uwTickPrio;
+}
+
+HAL_TickFreqTypeDef HAL_GetTickFreq(void)
+{
+    return uwTickFreq;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* NVIC（stm32f1xx_hal_cortex.c） */
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+    NVIC_SetPriorityGrouping(PriorityGroup >> SCB_AIRCR_PRIGROUP_Pos);
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    NVIC_SetPriority(IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), PreemptPriority, SubPriority));
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    NVIC_EnableIRQ(IRQn);
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    NVIC_DisableIRQ(IRQn);
+}
+
+uint32_t HAL_NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    return NVIC_GetPendingIRQ(IRQn);
+}
+
+void HAL_NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    NVIC_SetPendingIRQ(IRQn);
+}
+
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    NVIC_ClearPendingIRQ(IRQn);
+}
+
+void HAL_NVIC_SystemReset(void)
+{
+    NVIC_SystemReset();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* RCC（stm32f1xx_hal_rcc.c）：配置写入仿真的RCC->CFGR，各频率由它推算 */
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+    if (RCC_OscInitStruct->HSEState == RCC_HSE_ON) RCC->CR |= RCC_CR_HSEON | RCC_CR_HSERDY;
+    if (RCC_OscInitStruct->HSIState == RCC_HSI_ON) RCC->CR |= RCC_CR_HSION | RCC_CR_HSIRDY;
+    if (RCC_OscInitStruct->PLL.PLLState == RCC_PLL_ON) {
+        MODIFY_REG(RCC->CFGR, RCC_CFGR_PLLSRC | RCC_CFGR_PLLXTPRE | RCC_CFGR_PLLMULL,
+                   RCC_OscInitStruct->PLL.PLLSource | RCC_OscInitStruct->HSEPredivValue |
+                       RCC_OscInitStruct->PLL.PLLMUL);
+        RCC->CR |= RCC_CR_PLLON | RCC_CR_PLLRDY;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+    MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, FLatency);
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2 | RCC_CFGR_SW | RCC_CFGR_SWS,
+               RCC_ClkInitStruct->AHBCLKDivider | RCC_ClkInitStruct->APB1CLKDivider |
+                   (RCC_ClkInitStruct->APB2CLKDivider << 3) | RCC_ClkInitStruct->SYSCLKSource |
+                   (RCC_ClkInitStruct->SYSCLKSource << 2));
+    SystemCoreClock = sim_rcc_hclk();
+    return HAL_InitTick(uwTickPrio);
+}
+
+void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t *pFLatency)
+{
+    RCC_ClkInitStruct->ClockType = RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    RCC_ClkInitStruct->SYSCLKSource   = RCC->CFGR & RCC_CFGR_SW;
+    RCC_ClkInitStruct->AHBCLKDivider  = RCC->CFGR & RCC_CFGR_HPRE;
+    RCC_ClkInitStruct->APB1CLKDivider = RCC->CFGR & RCC_CFGR_PPRE1;
+    RCC_ClkInitStruct->APB2CLKDivider = (RCC->CFGR & RCC_CFGR_PPRE2) >> 3;
+    *pFLatency                        = FLASH->ACR & FLASH_ACR_LATENCY;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void)
+{
+    uint32_t cfgr = RCC->CFGR, src;
+
+    switch (cfgr & RCC_CFGR_SWS) {
+        case RCC_CFGR_SWS_HSE:
+            return HSE_VALUE;
+        case RCC_CFGR_SWS_PLL:
+            src = (cfgr & RCC_CFGR_PLLSRC) ? HSE_VALUE / ((cfgr & RCC_CFGR_PLLXTPRE) ? 2U : 1U) : HSI_VALUE / 2U;
+            return src * (((cfgr & RCC_CFGR_PLLMULL) >> RCC_CFGR_PLLMULL_Pos) == 0xFU
+                              ? 16U
+                              : ((cfgr & RCC_CFGR_PLLMULL) >> RCC_CFGR_PLLMULL_Pos) + 2U);
+        default:
+            return HSI_VALUE;
+    }
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+    return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+}
+
+/**
+ * @brief   按RCC->CFGR推算的AHB时钟（Hz）
+ */
+uint32_t sim_rcc_hclk(void)
+{
+    return HAL_RCC_GetSysClockFreq() >> AHBPrescTable[(RCC->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+}
+
+/**
+ * @brief   定时器的计数时钟（Hz）：所在APB分频不为1时为PCLK的2倍
+ */
+uint32_t sim_rcc_tim_clock(const TIM_TypeDef *tim)
+{
+    uint32_t ppre;
+
+    if (tim == TIM1 || tim == TIM8) {
+        ppre = (RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos;
+        return ppre < 4U ? HAL_RCC_GetPCLK2Freq() : 2U * HAL_RCC_GetPCLK2Freq();
+    }
+    ppre = (RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos;
+    return ppre < 4U ? HAL_RCC_GetPCLK1Freq() : 2U * HAL_RCC_GetPCLK1Freq();
+}
@@ -0,0 +1,204 @@
+/**
+ * @file    sim_gpio.c
+ * @brief   主机仿真层GPIO：HAL_GPIO_xxx替身与外部输入电平
+ * @note    HAL_GPIO_Init按真实HAL的编码写CRL/CRH，引脚的输入电平（IDR）由仿真层计算：
+ *          输出引脚回读ODR，被sim_gpio_input驱动的输入引脚取外部电平，其余输入引脚取上下拉电平（浮空为0）。
+ *          固件直接写ODR/BSRR时IDR不会随之更新，本工程的应用代码只通过HAL接口操作引脚。
+ */
+#include "main.h"
+
+#include <stdio.h>
+
+#include "sim.h"
+
+#define SIM_GPIO_PORTS 7
+
+// 外部驱动的引脚（掩码与电平），下标为端口序号A~G
+static uint16_t sim_gpio_ext_mask[SIM_GPIO_PORTS];
+static uint16_t sim_gpio_ext_val[SIM_GPIO_PORTS];
+static int sim_gpio_tracing;
+
+static GPIO_TypeDef *const sim_gpio_ports[SIM_GPIO_PORTS] = {GPIOA, GPIOB, GPIOC, GPIOD, GPIOE, GPIOF, GPIOG};
+
+static int sim_gpio_index(const GPIO_TypeDef *port)
+{
+    int i;
+
+    for (i = 0; i < SIM_GPIO_PORTS; i++) {
+        if (sim_gpio_ports[i] == port) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief   引脚是否为输出（CRL/CRH中MODE位非0）
+ */
+static int sim_gpio_is_output(const GPIO_TypeDef *port, uint32_t pos)
+{
+    uint32_t cr = pos < 8U ? port->CRL : port->CRH;
+
+    return ((cr >> ((pos & 7U) * 4U)) & 3U) != 0U;
+}
+
+/**
+ * @brief   按引脚配置、ODR与外部驱动重新计算IDR
+ */
+static void sim_gpio_update(GPIO_TypeDef *port)
+{
+    int idx = sim_gpio_index(port);
+    uint32_t pos, cnf, idr = 0;
+
+    if (idx < 0) return;
+    for (pos = 0; pos < 16U; pos++) {
+        cnf = (((pos < 8U ? port->CRL : port->CRH) >> ((pos & 7U) * 4U)) >> 2) & 3U;
+        if (sim_gpio_is_output(port, pos) || (!(sim_gpio_ext_mask[idx] & (1U << pos)) && cnf == 2U)) {
+            idr |= port->ODR & (1U << pos); // 输出回读，或输入上下拉（ODR位选择上拉/下拉）
+        } else if (sim_gpio_ext_mask[idx] & (1U << pos)) {
+            idr |= sim_gpio_ext_val[idx] & (1U << pos);
+        }
+    }
+    port->IDR = idr;
+}
+
+static void sim_gpio_log(const GPIO_TypeDef *port, uint32_t before)
+{
+    uint32_t diff = (before ^ port->ODR) & 0xFFFFU, pos;
+
+    if (!sim_gpio_tracing || diff == 0U) return;
+    for (pos = 0; pos < 16U; pos++) {
+        if (diff & (1U << pos)) {
+            fprintf(stderr, "sim: %10llu us P%c%u=%u\n", sim_now_ns() / 1000ULL, 'A' + sim_gpio_index(port),
+                    (unsigned int)pos, (unsigned int)((port->ODR >> pos) & 1U));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    uint32_t pos, config, shift;
+    __IO uint32_t *cr;
+
+    for (pos = 0; pos < 16U; pos++) {
+        if (!(GPIO_Init->Pin & (1U << pos))) continue;
+
+        switch (GPIO_Init->Mode) {
+            case GPIO_MODE_OUTPUT_PP:
+                config = GPIO_Init->Speed;
+                break;
+            case GPIO_MODE_OUTPUT_OD:
+                config = GPIO_Init->Speed | 0x4U;
+                break;
+            case GPIO_MODE_AF_PP:
+                config = GPIO_Init->Speed | 0x8U;
+                break;
+            case GPIO_MODE_AF_OD:
+                config = GPIO_Init->Speed | 0xCU;
+                break;
+            case GPIO_MODE_ANALOG:
+                config = 0x0U;
+                break;
+            default: // 输入、复用输入、外部中断/事件
+                if (GPIO_Init->Pull == GPIO_NOPULL) {
+                    config = 0x4U;
+                } else {
+                    config = 0x8U;
+                    if (GPIO_Init->Pull == GPIO_PULLUP) {
+                        GPIOx->ODR |= 1U << pos;
+                    } else {
+                        GPIOx->ODR &= ~(1U << pos);
+                    }
+                }
+                break;
+        }
+        cr    = pos < 8U ? &GPIOx->CRL : &GPIOx->CRH;
+        shift = (pos & 7U) * 4U;
+        MODIFY_REG(*cr, 0xFU << shift, config << shift);
+    }
+    sim_gpio_update(GPIOx);
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+    uint32_t pos, shift;
+    __IO uint32_t *cr;
+
+    for (pos = 0; pos < 16U; pos++) {
+        if (!(GPIO_Pin & (1U << pos))) continue;
+        cr    = pos < 8U ? &GPIOx->CRL : &GPIOx->CRH;
+        shift = (pos & 7U) * 4U;
+        MODIFY_REG(*cr, 0xFU << shift, 0x4U << shift); // 复位状态：浮空输入
+        GPIOx->ODR &= ~(1U << pos);
+    }
+    sim_gpio_update(GPIOx);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    uint32_t before = GPIOx->ODR;
+
+    if (PinState != GPIO_PIN_RESET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+    sim_gpio_update(GPIOx);
+    sim_gpio_log(GPIOx, before);
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    uint32_t before = GPIOx->ODR;
+
+    GPIOx->ODR ^= GPIO_Pin;
+    sim_gpio_update(GPIOx);
+    sim_gpio_log(GPIOx, before);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   外部电路驱动输入引脚（例如红外接收头的输出）
+ * @param   port: GPIO端口
+ * @param   pin: 引脚掩码（GPIO_PIN_x）
+ * @param   level: 外部电平
+ * @retval  None
+ */
+void sim_gpio_input(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState level)
+{
+    int idx = sim_gpio_index(port);
+
+    if (idx < 0) return;
+    sim_gpio_ext_mask[idx] |= pin;
+    if (level != GPIO_PIN_RESET) {
+        sim_gpio_ext_val[idx] |= pin;
+    } else {
+        sim_gpio_ext_val[idx] &= (uint16_t)~pin;
+    }
+    sim_gpio_update(port);
+}
+
+/**
+ * @brief   打开/关闭输出引脚变化的日志（stderr）
+ */
+void sim_gpio_trace(int on)
+{
+    sim_gpio_tracing = on;
+}
+
+/**
+ * @brief   打印各端口的ODR/IDR
+ */
+void sim_gpio_report(void)
+{
+    int i;
+
+    for (i = 0; i < SIM_GPIO_PORTS; i++) {
+        fprintf(stderr, "GPIO%c ODR=%04X IDR=%04X\n", 'A' + i, (unsigned int)(sim_gpio_ports[i]->ODR & 0xFFFFU),
+                (unsigned int)(sim_gpio_ports[i]->IDR & 0xFFFFU));
+    }
+}
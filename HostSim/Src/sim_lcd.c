@@ -0,0 +1,184 @@
+/**
+ * @file    sim_lcd.c
+ * @brief   主机仿真层LCD：FSMC/SRAM替身与ILI9341控制器模型
+ * @note    lcd.h的LCD_REG_WRITE/LCD_RAM_WRITE/LCD_RAM_READ在HOST_SIM构建中调用这里。
+ *          模型只实现驱动用到的命令：读ID（0xD3）、列/页地址（0x2A/0x2B）、扫描方向（0x36）、
+ *          写/读GRAM（0x2C/0x3C/0x2E）；其余命令及其参数被忽略。
+ *          显存为240x320的RGB565，控制台命令"lcd <文件>"把它保存为PPM图片。
+ */
+#include "main.h"
+
+#include <stdio.h>
+
+#include "sim.h"
+
+#define SIM_LCD_W 240U
+#define SIM_LCD_H 320U
+
+// MADCTL（0x36）中的扫描方向位
+#define SIM_LCD_MY 0x80U
+#define SIM_LCD_MX 0x40U
+#define SIM_LCD_MV 0x20U
+
+static uint16_t sim_lcd_fb[SIM_LCD_H][SIM_LCD_W];
+
+static struct
+{
+    uint16_t cmd;       // 当前命令
+    unsigned int param; // 当前命令已收到的参数个数（读命令为已读出的个数）
+    uint16_t xs, xe;    // 列地址窗口
+    uint16_t ys, ye;    // 页地址窗口
+    uint16_t x, y;      // 读写GRAM的当前位置（窗口坐标）
+    uint8_t madctl;
+    unsigned long pixels;
+} sim_lcd = {.xe = SIM_LCD_W - 1U, .ye = SIM_LCD_H - 1U};
+
+/**
+ * @brief   窗口坐标按MADCTL映射到显存中的像素
+ * @retval  NULL: 超出面板
+ */
+static uint16_t *sim_lcd_pixel(uint16_t col, uint16_t page)
+{
+    uint16_t px = col, py = page, t;
+
+    if (sim_lcd.madctl & SIM_LCD_MV) {
+        t  = px;
+        px = py;
+        py = t;
+    }
+    if (px >= SIM_LCD_W || py >= SIM_LCD_H) return NULL;
+    if (sim_lcd.madctl & SIM_LCD_MX) px = (uint16_t)(SIM_LCD_W - 1U - px);
+    if (sim_lcd.madctl & SIM_LCD_MY) py = (uint16_t)(SIM_LCD_H - 1U - py);
+    return &sim_lcd_fb[py][px];
+}
+
+/**
+ * @brief   GRAM地址在窗口内自增：先列后页，越过窗口末尾回到起点
+ */
+static void sim_lcd_advance(void)
+{
+    if (sim_lcd.x < sim_lcd.xe) {
+        sim_lcd.x++;
+        return;
+    }
+    sim_lcd.x = sim_lcd.xs;
+    sim_lcd.y = sim_lcd.y < sim_lcd.ye ? (uint16_t)(sim_lcd.y + 1U) : sim_lcd.ys;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void sim_lcd_write_reg(uint16_t regno)
+{
+    sim_lcd.cmd   = regno;
+    sim_lcd.param = 0;
+    if (regno == 0x2CU || regno == 0x2EU) {
+        sim_lcd.x = sim_lcd.xs;
+        sim_lcd.y = sim_lcd.ys;
+    }
+}
+
+void sim_lcd_write_ram(uint16_t data)
+{
+    uint16_t *p;
+    const uint8_t b = (uint8_t)data;
+
+    switch (sim_lcd.cmd) {
+        case 0x2A: // 列地址：起点高/低字节，终点高/低字节（可只写起点）
+        case 0x2B: {
+            uint16_t *s = sim_lcd.cmd == 0x2AU ? &sim_lcd.xs : &sim_lcd.ys;
+            uint16_t *e = sim_lcd.cmd == 0x2AU ? &sim_lcd.xe : &sim_lcd.ye;
+
+            switch (sim_lcd.param) {
+                case 0: *s = (uint16_t)((*s & 0x00FFU) | (b << 8)); break;
+                case 1: *s = (uint16_t)((*s & 0xFF00U) | b); break;
+                case 2: *e = (uint16_t)((*e & 0x00FFU) | (b << 8)); break;
+                case 3: *e = (uint16_t)((*e & 0xFF00U) | b); break;
+                default: break;
+            }
+            break;
+        }
+        case 0x36:
+            if (sim_lcd.param == 0U) sim_lcd.madctl = b;
+            break;
+        case 0x2C:
+        case 0x3C:
+            p = sim_lcd_pixel(sim_lcd.x, sim_lcd.y);
+            if (p != NULL) *p = data;
+            sim_lcd.pixels++;
+            sim_lcd_advance();
+            break;
+        default:
+            break;
+    }
+    sim_lcd.param++;
+}
+
+/**
+ * @brief   读数据口：0xD3返回ILI9341的ID，0x2E按控制器格式读GRAM（先空读，每像素两次）
+ */
+uint16_t sim_lcd_read_ram(void)
+{
+    static const uint16_t id[] = {0x00, 0x00, 0x93, 0x41};
+    const unsigned int n = sim_lcd.param++;
+    uint16_t *p, c;
+
+    switch (sim_lcd.cmd) {
+        case 0xD3:
+            return n < 4U ? id[n] : 0U;
+        case 0x2E:
+            if (n == 0U) return 0U; // 空读
+            p = sim_lcd_pixel(sim_lcd.x, sim_lcd.y);
+            c = p != NULL ? *p : 0U;
+            if (n & 1U) return (uint16_t)(((c >> 11) << 11) | ((c >> 5 & 0x3FU) << 2)); // R[15:11] G[7:2]
+            sim_lcd_advance();
+            return (uint16_t)((c & 0x1FU) << 11); // B[15:11]
+        default:
+            return 0U;
+    }
+}
+
+/**
+ * @brief   把显存保存为PPM（P6）图片
+ * @param   path: 文件路径
+ * @retval  0: 成功，-1: 失败
+ */
+int sim_lcd_dump(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    unsigned int x, y;
+    uint16_t c;
+
+    if (f == NULL) return -1;
+    fprintf(f, "P6\n%u %u\n255\n", SIM_LCD_W, SIM_LCD_H);
+    for (y = 0; y < SIM_LCD_H; y++) {
+        for (x = 0; x < SIM_LCD_W; x++) {
+            c = sim_lcd_fb[y][x];
+            fputc((c >> 11) << 3 | (c >> 13), f);
+            fputc((c >> 5 & 0x3FU) << 2 | (c >> 9 & 0x3U), f);
+            fputc((c & 0x1FU) << 3 | (c >> 2 & 0x7U), f);
+        }
+    }
+    fprintf(stderr, "sim: LCD %ux%u MADCTL=%02X pixels=%lu -> %s\n", SIM_LCD_W, SIM_LCD_H, sim_lcd.madctl,
+            sim_lcd.pixels, path);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* SRAM替身（stm32f1xx_hal_sram.c）：只调用MspInit并记录状态，FSMC时序对仿真没有影响 */
+HAL_StatusTypeDef HAL_SRAM_Init(SRAM_HandleTypeDef *hsram, FSMC_NORSRAM_TimingTypeDef *Timing,
+                                FSMC_NORSRAM_TimingTypeDef *ExtTiming)
+{
+    (void)Timing;
+    (void)ExtTiming;
+    if (hsram == NULL) return HAL_ERROR;
+    if (hsram->State == HAL_SRAM_STATE_RESET) {
+        hsram->Lock = HAL_UNLOCKED;
+        HAL_SRAM_MspInit(hsram);
+    }
+    hsram->State = HAL_SRAM_STATE_READY;
+    return HAL_OK;
+}
+
+__weak void HAL_SRAM_MspInit(SRAM_HandleTypeDef *hsram)
+{
+    (void)hsram;
+}
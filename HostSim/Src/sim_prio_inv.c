@@ -0,0 +1,174 @@
+/**
+ * @file    sim_prio_inv.c
+ * @brief   主机仿真层优先级反转场景（控制台命令"pi"）
+ * @note    三个临时任务争用一把锁：
+ *          - 低优先级任务先取得锁，做SIM_PI_HOLD_MS的计算后释放
+ *          - 高优先级任务随后请求同一把锁，记录等待时间
+ *          - 中优先级任务同时做SIM_PI_SPIN_MS的计算，不碰锁
+ *          用二值信号量（原串口写锁的做法）时，中优先级任务抢占持有者，高优先级任务等待约HOLD+SPIN；
+ *          用res_lock（优先级继承互斥量）时，持有者继承高优先级，等待约HOLD。
+ *          计算时间按线程CPU时间计量，任务被抢占期间不计，结果不受主机负载影响。
+ *          场景在控制任务中执行，结果打印到stderr，结束后删除临时任务。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include "res_lock.h"
+#include "sim.h"
+
+#define SIM_PI_HOLD_MS  5
+#define SIM_PI_SPIN_MS  50
+#define SIM_PI_STACK    (configMINIMAL_STACK_SIZE * 4)
+
+// 场景任务的优先级：控制任务最高，其余依次为高/中/低，都在仿真中断任务之下
+#define SIM_PI_PRIO_CTL  osPriorityRealtime
+#define SIM_PI_PRIO_HIGH osPriorityHigh
+#define SIM_PI_PRIO_MID  osPriorityAboveNormal
+#define SIM_PI_PRIO_LOW  osPriorityLow1
+
+typedef struct
+{
+    StaticTask_t tcb;
+    StackType_t stack[SIM_PI_STACK];
+    TaskHandle_t handle;
+} SIM_PI_TASK;
+
+static SIM_PI_TASK sim_pi_ctl, sim_pi_low, sim_pi_mid, sim_pi_high;
+static osSemaphoreId_t sim_pi_sem;
+static StaticSemaphore_t sim_pi_sem_cb;
+static RES_LOCK sim_pi_lock;
+static int sim_pi_use_mutex;
+static volatile int sim_pi_locked, sim_pi_done, sim_pi_running;
+static volatile unsigned long long sim_pi_wait_ns;
+
+static unsigned long long sim_pi_cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief   消耗ms毫秒的线程CPU时间（被抢占期间不计）
+ */
+static void sim_pi_spin(unsigned int ms)
+{
+    const unsigned long long end = sim_pi_cpu_ns() + ms * 1000000ULL;
+
+    while (sim_pi_cpu_ns() < end) {
+    }
+}
+
+static void sim_pi_take(void)
+{
+    if (sim_pi_use_mutex) {
+        res_lock_take(&sim_pi_lock, osWaitForever);
+    } else {
+        osSemaphoreAcquire(sim_pi_sem, osWaitForever);
+    }
+}
+
+static void sim_pi_give(void)
+{
+    if (sim_pi_use_mutex) {
+        res_lock_give(&sim_pi_lock);
+    } else {
+        osSemaphoreRelease(sim_pi_sem);
+    }
+}
+
+static void sim_pi_low_task(void *arg)
+{
+    (void)arg;
+    sim_pi_take();
+    sim_pi_locked = 1;
+    sim_pi_spin(SIM_PI_HOLD_MS);
+    sim_pi_give();
+    vTaskSuspend(NULL);
+}
+
+static void sim_pi_mid_task(void *arg)
+{
+    (void)arg;
+    sim_pi_spin(SIM_PI_SPIN_MS);
+    vTaskSuspend(NULL);
+}
+
+static void sim_pi_high_task(void *arg)
+{
+    unsigned long long t0 = sim_now_ns();
+
+    (void)arg;
+    sim_pi_take();
+    sim_pi_wait_ns = sim_now_ns() - t0;
+    sim_pi_give();
+    sim_pi_done = 1;
+    vTaskSuspend(NULL);
+}
+
+static void sim_pi_start(SIM_PI_TASK *t, TaskFunction_t fn, const char *name, osPriority_t prio)
+{
+    t->handle = xTaskCreateStatic(fn, name, SIM_PI_STACK, NULL, (UBaseType_t)prio, t->stack, &t->tcb);
+    configASSERT(t->handle != NULL);
+}
+
+/**
+ * @brief   执行一次场景，返回高优先级任务的等待时间（ns）
+ */
+static unsigned long long sim_pi_run(int use_mutex)
+{
+    unsigned int ms;
+
+    sim_pi_use_mutex = use_mutex;
+    sim_pi_locked    = 0;
+    sim_pi_done      = 0;
+    sim_pi_start(&sim_pi_low, sim_pi_low_task, "pi_low", SIM_PI_PRIO_LOW);
+    while (!sim_pi_locked) vTaskDelay(1);
+    // 控制任务阻塞后高优先级任务先运行并在锁上阻塞，中优先级任务随后开始计算
+    sim_pi_start(&sim_pi_high, sim_pi_high_task, "pi_high", SIM_PI_PRIO_HIGH);
+    sim_pi_start(&sim_pi_mid, sim_pi_mid_task, "pi_mid", SIM_PI_PRIO_MID);
+    for (ms = 0; !sim_pi_done && ms < 10U * (SIM_PI_HOLD_MS + SIM_PI_SPIN_MS); ms++) vTaskDelay(pdMS_TO_TICKS(1));
+    vTaskDelete(sim_pi_high.handle);
+    vTaskDelete(sim_pi_mid.handle);
+    vTaskDelete(sim_pi_low.handle);
+    return sim_pi_done ? sim_pi_wait_ns : 0;
+}
+
+static void sim_pi_ctl_task(void *arg)
+{
+    unsigned long long sem, mtx;
+
+    (void)arg;
+    sem = sim_pi_run(0);
+    mtx = sim_pi_run(1);
+    fprintf(stderr, "sim: pi low holds %d ms, mid spins %d ms, high waited: semaphore %.1f ms, res_lock %.1f ms\n",
+            SIM_PI_HOLD_MS, SIM_PI_SPIN_MS, sem / 1e6, mtx / 1e6);
+    sim_pi_running = 0;
+    vTaskDelete(NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   启动优先级反转场景（仿真中断任务中调用，只创建控制任务）
+ */
+void sim_prio_inv_start(void)
+{
+    const osSemaphoreAttr_t sem_attr = {.name = "pi_sem", .cb_mem = &sim_pi_sem_cb, .cb_size = sizeof(sim_pi_sem_cb)};
+
+    if (sim_pi_running) {
+        fprintf(stderr, "sim: pi already running\n");
+        return;
+    }
+    if (sim_pi_sem == NULL) {
+        sim_pi_sem = osSemaphoreNew(1, 1, &sem_attr);
+        res_lock_init(&sim_pi_lock, "pi", 0);
+    }
+    sim_pi_running = 1;
+    sim_pi_start(&sim_pi_ctl, sim_pi_ctl_task, "pi_ctl", SIM_PI_PRIO_CTL);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file    sim_seqlock.c
+ * @brief   主机仿真层快照并发读写场景（控制台命令"seqlock [ms]"）
+ * @note    一个写入任务反复发布SYS_PART_SIM分区（每次发布的所有字都等于同一个递增序号），
+ *          一个读者任务反复用sys_snapshot读取并检查：所有字相等（没有混合两次发布的数据）、
+ *          序号不回退（没有读到比上一次更旧的发布）。场景分两半，两个任务的优先级对调：
+ *          - 前一半读者在低优先级连续读取，写入者每个节拍醒来连续发布3次，
+ *            读者拷贝到一半被抢占、回来时两份缓冲区都已被改写
+ *          - 后一半写入者在低优先级连续发布，读者每个节拍醒来读取一次，写入者拷贝到一半被抢占
+ *          POSIX移植中任务在节拍信号处被抢占，与单核上的中断抢占相同，retries（读者重试次数）大于0说明确实发生了交错。
+ *          结果打印到stderr，结束后删除临时任务。
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "cmsis_os.h"
+
+#include <stdio.h>
+
+#include "my_sys_data.h"
+#include "sim.h"
+
+#define SIM_SL_STACK    (configMINIMAL_STACK_SIZE * 4)
+#define SIM_SL_BURST    3
+
+// 两个场景任务在仿真中断任务之下，高优先级一方高于所有应用任务
+#define SIM_SL_PRIO_HIGH osPriorityRealtime
+#define SIM_SL_PRIO_LOW  osPriorityLow1
+
+typedef struct
+{
+    StaticTask_t tcb;
+    StackType_t stack[SIM_SL_STACK];
+    TaskHandle_t handle;
+} SIM_SL_TASK;
+
+static SIM_SL_TASK sim_sl_ctl, sim_sl_writer, sim_sl_reader;
+static SYS_SIM_DATA sim_sl_wbuf, sim_sl_rbuf;
+static volatile int sim_sl_writer_high, sim_sl_stop, sim_sl_running;
+static unsigned int sim_sl_ms;
+static volatile unsigned long sim_sl_publishes, sim_sl_reads, sim_sl_torn, sim_sl_stale;
+
+static void sim_sl_publish(unsigned int seq)
+{
+    unsigned int i;
+
+    for (i = 0; i < SYS_SIM_WORDS; i++) sim_sl_wbuf.word[i] = seq;
+    sys_publish(SYS_PART_SIM, &sim_sl_wbuf);
+    sim_sl_publishes++;
+}
+
+static void sim_sl_writer_task(void *arg)
+{
+    unsigned int seq = 0, i;
+
+    (void)arg;
+    while (!sim_sl_stop) {
+        if (sim_sl_writer_high) {
+            for (i = 0; i < SIM_SL_BURST; i++) sim_sl_publish(++seq);
+            vTaskDelay(1);
+        } else {
+            sim_sl_publish(++seq);
+        }
+    }
+    vTaskSuspend(NULL);
+}
+
+/**
+ * @brief   读取一次快照并检查
+ */
+static void sim_sl_read(unsigned int *last)
+{
+    unsigned int i;
+
+    sys_snapshot(SYS_PART_SIM, &sim_sl_rbuf);
+    sim_sl_reads++;
+    for (i = 1; i < SYS_SIM_WORDS; i++) {
+        if (sim_sl_rbuf.word[i] != sim_sl_rbuf.word[0]) {
+            sim_sl_torn++;
+            return;
+        }
+    }
+    if (sim_sl_rbuf.word[0] < *last) sim_sl_stale++;
+    *last = sim_sl_rbuf.word[0];
+}
+
+static void sim_sl_reader_task(void *arg)
+{
+    unsigned int last = 0;
+
+    (void)arg;
+    while (!sim_sl_stop) {
+        sim_sl_read(&last);
+        if (!sim_sl_writer_high) vTaskDelay(1);
+    }
+    vTaskSuspend(NULL);
+}
+
+static void sim_sl_start(SIM_SL_TASK *t, TaskFunction_t fn, const char *name, osPriority_t prio)
+{
+    t->handle = xTaskCreateStatic(fn, name, SIM_SL_STACK, NULL, (UBaseType_t)prio, t->stack, &t->tcb);
+    configASSERT(t->handle != NULL);
+}
+
+static void sim_sl_ctl_task(void *arg)
+{
+    const unsigned int retries0 = sys_part_retries(SYS_PART_SIM);
+
+    (void)arg;
+    sim_sl_publishes = sim_sl_reads = sim_sl_torn = sim_sl_stale = 0;
+    sim_sl_stop        = 0;
+    sim_sl_writer_high = 1;
+    sim_sl_start(&sim_sl_writer, sim_sl_writer_task, "sl_w", SIM_SL_PRIO_HIGH);
+    sim_sl_start(&sim_sl_reader, sim_sl_reader_task, "sl_r", SIM_SL_PRIO_LOW);
+    vTaskDelay(pdMS_TO_TICKS(sim_sl_ms / 2U));
+    sim_sl_writer_high = 0;
+    vTaskPrioritySet(sim_sl_writer.handle, SIM_SL_PRIO_LOW);
+    vTaskPrioritySet(sim_sl_reader.handle, SIM_SL_PRIO_HIGH);
+    vTaskDelay(pdMS_TO_TICKS(sim_sl_ms / 2U));
+    // 等两个任务做完手头的发布/读取后再删除
+    sim_sl_stop = 1;
+    while (eTaskGetState(sim_sl_writer.handle) != eSuspended || eTaskGetState(sim_sl_reader.handle) != eSuspended) {
+        vTaskDelay(1);
+    }
+    vTaskDelete(sim_sl_writer.handle);
+    vTaskDelete(sim_sl_reader.handle);
+    fprintf(stderr, "sim: seqlock %u ms publishes=%lu reads=%lu retries=%u torn=%lu stale=%lu\n", sim_sl_ms,
+            sim_sl_publishes, sim_sl_reads, sys_part_retries(SYS_PART_SIM) - retries0, sim_sl_torn, sim_sl_stale);
+    sim_sl_running = 0;
+    vTaskDelete(NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   启动快照并发读写场景（仿真中断任务中调用，只创建控制任务）
+ * @param   ms: 场景时长（ms），0为默认2000ms
+ */
+void sim_seqlock_start(unsigned int ms)
+{
+    if (sim_sl_running) {
+        fprintf(stderr, "sim: seqlock already running\n");
+        return;
+    }
+    sim_sl_ms      = ms != 0U ? ms : 2000U;
+    sim_sl_running = 1;
+    sim_sl_start(&sim_sl_ctl, sim_sl_ctl_task, "sl_ctl", osPriorityRealtime1);
+}
@@ -0,0 +1,699 @@
+/**
+ * @file    sim_tim.c
+ * @brief   主机仿真层定时器：HAL_TIM_xxx替身、按主机时间推进的计数器与红外遥控信号源
+ * @note    每个定时器记录计数器为0的时刻zero_ns，计数值、更新事件与比较事件都由它和PSC/ARR/CCRx推算，
+ *          不逐个计数周期地模拟。sim_tim_poll把(上次处理时刻, now]内的事件按时间顺序投递：
+ *          投递前把CNT写成事件发生时的计数值并置SR标志，中断服务函数改写CNT（如红外解码清零计数器）后
+ *          按新值重新对齐zero_ns。只产生中断使能（DIER）的事件。
+ *          外部时钟模式1（SMS=111，触发输入ITR0~3）的从定时器对主定时器的更新事件计数（主定时器CR2.MMS须为更新），
+ *          计数值由主定时器的更新次数推算，计数沿与主定时器的溢出时刻严格对齐，如TIM2→TIM3（ITR1）、TIM5→TIM1（ITR0）。
+ *          SR按硬件的rc_w0语义仿真：仿真层保存挂起标志的影子sr，固件写入SR的值（HAL的SR = ~flag）
+ *          在中断服务函数返回后与每次查询时与影子按位与，再把影子写回SR，写0清除对应标志、写1不影响。
+ *          红外信号源按NEC时序驱动PB9，并在边沿时刻对TIM4通道4做输入捕获。
+ */
+#include "main.h"
+#include "tim.h"
+#include "remote.h"
+
+#include <stdio.h>
+
+#include "sim.h"
+
+#define SIM_TIM_SMS_EXTERNAL1 (TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0)
+
+typedef struct
+{
+    TIM_TypeDef *inst;
+    unsigned int num;            // 定时器编号（报告用）
+    IRQn_Type up_irq;
+    IRQn_Type cc_irq;
+    int running;                 // 上次查询时CEN的状态
+    unsigned long long zero_ns;  // 计数器为0的时刻
+    unsigned long long last_ns;  // 已处理到的时刻
+    uint32_t psc, arr;           // 推算zero_ns时使用的PSC/ARR
+    uint32_t cnt;                // 仿真层最近写入CNT的值，用于发现固件改写了计数器
+    uint32_t sr;                 // 挂起的事件标志（SR的影子）
+    long long up0;               // 外部时钟从模式：计数器为0时主定时器的更新次数（代替zero_ns）
+    unsigned long irqs;          // 已投递的事件数
+} SIM_TIM;
+
+static SIM_TIM sim_tims[] = {
+    {.inst = TIM1, .num = 1, .up_irq = TIM1_UP_IRQn, .cc_irq = TIM1_CC_IRQn},
+    {.inst = TIM2, .num = 2, .up_irq = TIM2_IRQn, .cc_irq = TIM2_IRQn},
+    {.inst = TIM3, .num = 3, .up_irq = TIM3_IRQn, .cc_irq = TIM3_IRQn},
+    {.inst = TIM4, .num = 4, .up_irq = TIM4_IRQn, .cc_irq = TIM4_IRQn},
+    {.inst = TIM5, .num = 5, .up_irq = TIM5_IRQn, .cc_irq = TIM5_IRQn},
+    {.inst = TIM6, .num = 6, .up_irq = TIM6_IRQn, .cc_irq = TIM6_IRQn},
+    {.inst = TIM7, .num = 7, .up_irq = TIM7_IRQn, .cc_irq = TIM7_IRQn},
+    {.inst = TIM8, .num = 8, .up_irq = TIM8_UP_IRQn, .cc_irq = TIM8_CC_IRQn},
+};
+#define SIM_TIM_NUM (sizeof(sim_tims) / sizeof(sim_tims[0]))
+
+// 红外信号源：待输出的边沿（时刻与电平），环形队列
+#define SIM_IR_EDGES 1024U
+typedef struct
+{
+    unsigned long long t_ns;
+    uint8_t level;
+} SIM_IR_EDGE;
+static SIM_IR_EDGE sim_ir_edge[SIM_IR_EDGES];
+static unsigned int sim_ir_head, sim_ir_tail;
+
+// 外部时钟模式1的触发输入ITR0~3连接的主定时器编号（RM0008 表86），下标为从定时器编号
+static const uint8_t sim_tim_itr[9][4] = {
+    [1] = {5, 2, 3, 4}, [2] = {1, 8, 3, 4}, [3] = {1, 2, 5, 4},
+    [4] = {1, 2, 3, 8}, [5] = {2, 3, 4, 8}, [8] = {1, 2, 4, 5},
+};
+
+// 正在投递的事件时刻（sim_tim_poll之外为0），中断服务函数中启动的定时器以它为计数起点
+static unsigned long long sim_tim_cur_ns;
+
+static SIM_TIM *sim_tim_find(const TIM_TypeDef *inst)
+{
+    unsigned int i;
+
+    for (i = 0; i < SIM_TIM_NUM; i++) {
+        if (sim_tims[i].inst == inst) return &sim_tims[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief   外部时钟模式1下驱动计数的主定时器
+ * @retval  内部时钟、触发输入不是ITRx或主定时器不输出更新事件时为NULL
+ */
+static SIM_TIM *sim_tim_master(const SIM_TIM *t)
+{
+    const uint32_t ts = (t->inst->SMCR & TIM_SMCR_TS) >> TIM_SMCR_TS_Pos;
+    SIM_TIM *m;
+    unsigned int i;
+
+    if ((t->inst->SMCR & TIM_SMCR_SMS) != SIM_TIM_SMS_EXTERNAL1 || ts > 3U || t->num >= 9U) return NULL;
+    for (i = 0, m = NULL; i < SIM_TIM_NUM; i++) {
+        if (sim_tims[i].num == sim_tim_itr[t->num][ts]) m = &sim_tims[i];
+    }
+    if (m == NULL || (m->inst->CR2 & TIM_CR2_MMS) != TIM_TRGO_UPDATE) return NULL;
+    return m;
+}
+
+/**
+ * @brief   把固件写入SR的值按rc_w0并入挂起标志：写0的位清除，写1的位不变
+ */
+static void sim_tim_sr_fold(SIM_TIM *t)
+{
+    t->sr &= t->inst->SR;
+    t->inst->SR = t->sr;
+}
+
+/**
+ * @brief   置事件标志
+ */
+static void sim_tim_sr_set(SIM_TIM *t, uint32_t flags)
+{
+    sim_tim_sr_fold(t);
+    t->sr |= flags;
+    t->inst->SR = t->sr;
+}
+
+/**
+ * @brief   计数周期（ns）= 分子/分母
+ */
+static void sim_tim_tick(const SIM_TIM *t, unsigned __int128 *num, unsigned __int128 *den)
+{
+    *num = (unsigned __int128)(t->psc + 1U) * 1000000000U;
+    *den = sim_rcc_tim_clock(t->inst);
+}
+
+/**
+ * @brief   从zero_ns到t_ns经过的计数周期数（外部时钟从模式：计数器为0以来主定时器更新次数/(PSC+1)）
+ */
+static unsigned long long sim_tim_ticks_at(const SIM_TIM *t, unsigned long long t_ns)
+{
+    const SIM_TIM *m = sim_tim_master(t);
+    unsigned __int128 num, den;
+    long long up;
+
+    if (m != NULL) {
+        up = (long long)(sim_tim_ticks_at(m, t_ns) / ((unsigned long long)m->arr + 1U)) - t->up0;
+        return up > 0 ? (unsigned long long)up / (t->psc + 1U) : 0U;
+    }
+    if (t_ns <= t->zero_ns) return 0;
+    sim_tim_tick(t, &num, &den);
+    return (unsigned long long)((unsigned __int128)(t_ns - t->zero_ns) * den / num);
+}
+
+/**
+ * @brief   第ticks个计数周期开始的时刻
+ */
+static unsigned long long sim_tim_time_of(const SIM_TIM *t, unsigned long long ticks)
+{
+    const SIM_TIM *m = sim_tim_master(t);
+    unsigned __int128 num, den;
+
+    if (m != NULL) {
+        return sim_tim_time_of(m, (unsigned long long)(t->up0 + (long long)(ticks * (t->psc + 1U))) *
+                                      ((unsigned long long)m->arr + 1U));
+    }
+    sim_tim_tick(t, &num, &den);
+    return t->zero_ns + (unsigned long long)(((unsigned __int128)ticks * num + den - 1U) / den);
+}
+
+/**
+ * @brief   让计数器在t_ns时刻的计数值为cnt
+ */
+static void sim_tim_align(SIM_TIM *t, unsigned long long t_ns, uint32_t cnt)
+{
+    const SIM_TIM *m = sim_tim_master(t);
+    unsigned __int128 num, den;
+    unsigned long long back;
+
+    if (m != NULL) {
+        // 以t_ns之前主定时器最近的一次更新为计数沿
+        t->up0 = (long long)(sim_tim_ticks_at(m, t_ns) / ((unsigned long long)m->arr + 1U)) -
+                 (long long)cnt * (t->psc + 1U);
+        return;
+    }
+    sim_tim_tick(t, &num, &den);
+    back       = (unsigned long long)((unsigned __int128)cnt * num / den);
+    t->zero_ns = t_ns > back ? t_ns - back : 0;
+}
+
+/**
+ * @brief   定时器是否在计数（CEN；外部时钟从模式还要求主定时器在计数）
+ */
+static int sim_tim_counting(const SIM_TIM *t)
+{
+    const SIM_TIM *m = sim_tim_master(t);
+
+    if (!(t->inst->CR1 & TIM_CR1_CEN)) return 0;
+    if ((t->inst->SMCR & TIM_SMCR_SMS) != SIM_TIM_SMS_EXTERNAL1) return 1;
+    return m != NULL && m->running;
+}
+
+/**
+ * @brief   通道c（0~3）的捕获/比较选择（CCxS）
+ */
+static uint32_t sim_tim_ccs(const TIM_TypeDef *tim, unsigned int c)
+{
+    uint32_t ccmr = c < 2U ? tim->CCMR1 : tim->CCMR2;
+
+    return (ccmr >> ((c & 1U) * 8U)) & TIM_CCMR1_CC1S;
+}
+
+static __IO uint32_t *sim_tim_ccr(TIM_TypeDef *tim, unsigned int c)
+{
+    return &tim->CCR1 + c * ((&tim->CCR2 - &tim->CCR1));
+}
+
+/**
+ * @brief   同步计数器状态：启停、PSC/ARR变化与固件对CNT的改写
+ */
+static void sim_tim_sync(SIM_TIM *t, unsigned long long now)
+{
+    SIM_TIM *m = sim_tim_master(t);
+
+    // 从定时器的计数依赖主定时器的状态，先同步主定时器
+    if (m != NULL) sim_tim_sync(m, now);
+    sim_tim_sr_fold(t);
+    if (!sim_tim_counting(t)) {
+        t->running = 0;
+        return;
+    }
+    if (!t->running) {
+        t->running = 1;
+        t->psc     = t->inst->PSC;
+        t->arr     = t->inst->ARR;
+        t->cnt     = t->inst->CNT;
+        t->last_ns = now;
+        sim_tim_align(t, now, t->cnt);
+        return;
+    }
+    if (t->inst->PSC != t->psc || t->inst->ARR != t->arr || t->inst->CNT != t->cnt) {
+        t->psc = t->inst->PSC;
+        t->arr = t->inst->ARR;
+        t->cnt = t->inst->CNT;
+        sim_tim_align(t, t->last_ns, t->cnt);
+    }
+}
+
+/**
+ * @brief   下一个事件的计数序号与事件标志
+ * @retval  0: 没有会产生中断的事件
+ */
+static int sim_tim_next(const SIM_TIM *t, unsigned long long *tick, uint32_t *flags)
+{
+    const uint32_t dier = t->inst->DIER;
+    const unsigned long long period = (unsigned long long)t->arr + 1U;
+    unsigned long long e = sim_tim_ticks_at(t, t->last_ns), base = e / period * period, cand, best = ~0ULL;
+    uint32_t f = 0, ccr;
+    unsigned int c;
+
+    if (dier & TIM_DIER_UIE) {
+        best = base + period;
+        f    = TIM_SR_UIF;
+    }
+    for (c = 0; c < 4U; c++) {
+        if (!(dier & (TIM_DIER_CC1IE << c)) || sim_tim_ccs(t->inst, c) != 0U) continue;
+        ccr = *sim_tim_ccr(t->inst, c);
+        if (ccr > t->arr) continue;
+        cand = base + ccr > e ? base + ccr : base + period + ccr;
+        if (cand < best) {
+            best = cand;
+            f    = 0;
+        }
+        if (cand == best) f |= TIM_SR_CC1IF << c;
+    }
+    if (f == 0) return 0;
+    if ((dier & TIM_DIER_UIE) && best % period == 0U) f |= TIM_SR_UIF;
+    *tick  = best;
+    *flags = f;
+    return 1;
+}
+
+/**
+ * @brief   以中断方式投递定时器事件，中断服务函数改写CNT时重新对齐计数器
+ */
+static void sim_tim_raise(SIM_TIM *t, unsigned long long t_ns, uint32_t cnt, uint32_t flags)
+{
+    t->inst->CNT = t->cnt = cnt;
+    sim_tim_sr_set(t, flags);
+    if (flags & TIM_SR_UIF) sim_irq_raise(t->up_irq);
+    if ((flags & ~TIM_SR_UIF) && (t->cc_irq != t->up_irq || !(flags & TIM_SR_UIF))) sim_irq_raise(t->cc_irq);
+    sim_tim_sr_fold(t);
+    t->last_ns = t_ns;
+    t->irqs++;
+    if (sim_tim_counting(t) && t->inst->CNT != t->cnt) {
+        t->cnt = t->inst->CNT;
+        sim_tim_align(t, t_ns, t->cnt);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   红外接收头输出一个边沿：更新PB9电平，TIM4通道4按极性捕获
+ */
+static void sim_ir_edge_out(unsigned long long t_ns, uint8_t level)
+{
+    SIM_TIM *t = sim_tim_find(REMOTE_IN_TIMX);
+    TIM_TypeDef *tim = REMOTE_IN_TIMX;
+    const unsigned int c = 3U; // 通道4
+    uint32_t cnt;
+
+    sim_gpio_input(REMOTE_IN_GPIO_PORT, REMOTE_IN_GPIO_PIN, level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+    sim_tim_sync(t, t_ns);
+    if (!sim_tim_counting(t) || sim_tim_ccs(tim, c) != 1U || !(tim->CCER & (TIM_CCER_CC1E << (c * 4U)))) return;
+    if (((tim->CCER >> (c * 4U + 1U)) & 1U) != (level ? 0U : 1U)) return; // CCxP=0上升沿，1下降沿
+
+    cnt = (uint32_t)(sim_tim_ticks_at(t, t_ns) % ((unsigned long long)t->arr + 1U));
+    *sim_tim_ccr(tim, c) = cnt;
+    if (tim->DIER & (TIM_DIER_CC1IE << c)) {
+        sim_tim_raise(t, t_ns, cnt, TIM_SR_CC1IF << c);
+    } else {
+        sim_tim_sr_set(t, TIM_SR_CC1IF << c);
+    }
+}
+
+static void sim_ir_push(unsigned long long *t_ns, unsigned int low_us, unsigned int high_us)
+{
+    if (sim_ir_tail - sim_ir_head > SIM_IR_EDGES - 2U) return;
+    sim_ir_edge[sim_ir_tail++ % SIM_IR_EDGES] = (SIM_IR_EDGE){*t_ns, 0};
+    *t_ns += low_us * 1000ULL;
+    sim_ir_edge[sim_ir_tail++ % SIM_IR_EDGES] = (SIM_IR_EDGE){*t_ns, 1};
+    *t_ns += high_us * 1000ULL;
+}
+
+/**
+ * @brief   按下遥控器按键：排队一帧NEC编码（地址REMOTE_ID），按住期间每108ms一个重复码
+ * @param   key: 键值
+ * @param   hold_ms: 按住时长（ms），0为单击
+ * @retval  0: 成功，-1: 边沿队列已满
+ * @note    接收头输出空闲为高，载波期间为低；时序从上一帧结束或当前时刻开始
+ */
+int sim_ir_send(uint8_t key, unsigned int hold_ms)
+{
+    const uint32_t code = (uint32_t)REMOTE_ID | ((uint32_t)(uint8_t)~REMOTE_ID << 8) | ((uint32_t)key << 16) |
+                          ((uint32_t)(uint8_t)~key << 24);
+    unsigned long long t_ns = sim_now_ns(), frame;
+    unsigned int i, repeats = hold_ms / 108U;
+
+    if (sim_ir_tail != sim_ir_head && sim_ir_edge[(sim_ir_tail - 1U) % SIM_IR_EDGES].t_ns + 40000000ULL > t_ns) {
+        t_ns = sim_ir_edge[(sim_ir_tail - 1U) % SIM_IR_EDGES].t_ns + 40000000ULL;
+    }
+    if (SIM_IR_EDGES - (sim_ir_tail - sim_ir_head) < (34U + 2U * repeats) * 2U) return -1;
+
+    frame = t_ns;
+    sim_ir_push(&t_ns, 9000, 4500); // 引导码
+    for (i = 0; i < 32U; i++) sim_ir_push(&t_ns, 560, (code >> i) & 1U ? 1690U : 560U);
+    sim_ir_push(&t_ns, 560, 0); // 结束位
+    for (i = 0; i < repeats; i++) {
+        frame += 108000000ULL;
+        t_ns = frame;
+        sim_ir_push(&t_ns, 9000, 2250);
+        sim_ir_push(&t_ns, 560, 0);
+    }
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   投递(上次处理时刻, now]内所有定时器事件与红外边沿（仿真中断任务中调用）
+ */
+void sim_tim_poll(unsigned long long now)
+{
+    SIM_TIM *t, *next_t;
+    unsigned long long tick, t_ns, best;
+    uint32_t flags, next_flags = 0;
+    unsigned int i;
+
+    for (i = 0; i < SIM_TIM_NUM; i++) {
+        t = &sim_tims[i];
+        sim_tim_sync(t, now);
+        if (t->running && now - t->last_ns > SIM_BACKLOG_NS) t->last_ns = now - SIM_BACKLOG_NS;
+    }
+
+    sim_tim_cur_ns = now;
+    for (;;) {
+        best   = now + 1U;
+        next_t = NULL;
+        for (i = 0; i < SIM_TIM_NUM; i++) {
+            t = &sim_tims[i];
+            sim_tim_sync(t, sim_tim_cur_ns);
+            if (!t->running || !sim_tim_next(t, &tick, &flags)) continue;
+            t_ns = sim_tim_time_of(t, tick);
+            if (t_ns < best) {
+                best       = t_ns;
+                next_t     = t;
+                next_flags = flags;
+            }
+        }
+        if (sim_ir_head != sim_ir_tail && sim_ir_edge[sim_ir_head % SIM_IR_EDGES].t_ns <= now &&
+            sim_ir_edge[sim_ir_head % SIM_IR_EDGES].t_ns < best) {
+            sim_tim_cur_ns = sim_ir_edge[sim_ir_head % SIM_IR_EDGES].t_ns;
+            sim_ir_edge_out(sim_tim_cur_ns, sim_ir_edge[sim_ir_head % SIM_IR_EDGES].level);
+            sim_ir_head++;
+            continue;
+        }
+        if (next_t == NULL) break;
+        sim_tim_cur_ns = best;
+        sim_tim_raise(next_t, best,
+                      (uint32_t)(sim_tim_ticks_at(next_t, best) % ((unsigned long long)next_t->arr + 1U)),
+                      next_flags);
+    }
+
+    sim_tim_cur_ns = 0;
+
+    // 任务中读取的CNT为本次查询时刻的计数值
+    for (i = 0; i < SIM_TIM_NUM; i++) {
+        t = &sim_tims[i];
+        if (!t->running) continue;
+        t->last_ns   = now;
+        t->inst->CNT = t->cnt = (uint32_t)(sim_tim_ticks_at(t, now) % ((unsigned long long)t->arr + 1U));
+    }
+}
+
+/**
+ * @brief   打印各定时器的配置与已投递的事件数
+ */
+void sim_tim_report(void)
+{
+    unsigned int i;
+    const SIM_TIM *t;
+
+    for (i = 0; i < SIM_TIM_NUM; i++) {
+        t = &sim_tims[i];
+        fprintf(stderr, "TIM%-2u %s PSC=%-5u ARR=%-5u CNT=%-5u DIER=%04X CCER=%04X events=%lu\n",
+                t->num,
+                t->running ? "run " : "stop", (unsigned int)t->inst->PSC, (unsigned int)t->inst->ARR,
+                (unsigned int)t->inst->CNT, (unsigned int)t->inst->DIER, (unsigned int)t->inst->CCER, t->irqs);
+    }
+    fprintf(stderr, "IR edges pending=%u\n", sim_ir_tail - sim_ir_head);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* HAL替身（stm32f1xx_hal_tim.c / stm32f1xx_hal_tim_ex.c），只实现固件用到的接口 */
+static void sim_tim_base_config(TIM_HandleTypeDef *htim)
+{
+    TIM_TypeDef *tim = htim->Instance;
+
+    MODIFY_REG(tim->CR1, TIM_CR1_DIR | TIM_CR1_CMS | TIM_CR1_CKD | TIM_CR1_ARPE,
+               htim->Init.CounterMode | htim->Init.ClockDivision | htim->Init.AutoReloadPreload);
+    tim->ARR = htim->Init.Period;
+    tim->PSC = htim->Init.Prescaler;
+    if (IS_TIM_REPETITION_COUNTER_INSTANCE(tim)) tim->RCR = htim->Init.RepetitionCounter;
+    tim->CNT = 0; // EGR.UG：装载预分频器并清零计数器
+}
+
+static HAL_StatusTypeDef sim_tim_init(TIM_HandleTypeDef *htim, void (*msp)(TIM_HandleTypeDef *))
+{
+    if (htim == NULL) return HAL_ERROR;
+    if (htim->State == HAL_TIM_STATE_RESET) {
+        htim->Lock = HAL_UNLOCKED;
+        msp(htim);
+    }
+    htim->State = HAL_TIM_STATE_BUSY;
+    sim_tim_base_config(htim);
+    htim->DMABurstState = HAL_DMA_BURST_STATE_READY;
+    TIM_CHANNEL_STATE_SET_ALL(htim, HAL_TIM_CHANNEL_STATE_READY);
+    TIM_CHANNEL_N_STATE_SET_ALL(htim, HAL_TIM_CHANNEL_STATE_READY);
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+/**
+ * @brief   使能计数器；从停止到运行时以当前时刻为计数起点
+ */
+static void sim_tim_enable(TIM_HandleTypeDef *htim)
+{
+    SIM_TIM *t = sim_tim_find(htim->Instance);
+
+    if ((htim->Instance->SMCR & TIM_SMCR_SMS) == TIM_SLAVEMODE_TRIGGER) return;
+    if (!(htim->Instance->CR1 & TIM_CR1_CEN) && t != NULL) {
+        t->running = 0;
+        htim->Instance->CR1 |= TIM_CR1_CEN;
+        sim_tim_sync(t, sim_tim_cur_ns ? sim_tim_cur_ns : sim_now_ns());
+        return;
+    }
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief   所有通道的输出都关闭后停止计数器（与__HAL_TIM_DISABLE一致）
+ */
+static void sim_tim_disable(TIM_HandleTypeDef *htim)
+{
+    if ((htim->Instance->CCER & (TIM_CCER_CCxE_MASK | TIM_CCER_CCxNE_MASK)) == 0U) {
+        htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    }
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim)
+{
+    return sim_tim_init(htim, HAL_TIM_Base_MspInit);
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim)
+{
+    return sim_tim_init(htim, HAL_TIM_PWM_MspInit);
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef *htim)
+{
+    return sim_tim_init(htim, HAL_TIM_IC_MspInit);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+    if (htim->State != HAL_TIM_STATE_READY) return HAL_ERROR;
+    htim->State = HAL_TIM_STATE_BUSY;
+    sim_tim_enable(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+    if (htim->State != HAL_TIM_STATE_READY) return HAL_ERROR;
+    htim->State = HAL_TIM_STATE_BUSY;
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+    sim_tim_enable(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim)
+{
+    __HAL_TIM_DISABLE_IT(htim, TIM_IT_UPDATE);
+    sim_tim_disable(htim);
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, const TIM_ClockConfigTypeDef *sClockSourceConfig)
+{
+    htim->Instance->SMCR &= ~(TIM_SMCR_SMS | TIM_SMCR_TS | TIM_SMCR_ETF | TIM_SMCR_ETPS | TIM_SMCR_ECE | TIM_SMCR_ETP);
+    switch (sClockSourceConfig->ClockSource) {
+        case TIM_CLOCKSOURCE_INTERNAL:
+            break;
+        case TIM_CLOCKSOURCE_ITR0:
+        case TIM_CLOCKSOURCE_ITR1:
+        case TIM_CLOCKSOURCE_ITR2:
+        case TIM_CLOCKSOURCE_ITR3:
+            htim->Instance->SMCR |= sClockSourceConfig->ClockSource | SIM_TIM_SMS_EXTERNAL1;
+            break;
+        default:
+            return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_SlaveConfigSynchro(TIM_HandleTypeDef *htim, const TIM_SlaveConfigTypeDef *sSlaveConfig)
+{
+    MODIFY_REG(htim->Instance->SMCR, TIM_SMCR_TS | TIM_SMCR_SMS, sSlaveConfig->InputTrigger | sSlaveConfig->SlaveMode);
+    __HAL_TIM_DISABLE_IT(htim, TIM_IT_TRIGGER);
+    __HAL_TIM_DISABLE_DMA(htim, TIM_DMA_TRIGGER);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        const TIM_MasterConfigTypeDef *sMasterConfig)
+{
+    MODIFY_REG(htim->Instance->CR2, TIM_CR2_MMS, sMasterConfig->MasterOutputTrigger);
+    MODIFY_REG(htim->Instance->SMCR, TIM_SMCR_MSM, sMasterConfig->MasterSlaveMode);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef *htim,
+                                                const TIM_BreakDeadTimeConfigTypeDef *sBreakDeadTimeConfig)
+{
+    htim->Instance->BDTR = sBreakDeadTimeConfig->DeadTime | sBreakDeadTimeConfig->LockLevel |
+                           sBreakDeadTimeConfig->OffStateIDLEMode | sBreakDeadTimeConfig->OffStateRunMode |
+                           sBreakDeadTimeConfig->BreakState | sBreakDeadTimeConfig->BreakPolarity |
+                           sBreakDeadTimeConfig->AutomaticOutput;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, const TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    TIM_TypeDef *tim = htim->Instance;
+    __IO uint32_t *ccmr = Channel < TIM_CHANNEL_3 ? &tim->CCMR1 : &tim->CCMR2;
+    uint32_t shift      = (Channel & TIM_CHANNEL_2) ? 8U : 0U;
+
+    MODIFY_REG(*ccmr, 0xFFU << shift, (sConfig->OCMode | sConfig->OCFastMode | TIM_CCMR1_OC1PE) << shift);
+    MODIFY_REG(tim->CCER, (TIM_CCER_CC1P | TIM_CCER_CC1E) << Channel, sConfig->OCPolarity << Channel);
+    *sim_tim_ccr(tim, Channel / 4U) = sConfig->Pulse;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef *htim, const TIM_IC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    TIM_TypeDef *tim = htim->Instance;
+    __IO uint32_t *ccmr = Channel < TIM_CHANNEL_3 ? &tim->CCMR1 : &tim->CCMR2;
+    uint32_t shift      = (Channel & TIM_CHANNEL_2) ? 8U : 0U;
+
+    MODIFY_REG(*ccmr, 0xFFU << shift,
+               (sConfig->ICSelection | sConfig->ICPrescaler | ((sConfig->ICFilter << 4) & TIM_CCMR1_IC1F)) << shift);
+    MODIFY_REG(tim->CCER, (TIM_CCER_CC1P | TIM_CCER_CC1E) << Channel, sConfig->ICPolarity << Channel);
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef sim_tim_channel_start_it(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    if (TIM_CHANNEL_STATE_GET(htim, Channel) != HAL_TIM_CHANNEL_STATE_READY) return HAL_ERROR;
+    TIM_CHANNEL_STATE_SET(htim, Channel, HAL_TIM_CHANNEL_STATE_BUSY);
+    htim->Instance->DIER |= TIM_DIER_CC1IE << (Channel / 4U);
+    htim->Instance->CCER |= TIM_CCER_CC1E << Channel;
+    if (IS_TIM_BREAK_INSTANCE(htim->Instance)) __HAL_TIM_MOE_ENABLE(htim);
+    sim_tim_enable(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return sim_tim_channel_start_it(htim, Channel);
+}
+
+HAL_StatusTypeDef HAL_TIM_IC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return sim_tim_channel_start_it(htim, Channel);
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_IT(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    htim->Instance->DIER &= ~(TIM_DIER_CC1IE << (Channel / 4U));
+    htim->Instance->CCER &= ~(TIM_CCER_CC1E << Channel);
+    if (IS_TIM_BREAK_INSTANCE(htim->Instance)) __HAL_TIM_MOE_DISABLE(htim);
+    sim_tim_disable(htim);
+    TIM_CHANNEL_STATE_SET(htim, Channel, HAL_TIM_CHANNEL_STATE_READY);
+    return HAL_OK;
+}
+
+uint32_t HAL_TIM_ReadCapturedValue(const TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return *sim_tim_ccr(htim->Instance, Channel / 4U);
+}
+
+/**
+ * @brief   定时器中断公共处理（与HAL相同：先比较/捕获通道1~4，再更新事件）
+ */
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim)
+{
+    SIM_TIM *t              = sim_tim_find(htim->Instance);
+    const uint32_t itsource = htim->Instance->DIER;
+    const uint32_t itflag   = htim->Instance->SR;
+    unsigned int c;
+
+    for (c = 0; c < 4U; c++) {
+        if (!(itflag & (TIM_SR_CC1IF << c)) || !(itsource & (TIM_DIER_CC1IE << c))) continue;
+        __HAL_TIM_CLEAR_FLAG(htim, TIM_SR_CC1IF << c);
+        sim_tim_sr_fold(t);
+        htim->Channel = (HAL_TIM_ActiveChannel)(HAL_TIM_ACTIVE_CHANNEL_1 << c);
+        if (sim_tim_ccs(htim->Instance, c) != 0U) {
+            HAL_TIM_IC_CaptureCallback(htim);
+        } else {
+            HAL_TIM_OC_DelayElapsedCallback(htim);
+            HAL_TIM_PWM_PulseFinishedCallback(htim);
+        }
+        // 回调中对SR的写入（如丢弃溢出标志）在下一次写入之前并入
+        sim_tim_sr_fold(t);
+        htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+    }
+    if ((itflag & TIM_SR_UIF) && (itsource & TIM_DIER_UIE)) {
+        __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+        sim_tim_sr_fold(t);
+        HAL_TIM_PeriodElapsedCallback(htim);
+        sim_tim_sr_fold(t);
+    }
+}
+
+__weak void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+__weak void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+__weak void HAL_TIM_IC_MspInit(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+__weak void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+__weak void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+__weak void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
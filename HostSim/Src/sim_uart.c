@@ -0,0 +1,458 @@
+/**
+ * @file    sim_uart.c
+ * @brief   主机仿真层串口与DMA：HAL_UART_xxx/HAL_DMA_xxx替身，每个串口映射到一个伪终端（pty）
+ * @note    HAL_UART_Init为串口创建伪终端并在stderr打印从端路径，用串口工具打开即可收发；
+ *          设置环境变量SIM_USART1_LINK等时另外创建指向从端的符号链接。
+ *          收发按波特率限速（每字节10位）：接收字节写入环形DMA缓冲区，按半满/全满产生DMA中断，
+ *          本次没有更多数据时置IDLE并产生串口中断；发送按DMA段输出，结束后依次产生DMA传输完成与串口TC中断，
+ *          与uart_drv.c在硬件上看到的事件序列一致。没有程序读取从端时发送的数据被丢弃。
+ *          DMA通道的存储器地址保存在仿真层中（CMAR只有32位，放不下主机指针）。
+ */
+#define _GNU_SOURCE
+#include "main.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+// termios.h的输出延时宏与USART寄存器同名
+#undef CR1
+#undef CR2
+#undef CR3
+
+#include "sim.h"
+
+#define SIM_DMA_CHANNELS 7
+#define SIM_UART_NUM     2
+
+typedef struct
+{
+    DMA_HandleTypeDef *hdma;
+    uint8_t *mem;
+    uint16_t len;
+} SIM_DMA;
+
+typedef struct
+{
+    UART_HandleTypeDef *huart;
+    const char *name;
+    int fd;                       // 伪终端主端
+    int slave_fd;                 // 保持从端打开，串口工具断开后主端不会读到EIO
+    unsigned long long last_ns;
+    unsigned long long rx_credit; // 可接收/发送的时长额度（ns）
+    unsigned long long tx_credit;
+    unsigned long rx_bytes, tx_bytes, rx_dropped, tx_dropped;
+} SIM_UART;
+
+static SIM_DMA sim_dma[SIM_DMA_CHANNELS];
+static SIM_UART sim_uarts[SIM_UART_NUM];
+
+static unsigned int sim_dma_index(const DMA_HandleTypeDef *hdma)
+{
+    return (unsigned int)(hdma->ChannelIndex >> 2);
+}
+
+static IRQn_Type sim_dma_irq(unsigned int idx)
+{
+    return (IRQn_Type)(DMA1_Channel1_IRQn + (int)idx);
+}
+
+/**
+ * @brief   置DMA事件标志并产生通道中断（中断使能时）
+ */
+static void sim_dma_event(unsigned int idx, uint32_t flag, uint32_t it)
+{
+    DMA_Channel_TypeDef *ch = sim_dma[idx].hdma->Instance;
+
+    if (!(ch->CCR & it)) return;
+    DMA1->ISR |= (flag | DMA_ISR_GIF1) << (idx * 4U);
+    sim_irq_raise(sim_dma_irq(idx));
+    DMA1->ISR &= ~((flag | DMA_ISR_GIF1) << (idx * 4U));
+}
+
+/**
+ * @brief   启动DMA传输（HAL_DMA_Start_IT）
+ */
+static void sim_dma_start(DMA_HandleTypeDef *hdma, uint8_t *mem, uint16_t len)
+{
+    unsigned int idx = sim_dma_index(hdma);
+
+    hdma->State     = HAL_DMA_STATE_BUSY;
+    hdma->ErrorCode = HAL_DMA_ERROR_NONE;
+    sim_dma[idx].mem = mem;
+    sim_dma[idx].len = len;
+    hdma->Instance->CCR &= ~DMA_CCR_EN;
+    hdma->Instance->CNDTR = len;
+    hdma->Instance->CCR |= DMA_IT_TC | DMA_IT_HT | DMA_IT_TE | DMA_CCR_EN;
+}
+
+/**
+ * @brief   DMA传输了一个数据：CNDTR减1，跨过半满/全满时产生中断，循环模式重新装载
+ */
+static void sim_dma_step(unsigned int idx)
+{
+    DMA_Channel_TypeDef *ch = sim_dma[idx].hdma->Instance;
+
+    ch->CNDTR--;
+    if (ch->CNDTR == sim_dma[idx].len / 2U) sim_dma_event(idx, DMA_ISR_HTIF1, DMA_IT_HT);
+    if (ch->CNDTR == 0U) {
+        if (ch->CCR & DMA_CCR_CIRC) {
+            ch->CNDTR = sim_dma[idx].len;
+        } else {
+            ch->CCR &= ~DMA_CCR_EN;
+        }
+        sim_dma_event(idx, DMA_ISR_TCIF1, DMA_IT_TC);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* DMA替身（stm32f1xx_hal_dma.c） */
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    unsigned int idx;
+
+    if (hdma == NULL) return HAL_ERROR;
+    // 与HAL相同按通道间距换算：通道寄存器间距0x14字节，比DMA_Channel_TypeDef多一个保留字
+    idx = (unsigned int)(((uintptr_t)hdma->Instance - (uintptr_t)DMA1_Channel1) /
+                         ((uintptr_t)DMA1_Channel2 - (uintptr_t)DMA1_Channel1));
+    hdma->ChannelIndex  = idx << 2;
+    hdma->DmaBaseAddress = DMA1;
+    hdma->Instance->CCR = hdma->Init.Direction | hdma->Init.PeriphInc | hdma->Init.MemInc |
+                          hdma->Init.PeriphDataAlignment | hdma->Init.MemDataAlignment | hdma->Init.Mode |
+                          hdma->Init.Priority;
+    sim_dma[idx].hdma = hdma;
+    hdma->ErrorCode   = HAL_DMA_ERROR_NONE;
+    hdma->State       = HAL_DMA_STATE_READY;
+    hdma->Lock        = HAL_UNLOCKED;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    if (hdma == NULL) return HAL_ERROR;
+    hdma->Instance->CCR   = 0;
+    hdma->Instance->CNDTR = 0;
+    sim_dma[sim_dma_index(hdma)].mem = NULL;
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+/**
+ * @brief   DMA通道中断处理（与HAL相同：半满、传输完成，非循环模式完成后关闭中断并回到READY）
+ */
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    const uint32_t flag_it   = hdma->DmaBaseAddress->ISR >> hdma->ChannelIndex;
+    const uint32_t source_it = hdma->Instance->CCR;
+
+    if ((flag_it & DMA_ISR_HTIF1) && (source_it & DMA_IT_HT)) {
+        if (!(source_it & DMA_CCR_CIRC)) __HAL_DMA_DISABLE_IT(hdma, DMA_IT_HT);
+        if (hdma->XferHalfCpltCallback != NULL) hdma->XferHalfCpltCallback(hdma);
+    } else if ((flag_it & DMA_ISR_TCIF1) && (source_it & DMA_IT_TC)) {
+        if (!(source_it & DMA_CCR_CIRC)) {
+            __HAL_DMA_DISABLE_IT(hdma, DMA_IT_TE | DMA_IT_TC);
+            hdma->State = HAL_DMA_STATE_READY;
+        }
+        if (hdma->XferCpltCallback != NULL) hdma->XferCpltCallback(hdma);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* UART替身（stm32f1xx_hal_uart.c） */
+static SIM_UART *sim_uart_find(const UART_HandleTypeDef *huart)
+{
+    unsigned int i;
+
+    for (i = 0; i < SIM_UART_NUM; i++) {
+        if (sim_uarts[i].huart == huart) return &sim_uarts[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief   为串口创建伪终端
+ */
+void sim_uart_open(UART_HandleTypeDef *huart)
+{
+    SIM_UART *u = sim_uart_find(huart);
+    struct termios tio;
+    char env[32];
+    const char *link, *path;
+    unsigned int i;
+
+    if (u != NULL) return;
+    for (i = 0; i < SIM_UART_NUM && sim_uarts[i].huart != NULL; i++) {
+    }
+    if (i == SIM_UART_NUM) return;
+    u        = &sim_uarts[i];
+    u->huart = huart;
+    u->name  = huart->Instance == USART1 ? "USART1" : huart->Instance == USART2 ? "USART2" : "USART3";
+    u->fd    = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (u->fd < 0 || grantpt(u->fd) != 0 || unlockpt(u->fd) != 0 || (path = ptsname(u->fd)) == NULL) {
+        fprintf(stderr, "sim: %s: cannot create pty: %s\n", u->name, strerror(errno));
+        u->fd = -1;
+        return;
+    }
+    u->slave_fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (u->slave_fd >= 0 && tcgetattr(u->slave_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(u->slave_fd, TCSANOW, &tio);
+    }
+    fprintf(stderr, "sim: %s on %s\n", u->name, path);
+
+    snprintf(env, sizeof(env), "SIM_%s_LINK", u->name);
+    link = getenv(env);
+    if (link != NULL) {
+        unlink(link);
+        if (symlink(path, link) != 0) fprintf(stderr, "sim: %s: symlink %s: %s\n", u->name, link, strerror(errno));
+    }
+    u->last_ns = sim_now_ns();
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    if (huart == NULL) return HAL_ERROR;
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        huart->Lock = HAL_UNLOCKED;
+        HAL_UART_MspInit(huart);
+    }
+    huart->gState = HAL_UART_STATE_BUSY;
+    huart->Instance->CR2 = huart->Init.StopBits;
+    huart->Instance->CR3 = huart->Init.HwFlowCtl;
+    huart->Instance->BRR = (huart->Instance == USART1 ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq()) /
+                           huart->Init.BaudRate;
+    huart->Instance->CR1 = huart->Init.WordLength | huart->Init.Parity | huart->Init.Mode | USART_CR1_UE;
+    huart->Instance->SR  = USART_SR_TXE | USART_SR_TC;
+    huart->ErrorCode     = HAL_UART_ERROR_NONE;
+    huart->gState        = HAL_UART_STATE_READY;
+    huart->RxState       = HAL_UART_STATE_READY;
+    huart->RxEventType   = HAL_UART_RXEVENT_TC;
+    sim_uart_open(huart);
+    return HAL_OK;
+}
+
+static void sim_uart_dma_rx_cplt(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    if (!(hdma->Instance->CCR & DMA_CCR_CIRC)) {
+        huart->RxXferCount = 0;
+        huart->Instance->CR3 &= ~USART_CR3_DMAR;
+        huart->RxState = HAL_UART_STATE_READY;
+    }
+    HAL_UART_RxCpltCallback(huart);
+}
+
+static void sim_uart_dma_rx_half(DMA_HandleTypeDef *hdma)
+{
+    HAL_UART_RxHalfCpltCallback((UART_HandleTypeDef *)hdma->Parent);
+}
+
+static void sim_uart_dma_tx_cplt(DMA_HandleTypeDef *hdma)
+{
+    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)hdma->Parent;
+
+    // 与HAL相同：关闭DMA请求并打开TC中断，最后一个字节移出后在串口中断中结束发送
+    huart->TxXferCount = 0;
+    huart->Instance->CR3 &= ~USART_CR3_DMAT;
+    huart->Instance->CR1 |= USART_CR1_TCIE;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart->RxState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U) return HAL_ERROR;
+
+    huart->ReceptionType = HAL_UART_RECEPTION_STANDARD;
+    huart->pRxBuffPtr    = pData;
+    huart->RxXferSize    = Size;
+    huart->ErrorCode     = HAL_UART_ERROR_NONE;
+    huart->RxState       = HAL_UART_STATE_BUSY_RX;
+
+    huart->hdmarx->XferCpltCallback     = sim_uart_dma_rx_cplt;
+    huart->hdmarx->XferHalfCpltCallback = sim_uart_dma_rx_half;
+    sim_dma_start(huart->hdmarx, pData, Size);
+    huart->Instance->CR1 |= USART_CR1_PEIE;
+    huart->Instance->CR3 |= USART_CR3_EIE | USART_CR3_DMAR;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (huart->gState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U) return HAL_ERROR;
+
+    huart->pTxBuffPtr  = pData;
+    huart->TxXferSize  = Size;
+    huart->TxXferCount = Size;
+    huart->ErrorCode   = HAL_UART_ERROR_NONE;
+    huart->gState      = HAL_UART_STATE_BUSY_TX;
+
+    huart->hdmatx->XferCpltCallback     = sim_uart_dma_tx_cplt;
+    huart->hdmatx->XferHalfCpltCallback = NULL;
+    sim_dma_start(huart->hdmatx, (uint8_t *)pData, Size);
+    huart->Instance->SR &= ~USART_SR_TC;
+    huart->Instance->CR3 |= USART_CR3_DMAT;
+    return HAL_OK;
+}
+
+/**
+ * @brief   串口中断处理：只有DMA发送结束后的TC事件会走到这里（IDLE由uart_drv_irq先行处理）
+ */
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    if ((huart->Instance->SR & USART_SR_TC) && (huart->Instance->CR1 & USART_CR1_TCIE)) {
+        huart->Instance->CR1 &= ~USART_CR1_TCIE;
+        huart->gState = HAL_UART_STATE_READY;
+        HAL_UART_TxCpltCallback(huart);
+    }
+}
+
+__weak void HAL_UART_MspInit(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief   按波特率折算的字节数，并从额度中扣除
+ */
+static unsigned int sim_uart_budget(const SIM_UART *u, unsigned long long credit)
+{
+    return (unsigned int)(credit * u->huart->Init.BaudRate / 10ULL / 1000000000ULL);
+}
+
+static unsigned long long sim_uart_cost(const SIM_UART *u, unsigned int bytes)
+{
+    return (unsigned long long)bytes * 10ULL * 1000000000ULL / u->huart->Init.BaudRate;
+}
+
+static void sim_uart_rx(SIM_UART *u)
+{
+    USART_TypeDef *usart = u->huart->Instance;
+    DMA_HandleTypeDef *hdma = u->huart->hdmarx;
+    uint8_t buf[256];
+    unsigned int budget = sim_uart_budget(u, u->rx_credit), idx, i;
+    ssize_t n;
+    int got = 0;
+
+    while (budget > 0U) {
+        n = read(u->fd, buf, budget < sizeof(buf) ? budget : sizeof(buf));
+        if (n <= 0) break;
+        got = 1;
+        budget -= (unsigned int)n;
+        u->rx_credit -= sim_uart_cost(u, (unsigned int)n);
+        u->rx_bytes += (unsigned long)n;
+        for (i = 0; i < (unsigned int)n; i++) {
+            if (hdma == NULL || !(usart->CR3 & USART_CR3_DMAR) || !(hdma->Instance->CCR & DMA_CCR_EN)) {
+                u->rx_dropped++;
+                continue;
+            }
+            idx = sim_dma_index(hdma);
+            sim_dma[idx].mem[sim_dma[idx].len - hdma->Instance->CNDTR] = buf[i];
+            sim_dma_step(idx);
+        }
+    }
+    // 额度用完前没有更多数据：线路空闲
+    if (got && budget > 0U && (usart->CR1 & USART_CR1_IDLEIE)) {
+        usart->SR |= USART_SR_IDLE;
+        sim_irq_raise(u->huart->Instance == USART1 ? USART1_IRQn : USART2_IRQn);
+        usart->SR &= ~USART_SR_IDLE;
+    }
+}
+
+/**
+ * @brief   按额度输出DMA发送段；TC中断中启动的下一段在同一次查询中继续发送
+ */
+static void sim_uart_tx(SIM_UART *u)
+{
+    USART_TypeDef *usart = u->huart->Instance;
+    DMA_HandleTypeDef *hdma = u->huart->hdmatx;
+    unsigned int budget, idx, n, i;
+
+    if (hdma == NULL) return;
+    idx = sim_dma_index(hdma);
+    for (;;) {
+        if (!(usart->CR3 & USART_CR3_DMAT) || !(hdma->Instance->CCR & DMA_CCR_EN)) {
+            u->tx_credit = 0; // 空闲期间不累积额度
+            return;
+        }
+        budget = sim_uart_budget(u, u->tx_credit);
+        n      = budget < hdma->Instance->CNDTR ? budget : hdma->Instance->CNDTR;
+        if (n == 0U) return;
+
+        u->tx_credit -= sim_uart_cost(u, n);
+        if (write(u->fd, sim_dma[idx].mem + (sim_dma[idx].len - hdma->Instance->CNDTR), n) != (ssize_t)n) {
+            u->tx_dropped += n;
+        }
+        u->tx_bytes += n;
+        for (i = 0; i < n; i++) sim_dma_step(idx);
+
+        if (hdma->Instance->CNDTR != 0U) return;
+        if (usart->CR1 & USART_CR1_TCIE) {
+            usart->SR |= USART_SR_TC;
+            sim_irq_raise(u->huart->Instance == USART1 ? USART1_IRQn : USART2_IRQn);
+        }
+    }
+}
+
+/**
+ * @brief   推进各串口的收发（仿真中断任务中调用）
+ */
+void sim_uart_poll(unsigned long long now)
+{
+    unsigned int i;
+    SIM_UART *u;
+
+    for (i = 0; i < SIM_UART_NUM; i++) {
+        u = &sim_uarts[i];
+        if (u->huart == NULL || u->fd < 0) continue;
+        u->rx_credit += now - u->last_ns;
+        u->tx_credit += now - u->last_ns;
+        u->last_ns = now;
+        if (u->rx_credit > SIM_UART_BURST_NS) u->rx_credit = SIM_UART_BURST_NS;
+        if (u->tx_credit > SIM_UART_BURST_NS) u->tx_credit = SIM_UART_BURST_NS;
+        sim_uart_rx(u);
+        sim_uart_tx(u);
+    }
+}
+
+/**
+ * @brief   打印各串口的收发统计
+ */
+void sim_uart_report(void)
+{
+    unsigned int i;
+    const SIM_UART *u;
+
+    for (i = 0; i < SIM_UART_NUM; i++) {
+        u = &sim_uarts[i];
+        if (u->huart == NULL) continue;
+        fprintf(stderr, "%s %s rx=%lu (dropped %lu) tx=%lu (dropped %lu)\n", u->name,
+                u->fd >= 0 ? ptsname(u->fd) : "-", u->rx_bytes, u->rx_dropped, u->tx_bytes, u->tx_dropped);
+    }
+}
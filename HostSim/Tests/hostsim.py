@@ -0,0 +1,117 @@
+"""Helpers for the host simulation tests (run by CTest, see HostSim/CMakeLists.txt).
+
+HostSim starts the simulation binary with its serial ports linked into a temporary
+directory, feeds the stdin console and collects the "sim: ..." lines from stderr.
+port() returns the host end of a simulated serial port (uart_mock.UartMock).
+"""
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+from uart_mock import UartMock
+
+SKIP = 77  # CTest SKIP_RETURN_CODE
+
+
+def fail(msg):
+    print("FAIL: " + msg)
+    sys.exit(1)
+
+
+def skip(msg):
+    print("SKIP: " + msg)
+    sys.exit(SKIP)
+
+
+class HostSim:
+    """The simulation process; use as a context manager."""
+
+    PORTS = ("USART1", "USART2")
+
+    def __init__(self, exe, env=None):
+        self.dir = tempfile.mkdtemp(prefix="hostsim-")
+        full = dict(os.environ)
+        for name in self.PORTS:
+            full["SIM_%s_LINK" % name] = os.path.join(self.dir, name)
+        full.update(env or {})
+        self.proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.DEVNULL,
+                                     stderr=subprocess.PIPE, env=full)
+        self.lines = []
+        self.cond = threading.Condition()
+        threading.Thread(target=self._stderr, daemon=True).start()
+        self.expect(r"sim: host simulation started", 5.0)
+        self.ports = {}
+        # 固件初始化完成后命令口才开始接收
+        time.sleep(1.0)
+
+    def _stderr(self):
+        for raw in self.proc.stderr:
+            with self.cond:
+                self.lines.append(raw.decode("utf-8", "replace").rstrip("\n"))
+                self.cond.notify_all()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def link(self, name="USART1"):
+        """Path of the port's pseudo terminal link (for tools that open it themselves)."""
+        return os.path.join(self.dir, name)
+
+    def port(self, name="USART1"):
+        if name not in self.ports:
+            self.ports[name] = UartMock(self.link(name))
+        return self.ports[name]
+
+    def console(self, line):
+        self.proc.stdin.write(line.encode("ascii") + b"\n")
+        self.proc.stdin.flush()
+
+    def expect(self, pattern, timeout=5.0, start=0):
+        """First stderr line from index start matching pattern (re.search), fail on timeout."""
+        rx = re.compile(pattern)
+        end = time.monotonic() + timeout
+        with self.cond:
+            while True:
+                for line in self.lines[start:]:
+                    m = rx.search(line)
+                    if m:
+                        return m
+                left = end - time.monotonic()
+                if left <= 0 or self.proc.poll() is not None:
+                    fail("stderr did not show /%s/" % pattern)
+                self.cond.wait(left)
+
+    def mark(self):
+        """Index for expect(start=...) so only later stderr lines are searched."""
+        with self.cond:
+            return len(self.lines)
+
+    def close(self):
+        for p in self.ports.values():
+            p.close()
+        if self.proc.poll() is None:
+            try:
+                self.console("quit")
+                self.proc.wait(timeout=5)
+            except (BrokenPipeError, subprocess.TimeoutExpired):
+                self.proc.kill()
+                self.proc.wait()
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+
+def find(lines, pattern):
+    """First match of pattern in the reply lines, fail if none."""
+    rx = re.compile(pattern)
+    for line in lines:
+        m = rx.search(line)
+        if m:
+            return m
+    fail("reply did not show /%s/:\n  %s" % (pattern, "\n  ".join(lines)))
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Beeper timing: the 1 s cycle timer and the tone length show up in PERIODS.
+
+BEEP_ON200 sounds the beeper for 200 ms at the start of every 1 s cycle. The "beep" row
+of PERIODS then counts one cycle per second, its exec (cycle start to tone off) must stay
+within BEEP_DEADLINE_MS (20 ms) of 200 ms with no deadline miss, and the drift of the
+cycle timer must stay under 10 ms.
+"""
+import sys
+import time
+
+from hostsim import HostSim, fail, find
+
+TONE_MS = 200
+RUN_S = 4.5
+
+
+def main():
+    with HostSim(sys.argv[1]) as sim:
+        uart = sim.port()
+        find(uart.command("BEEP_ON%d" % TONE_MS), r"Now BEEP ON")
+        time.sleep(RUN_S)
+        lines = uart.command("PERIODS")
+        find(uart.command("BEEP_OFF"), r"Now BEEP OFF")
+        m = find(lines, r"beep\s+T=1000000 D=(\d+) n=(\d+) jit=(\d+) drift=(-?\d+) exec=(\d+)/(\d+)/(\d+) "
+                        r"resp=(\d+) miss=(\d+)")
+        deadline, n, jit, drift, ex_min, ex_avg, ex_max, resp, miss = (int(v) for v in m.groups())
+        if deadline != (TONE_MS + 20) * 1000 or n < int(RUN_S) - 1 or miss:
+            fail("beep row: %s" % m.group(0))
+        if ex_min < TONE_MS * 1000 - 2000 or ex_max > (TONE_MS + 20) * 1000 or abs(drift) > 10000:
+            fail("tone %u..%u us, drift %d us: %s" % (ex_min, ex_max, drift, m.group(0)))
+        print("beep: %d cycles, tone %d/%d/%d us, jit=%dus drift=%dus" % (n, ex_min, ex_avg, ex_max, jit, drift))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+"""Event journal: boot, command and mode-change records appear in JOURNAL.
+
+"ir 64" (PLAY) switches the robot from NULL to Move mode, "ir 22" (key 1) then to Motor1;
+both must show up as JOURNAL_MODE records in order, after the boot record and the
+JOURNAL_CLEAR command that emptied the log.
+"""
+import sys
+import time
+
+from hostsim import HostSim, fail, find
+
+
+def main():
+    with HostSim(sys.argv[1]) as sim:
+        uart = sim.port()
+        lines = uart.command("JOURNAL")
+        find(lines, r"JOURNAL boots=1 retained=0")
+        find(lines, r"boot\s+retained=0")
+
+        find(uart.command("JOURNAL_CLEAR"), r"JOURNAL CLEAR")
+        sim.console("ir 64")
+        time.sleep(0.5)
+        sim.console("ir 22")
+        time.sleep(0.5)
+        lines = uart.command("JOURNAL")
+        find(lines, r'cmd\s+len=7 "JOUR\.\.\."')
+        modes = [l.split("mode", 1)[1].strip() for l in lines if " mode " in l]
+        if modes != ["null -> move", "move -> motor1"]:
+            fail("mode records %s:\n  %s" % (modes, "\n  ".join(lines)))
+        print("journal: %s" % ", ".join(modes))
+
+
+if __name__ == "__main__":
+    main()
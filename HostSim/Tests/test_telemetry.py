@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Telemetry stream: frames go to USART2, the sample rate is exact when hz does not divide 1000.
+
+TELEM_ON150 is sent on USART1; the binary frames must arrive on USART2 (none on the command
+port) and decode with Tools/telemetry_decode.py without checksum errors or sequence gaps.
+150 Hz is a 6.67 ms period: the schedule alternates 6 and 7 ms ticks, so TELEM_STAT must count
+150 samples per second (a truncated 6 ms period would give 167) and the frame timestamps
+must all lie on one base_tick + n*1000/hz grid.
+"""
+import os
+import sys
+import time
+
+from hostsim import HostSim, fail, find
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "Tools"))
+from telemetry_decode import SYNC, Decoder  # noqa: E402
+
+HZ = 150
+RUN_S = 4.0
+
+
+def main():
+    with HostSim(sys.argv[1]) as sim:
+        cmd, tel = sim.port("USART1"), sim.port("USART2")
+        find(cmd.command("TELEM_ON%d" % HZ, idle=0.05), r"Now TELEM %dHz" % HZ)
+        t0 = time.monotonic()
+        dec, frames = Decoder(), []
+        while time.monotonic() - t0 < RUN_S:
+            frames += dec.feed(tel.read(0.1))
+        elapsed = time.monotonic() - t0
+        lines = cmd.command("TELEM_STAT")
+        cmd.command("TELEM_OFF")
+        if SYNC in cmd.buf:
+            fail("telemetry frames on the command port")
+
+        if len(frames) < 2 or dec.bad or dec.lost:
+            fail("USART2: %d frames, bad=%d lost=%d" % (len(frames), dec.bad, dec.lost))
+        # 帧时刻都应落在 base + n*1000/hz 网格上（网格以1秒为周期，base在第一帧之前一个周期内）
+        grid = {(n * 1000) // HZ for n in range(HZ)}
+        ticks = [tick for tick, _, _, _ in frames]
+        if not any(all((t - base) % 1000 in grid for t in ticks) for base in range(ticks[0] - 7, ticks[0] + 1)):
+            fail("frame ticks %s are not on a 1000/%d ms grid" % (ticks, HZ))
+
+        m = find(lines, r"TELEM samples=(\d+) busy=\d+ same=\d+ jit_max=(\d+)us jit_avg=(\d+)us")
+        rate = int(m.group(1)) / elapsed
+        if abs(rate - HZ) > HZ * 0.03:
+            fail("%.1f samples/s at TELEM_ON%d:\n  %s" % (rate, HZ, "\n  ".join(lines)))
+        print("telemetry %dHz: %d frames on USART2, %.1f samples/s, jit_max=%sus jit_avg=%sus" %
+              (HZ, len(frames), rate, m.group(2), m.group(3)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Time service soak: the TIM2->TIM3 second tick and the scheduler tick do not drift under load.
+
+Load: the robot control loop runs (Motor1 selected, direction key held) and USART1 is kept
+busy with pipelined commands. Between load bursts a lone TIME command is sampled:
+  clock drift = (up - up0) - (host time - host time0), within BOUND_MS plus the reply latency
+  tick drift  = tick_err - tick_err0, within BOUND_MS
+At the end PERIODS must show the 1 Hz refresh ("clock") with |drift| under BOUND_MS and no
+deadline miss, and TIME lost=0.
+
+Run long soaks on an otherwise idle host: the simulation runs in host time, so a host stall
+longer than the 100 ms refresh deadline shows up as a late refresh and a PERIODS miss.
+Default run is 20 s; set HOSTSIM_SOAK_S for a long soak, e.g.
+    HOSTSIM_SOAK_S=10800 python3 HostSim/Tests/test_time_soak.py build/host-sim/HostSim/FreeRTOSSTM32ZET6
+"""
+import os
+import re
+import sys
+import time
+
+from hostsim import HostSim, fail, find
+
+BOUND_MS = 10
+# 只用单行应答的命令，且不含TIME：每条恰好一行应答，采样读到的一定是自己那条TIME的应答
+LOAD = ["FLOW", "HEAP", "LED_ON", "DELAY", "LED_OFF", "CTRL", "WAKE", "SLEEP"]
+WINDOW = 8
+
+
+def sample(uart):
+    t0 = time.monotonic()
+    m = find(uart.command("TIME", idle=0.05), r"up=(\d+)\.(\d+)s tick_err=(-?\d+)us lost=(\d+)")
+    t1 = time.monotonic()
+    return t0, t1 - t0, int(m.group(1)) + int(m.group(2)) / 1e6, int(m.group(3)), int(m.group(4))
+
+
+def stall(sim, uart, sent, acked):
+    """A load reply did not come: fail with what the firmware and the simulation saw."""
+    late = uart.drain()
+    flow = uart.command("FLOW") + uart.command("UART_STAT")
+    fail("no reply to a load command within 5s (%d sent, %d answered, %d late)\n  %s\n  %s" %
+         (sent, acked, len(late), "\n  ".join(late + flow), "\n  ".join(sim.lines[-10:])))
+
+
+def reply(sim, uart, sent, acked):
+    """One reply line ("!" reports do not count)."""
+    line = uart.readline(5.0)
+    if line is None:
+        stall(sim, uart, sent, acked)
+    return 0 if line.startswith("!") else 1
+
+
+def burst(sim, uart, n):
+    """n pipelined commands, at most WINDOW unanswered; returns after all n replies arrived."""
+    acked = 0
+    for sent in range(n):
+        uart.write((LOAD[sent % len(LOAD)] + "\r\n").encode("ascii"))
+        while sent + 1 - acked >= WINDOW:
+            acked += reply(sim, uart, sent + 1, acked)
+    while acked < n:
+        acked += reply(sim, uart, n, acked)
+
+
+def main():
+    duration = float(os.environ.get("HOSTSIM_SOAK_S", "20"))
+    with HostSim(sys.argv[1]) as sim:
+        uart = sim.port()
+        h0, _, up0, err0, _ = sample(uart)
+        end = h0 + duration
+        worst_clock = worst_tick = 0.0
+        samples = 0
+        next_key = 0.0
+        while time.monotonic() < end:
+            now = time.monotonic()
+            if now >= next_key:
+                # 选中电机1并按住方向键，机械臂控制周期保持运行
+                sim.console("ir 22")
+                sim.console("ir 68 1500")
+                next_key = now + 2.0
+            burst(sim, uart, 64)
+            h, lat, up, err, lost = sample(uart)
+            clock = (up - up0) - (h - h0)
+            tick = (err - err0) / 1e6
+            samples += 1
+            worst_clock = max(worst_clock, abs(clock))
+            worst_tick = max(worst_tick, abs(tick))
+            if abs(clock) > BOUND_MS / 1e3 + lat:
+                fail("clock drift %.1fms at %.0fs (reply latency %.1fms)" % (clock * 1e3, h - h0, lat * 1e3))
+            if abs(tick) > BOUND_MS / 1e3:
+                fail("tick drift %.1fms at %.0fs" % (tick * 1e3, h - h0))
+            if lost:
+                fail("%d second refreshes lost" % lost)
+
+        lines = uart.command("PERIODS")
+        m = find(lines, r"clock\s+T=\d+ D=\d+ n=(\d+) jit=\d+ drift=(-?\d+) .* miss=(\d+)")
+        if abs(int(m.group(2))) > BOUND_MS * 1000 or int(m.group(3)) != 0:
+            fail("clock refresh drifted or missed its deadline:\n  " + "\n  ".join(lines))
+        print("soak %.0fs: %d samples, worst clock drift %.2fms, worst tick drift %.2fms, refresh n=%s drift=%sus" %
+              (duration, samples, worst_clock * 1e3, worst_tick * 1e3, m.group(1), m.group(2)))
+
+
+if __name__ == "__main__":
+    main()
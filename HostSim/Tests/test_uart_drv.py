@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""UART driver: per-port counters match what the host mock saw on both links.
+
+USART1 (command port): between two UART_STAT snapshots the driver's rx/tx byte counters
+must grow by exactly the bytes the mock wrote/read, and the receive latency is reported.
+USART2 (secondary port): the BENCH uart_write/uart_printf cases write to it; the mock on
+the USART2 link must receive every byte, intact, and the driver's tx counter must agree.
+"""
+import re
+import sys
+
+from hostsim import HostSim, fail, find
+
+STAT = r"%s rx=(\d+) tx=(\d+) ovr=(\d+) err=(\d+) drop=(\d+) lat=(\d+)/(\d+)us"
+CMDS = ["LED_ON", "LED_OFF", "TIME", "HEAP", "LED_AUTO", "XYZ"] * 10
+
+
+def stat(lines, name):
+    return [int(x) for x in find(lines, STAT % name).groups()]
+
+
+def main():
+    with HostSim(sys.argv[1]) as sim:
+        uart1, uart2 = sim.port("USART1"), sim.port("USART2")
+        uart1.drain()
+
+        rx0, tx0 = uart1.rx_bytes, uart1.tx_bytes
+        a = uart1.command("UART_STAT")
+        tx_a = uart1.tx_bytes
+        for cmd in CMDS:
+            uart1.command(cmd, idle=0.02)
+        rx1 = uart1.rx_bytes
+        b = uart1.command("UART_STAT")
+        s1a, s1b = stat(a, "USART1"), stat(b, "USART1")
+        if s1b[0] - s1a[0] != uart1.tx_bytes - tx_a:
+            fail("USART1 rx grew by %d, mock wrote %d" % (s1b[0] - s1a[0], uart1.tx_bytes - tx_a))
+        if s1b[1] - s1a[1] != rx1 - rx0:
+            fail("USART1 tx grew by %d, mock read %d" % (s1b[1] - s1a[1], rx1 - rx0))
+        if any(s1b[2:5]) or s1b[5] == 0:
+            fail("USART1 errors or no latency samples: %s" % b[0])
+
+        s2a = stat(b, "USART2")
+        lines = uart1.command("BENCH uart_write")
+        lines += uart1.command("BENCH uart_printf")
+        find(lines, r"uart_write\s+n=\d+")
+        got = uart2.drain(0.5)
+        s2b = stat(uart1.command("UART_STAT"), "USART2")
+        if s2b[1] - s2a[1] != uart2.rx_bytes:
+            fail("USART2 tx grew by %d, mock read %d" % (s2b[1] - s2a[1], uart2.rx_bytes))
+        bad = [l for l in got if not re.match(r"BENCH uart_drv$|CTRL n=123456 lat=3/5/17 us$", l)]
+        if not got or bad or any(s2b[2:5]):
+            fail("USART2 received %d lines, %d corrupted %s, stat %s" % (len(got), len(bad), bad[:3], s2b))
+
+        lat = sorted(uart1.lat)
+        print("uart: USART1 %d cmds rx=%d tx=%d bytes, reply latency p50=%.1fms max=%.1fms; USART2 %d lines %d bytes"
+              % (len(CMDS), s1b[0] - s1a[0], s1b[1] - s1a[1], lat[len(lat) // 2] * 1e3, lat[-1] * 1e3,
+                 len(got), uart2.rx_bytes))
+
+
+if __name__ == "__main__":
+    main()
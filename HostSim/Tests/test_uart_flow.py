@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Credit flow control: Tools/uart_stream.py streams a long script into the simulated USART1 without loss.
+
+A 4000-command script (window 16) must get exactly one reply per command, and afterwards FLOW
+must show ovr/err/drop/trunc at zero with rx grown by exactly the script's bytes, and UART_STAT
+must show no USART1 overrun or error. As a control, the same commands blasted without a window
+must overflow the command queue (FLOW drop or ovr non-zero), otherwise the test proves nothing.
+The tool's MULTI_LINE / MULTI_LINE_PREFIX must list exactly the commands marked as multi-line
+replies in the command table of Core/Src/user/mytask.c.
+"""
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+from hostsim import HostSim, fail, find, skip
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+TOOL = os.path.join(ROOT, "Tools", "uart_stream.py")
+SCRIPT = ("LED_ON", "LED_OFF", "DELAY", "LED_AUTO", "TIME", "HEAP", "FLOW")
+COUNT = 4000
+BLAST = 300
+
+
+def flow(uart):
+    m = find(uart.command("FLOW"), r"rx=(\d+) ovr=(\d+) err=(\d+) drop=(\d+) trunc=(\d+)")
+    return [int(v) for v in m.groups()]
+
+
+def check_multi_line():
+    """Multi-line commands in the mytask.c table ("BENCH[name]" is a prefix) against the tool's lists."""
+    sys.path.insert(0, os.path.dirname(TOOL))
+    import uart_stream
+    table, prefix = set(), set()
+    with open(os.path.join(ROOT, "Core", "Src", "user", "mytask.c"), encoding="utf-8") as f:
+        for m in re.finditer(r"^ \*\s+\| (\w+)(\[\w+\])?\s+\|.*多行应答", f.read(), re.M):
+            (prefix if m.group(2) else table).add(m.group(1))
+    if table != set(uart_stream.MULTI_LINE) or prefix != set(uart_stream.MULTI_LINE_PREFIX):
+        fail("uart_stream.py MULTI_LINE %s / PREFIX %s, mytask.c table %s / %s" %
+             (sorted(uart_stream.MULTI_LINE), sorted(uart_stream.MULTI_LINE_PREFIX), sorted(table), sorted(prefix)))
+
+
+def main():
+    check_multi_line()
+    try:
+        import serial  # noqa: F401 (pyserial, used by the tool)
+    except ImportError:
+        skip("pyserial not installed")
+    cmds = [SCRIPT[i % len(SCRIPT)] for i in range(COUNT)]
+    with tempfile.NamedTemporaryFile("w", suffix=".txt", delete=False) as f:
+        f.write("# test_uart_flow\n" + "\n".join(cmds) + "\n")
+    try:
+        with HostSim(sys.argv[1]) as sim:
+            uart = sim.port()
+            rx0 = flow(uart)[0]
+            r = subprocess.run([sys.executable, TOOL, "--port", sim.link(), "--window", "16", f.name],
+                               stdout=subprocess.PIPE, timeout=90)
+            replies = r.stdout.decode("ascii", "replace").splitlines()
+            if r.returncode != 0:
+                fail("uart_stream.py exited with %d after %d replies" % (r.returncode, len(replies)))
+            if len(replies) != COUNT:
+                fail("%d replies to %d commands" % (len(replies), COUNT))
+
+            rx, ovr, err, drop, trunc = flow(uart)
+            # 两次FLOW之间收到的字节：脚本命令加上第一条FLOW自身
+            want = sum(len(c) + 2 for c in cmds) + len("FLOW\r\n")
+            if (ovr, err, drop, trunc) != (0, 0, 0, 0) or rx - rx0 != want:
+                fail("streamed: rx=%d (want %d) ovr=%d err=%d drop=%d trunc=%d" % (rx - rx0, want, ovr, err, drop,
+                                                                                  trunc))
+            m = find(uart.command("UART_STAT"), r"USART1 rx=\d+ tx=\d+ ovr=(\d+) err=(\d+)")
+            if m.groups() != ("0", "0"):
+                fail("UART_STAT USART1 ovr=%s err=%s" % m.groups())
+            print("streamed %d commands, FLOW rx=%d ovr=0 err=0 drop=0 trunc=0" % (COUNT, rx - rx0))
+
+            # 对照：不做流控一次写入，命令队列必然溢出
+            uart.write(b"".join(b"LED_ON\r\n" for _ in range(BLAST)))
+            time.sleep(0.5)
+            got = len(uart.drain(1.0))
+            _, ovr2, _, drop2, _ = flow(uart)
+            if ovr2 + drop2 == 0 or got >= BLAST:
+                fail("control: %d commands without a window lost nothing (replies=%d)" % (BLAST, got))
+            print("control: %d commands without a window, %d replies, ovr=%d drop=%d" % (BLAST, got, ovr2, drop2))
+    finally:
+        os.unlink(f.name)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+"""Command pipeline stress: Tools/uart_stress.py against the simulated USART1 at 115200 baud.
+
+5000 pipelined commands (window 16) must all be answered in order with FLOW counters at zero,
+at no less than 500 commands per second. The sim paces both directions at the configured
+baud rate, so the rate is bounded by the line like on the board.
+"""
+import os
+import subprocess
+import sys
+
+from hostsim import HostSim, fail, skip
+
+TOOL = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "Tools", "uart_stress.py")
+
+
+def main():
+    try:
+        import serial  # noqa: F401 (pyserial, used by the tool)
+    except ImportError:
+        skip("pyserial not installed")
+    with HostSim(sys.argv[1]) as sim:
+        r = subprocess.run([sys.executable, TOOL, "--port", sim.link(), "--count", "5000", "--window", "16",
+                            "--min-rate", "500"], timeout=60)
+        if r.returncode != 0:
+            fail("uart_stress.py exited with %d" % r.returncode)
+
+
+if __name__ == "__main__":
+    main()
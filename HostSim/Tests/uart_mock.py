@@ -0,0 +1,85 @@
+"""Host-side mock of the peer on a simulated serial port (the PC or companion board end).
+
+UartMock opens one of HostSim's USART pseudo terminals raw and plays the far end of the
+link: it writes commands or raw bytes, splits what the firmware sends into lines and keeps
+its own counters, so tests can check the firmware's per-port UART_STAT counters against
+what actually crossed the link:
+    tx_bytes  bytes written to the firmware
+    rx_bytes  bytes received from the firmware
+    lat       seconds from writing each command() to its first reply line
+"""
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+
+class UartMock:
+    def __init__(self, path):
+        self.path = path
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        tty.setraw(self.fd)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.buf = bytearray()
+        self.tx_bytes = 0
+        self.rx_bytes = 0
+        self.lat = []
+
+    def close(self):
+        os.close(self.fd)
+
+    def write(self, data):
+        view = memoryview(data)
+        while view:
+            select.select([], [self.fd], [], 1.0)
+            try:
+                n = os.write(self.fd, view)
+            except BlockingIOError:
+                continue
+            self.tx_bytes += n
+            view = view[n:]
+
+    def read(self, timeout):
+        """Bytes received within timeout seconds (at least one read attempt)."""
+        if select.select([self.fd], [], [], timeout)[0]:
+            try:
+                data = os.read(self.fd, 65536)
+            except (BlockingIOError, OSError):
+                return b""
+            self.rx_bytes += len(data)
+            return data
+        return b""
+
+    def readline(self, timeout=2.0):
+        """One "\\r\\n"-terminated line without the terminator, None on timeout."""
+        end = time.monotonic() + timeout
+        while b"\r\n" not in self.buf:
+            left = end - time.monotonic()
+            if left <= 0:
+                return None
+            self.buf += self.read(left)
+        line, _, rest = bytes(self.buf).partition(b"\r\n")
+        self.buf = bytearray(rest)
+        return line.decode("ascii", "replace")
+
+    def drain(self, idle=0.3):
+        """All lines received until the port stays idle for idle seconds."""
+        lines = []
+        line = self.readline(idle)
+        while line is not None:
+            lines.append(line)
+            line = self.readline(idle)
+        return lines
+
+    def command(self, cmd, idle=0.3, timeout=5.0):
+        """Send one command and return all reply lines until the port stays idle."""
+        t0 = time.monotonic()
+        self.write(cmd.encode("ascii") + b"\r\n")
+        first = self.readline(timeout)
+        if first is None:
+            print("FAIL: no reply to %s on %s" % (cmd, os.path.basename(self.path)))
+            sys.exit(1)
+        self.lat.append(time.monotonic() - t0)
+        return [first] + self.drain(idle)
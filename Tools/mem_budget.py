@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Per-subsystem flash/RAM budget from a linker map file.
+
+Usage:
+    mem_budget.py MDK-ARM/FreeRTOSSTM32ZET6.map                     # Keil armlink map
+    mem_budget.py build/Debug/FreeRTOSSTM32ZET6.map                 # GNU ld map (CMake build)
+    mem_budget.py app.map --top 20                                  # also list the 20 largest RAM symbols
+
+Flash = code + read-only data + RW init data, RAM = RW data + zero-initialised data.
+Objects are grouped into subsystems by their source path (see SUBSYSTEMS); the
+largest RAM symbols show which buffers and task stacks are worth shrinking.
+Keil runs this after every build (Options -> User -> After Build/Rebuild).
+"""
+import argparse
+import os
+import re
+import sys
+
+FLASH_SIZE = 512 * 1024  # STM32F103ZET6
+RAM_SIZE = 64 * 1024
+
+# (subsystem, matcher) in priority order; the matcher sees the source path
+# relative to the repo root with '/' separators, or the bare object name when
+# the source is not in the tree (libraries, linker-generated code).
+SUBSYSTEMS = [
+    ("HAL", lambda p: p.startswith("Drivers/")),
+    ("CMSIS-RTOS2", lambda p: "CMSIS_RTOS_V2/" in p),
+    ("FreeRTOS heap", lambda p: "MemMang/" in p),
+    ("FreeRTOS", lambda p: p.startswith("Middlewares/Third_Party/FreeRTOS/")),
+    ("LCD", lambda p: re.search(r"/lcd\w*\.c$", p) is not None),
+    ("UART", lambda p: re.search(r"/(uart_drv|myprintf|myformat)\.c$", p) is not None),
+    ("Telemetry", lambda p: p.endswith("/telemetry.c")),
+    ("Message pools", lambda p: p.endswith("/mem_pool.c")),
+    ("Stats/power", lambda p: re.search(r"/(cpu_stats|power|trace|latency)\.c$", p) is not None),
+    ("App", lambda p: p.startswith("Core/Src/user/")),
+    ("RTOS objects", lambda p: p.endswith("Core/Src/freertos.c")),
+    ("CubeMX init", lambda p: p.startswith("Core/Src/")),
+    ("Startup", lambda p: "startup_" in p),
+]
+OTHER = "C library/other"
+
+
+def source_index(root):
+    """Map object base name (main.o) to the source path relative to root."""
+    index = {}
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames[:] = [d for d in dirnames if not d.startswith(".") and d not in ("build", "_gate_build")]
+        for name in filenames:
+            base, ext = os.path.splitext(name)
+            if ext.lower() in (".c", ".s"):
+                rel = os.path.relpath(os.path.join(dirpath, name), root).replace(os.sep, "/")
+                index.setdefault(base.lower() + ".o", rel)
+    return index
+
+
+def classify(path):
+    for name, match in SUBSYSTEMS:
+        if match(path):
+            return name
+    return OTHER
+
+
+NUM6 = re.compile(r"^\s*(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\S.*?)\s*$")
+
+
+def parse_keil(lines, index):
+    """armlink 'Image component sizes' table: Code (inc. data) RO RW ZI Debug Name."""
+    objs = {}
+    section = None
+    for line in lines:
+        if "Object Name" in line:
+            section = "obj"
+            continue
+        if "Library Member Name" in line:
+            section = "lib"
+            continue
+        if "Library Name" in line or "Grand Totals" in line:
+            if section == "lib":
+                break
+            continue
+        if section is None:
+            continue
+        m = NUM6.match(line)
+        if not m:
+            continue
+        name = m.group(7)
+        if name.startswith("(") or "Totals" in name:
+            continue
+        code, _, ro, rw, zi = (int(m.group(i)) for i in range(1, 6))
+        path = index.get(name.lower(), name) if section == "obj" else "lib/" + name
+        acc = objs.setdefault(path, [0, 0])
+        acc[0] += code + ro + rw
+        acc[1] += rw + zi
+    return objs
+
+
+def parse_keil_symbols(lines):
+    """Largest RAM symbols from the 'Image Symbol Table' (Data/Zero in 0x2000xxxx)."""
+    sym = re.compile(r"^\s+(\S+)\s+0x(2[0-9a-fA-F]{7})\s+Data\s+(\d+)\s+(\S+)")
+    out = {}
+    for line in lines:
+        m = sym.match(line)
+        if m and int(m.group(3)) > 0:
+            out[m.group(1)] = (int(m.group(3)), m.group(4))
+    return out
+
+
+GNU_SEC = re.compile(r"^ (\.\S+|COMMON)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*))?$")
+GNU_CONT = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+
+
+def gnu_input_sections(lines):
+    """Yield (section, address, size, object) for each input section of a GNU ld map.
+
+    Long section names are printed on their own line with address/size/object on the next one.
+    """
+    started = False
+    pending = None
+    for line in lines:
+        if line.startswith("Linker script and memory map"):
+            started = True
+            continue
+        if not started:
+            continue
+        m = GNU_SEC.match(line)
+        if m:
+            pending = None
+            if m.group(2) is None:
+                pending = m.group(1)
+            else:
+                yield m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4)
+            continue
+        if pending:
+            c = GNU_CONT.match(line)
+            if c:
+                yield pending, int(c.group(1), 16), int(c.group(2), 16), c.group(3)
+            pending = None
+
+
+def parse_gnu(lines):
+    """GNU ld map: sum input sections per object, RAM symbols from -fdata-sections names."""
+    objs, syms = {}, {}
+    for sec, addr, size, obj in gnu_input_sections(lines):
+        if size == 0 or sec.startswith((".debug", ".comment", ".ARM.attributes")):
+            continue
+        path = obj.replace("\\", "/")
+        if ".dir/" in path:
+            # CMakeFiles/<target>.dir/../../Core/Src/main.c.obj
+            path = re.sub(r"^(\.\./)+", "", path.split(".dir/", 1)[1])
+            path = re.sub(r"\.(obj|o)$", "", path)
+        elif path.endswith(")"):
+            path = "lib/" + os.path.basename(path)
+        acc = objs.setdefault(path, [0, 0])
+        in_ram = 0x20000000 <= addr < 0x40000000
+        if sec.startswith(".data"):
+            acc[0] += size  # load image in flash, copied to RAM at startup
+            acc[1] += size
+        elif in_ram:
+            acc[1] += size
+        else:
+            acc[0] += size
+        if in_ram:
+            parts = sec.split(".")
+            name = parts[-1] if len(parts) > 2 else sec
+            syms[name] = (size, os.path.basename(path))
+    return objs, syms
+
+
+def report(objs, syms, top):
+    groups = {}
+    for path, (flash, ram) in objs.items():
+        g = groups.setdefault(classify(path), [0, 0, 0])
+        g[0] += flash
+        g[1] += ram
+        g[2] += 1
+    total_flash = sum(g[0] for g in groups.values())
+    total_ram = sum(g[1] for g in groups.values())
+
+    print("%-18s %4s %9s %6s %9s %6s" % ("Subsystem", "Objs", "Flash", "%", "RAM", "%"))
+    print("-" * 57)
+    for name, (flash, ram, n) in sorted(groups.items(), key=lambda kv: -kv[1][1]):
+        print("%-18s %4d %9d %5.1f%% %9d %5.1f%%" % (name, n, flash, 100.0 * flash / max(total_flash, 1),
+                                                     ram, 100.0 * ram / max(total_ram, 1)))
+    print("-" * 57)
+    print("%-18s %4d %9d %5.1f%% %9d %5.1f%%  (of device)" % ("Total", len(objs), total_flash,
+                                                              100.0 * total_flash / FLASH_SIZE, total_ram,
+                                                              100.0 * total_ram / RAM_SIZE))
+    print("%-18s %4s %9d %6s %9d" % ("Free", "", FLASH_SIZE - total_flash, "", RAM_SIZE - total_ram))
+
+    if top and syms:
+        print()
+        print("Largest RAM symbols:")
+        for name, (size, obj) in sorted(syms.items(), key=lambda kv: -kv[1][0])[:top]:
+            print("  %7d  %-32s %s" % (size, name, obj))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("map", help="linker map file (Keil armlink or GNU ld)")
+    ap.add_argument("--root", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."),
+                    help="repository root used to locate object sources")
+    ap.add_argument("--top", type=int, default=10, help="number of largest RAM symbols to list (0 = none)")
+    args = ap.parse_args()
+
+    with open(args.map, encoding="latin-1") as f:
+        lines = f.read().splitlines()
+
+    if any("Image component sizes" in line for line in lines):
+        objs = parse_keil(lines, source_index(args.root))
+        syms = parse_keil_symbols(lines)
+    elif any(line.startswith("Linker script and memory map") for line in lines):
+        objs, syms = parse_gnu(lines)
+    else:
+        sys.exit("%s: not an armlink or GNU ld map file" % args.map)
+    if not objs:
+        sys.exit("%s: no object sizes found (armlink needs --info sizes, on by default in Keil)" % args.map)
+    report(objs, syms, args.top)
+
+
+if __name__ == "__main__":
+    main()
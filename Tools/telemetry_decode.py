@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Decode the telemetry stream (USART2 by default, TELEMETRY_UART in Core/Inc/user/telemetry.h) into CSV.
+
+Usage:
+    telemetry_decode.py capture.bin -o out.csv        # decode a raw capture
+    telemetry_decode.py --port COM5 -o out.csv        # live, needs pyserial
+
+ASCII command replies interleaved on the same port (TELEMETRY_UART set to uart1_drv) are skipped.
+"""
+import argparse
+import csv
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+FRAME_KEY = 0x01
+FRAME_DELTA = 0x02
+HEADER_LEN = 9
+
+# Must match telemetry_fields[] in Core/Src/user/telemetry.c
+FIELDS = [
+    ("robot_mod", 1), ("m1_dir", 1), ("m1_deg", 1), ("m1_pwm", 4),
+    ("m2_dir", 1), ("m2_deg", 1), ("m2_pwm", 4),
+    ("m3_dir", 1), ("m3_deg", 1), ("m3_pwm", 4),
+    ("car_dir", 1), ("car_pwm", 4),
+    ("hours", 1), ("minute", 1), ("second", 1),
+    ("led", 1), ("beep_ctrl", 1), ("beep_ms", 2),
+    ("ir_key", 1), ("ir_cnt", 1),
+]
+SNAPSHOT_LEN = sum(size for _, size in FIELDS)
+BITMAP_LEN = (SNAPSHOT_LEN + 7) // 8
+FMT = {1: "B", 2: "H", 4: "I"}
+
+
+def unpack(snapshot):
+    values, offset = [], 0
+    for _, size in FIELDS:
+        values.append(struct.unpack_from("<" + FMT[size], snapshot, offset)[0])
+        offset += size
+    return values
+
+
+class Decoder:
+    def __init__(self):
+        self.buf = bytearray()
+        self.snapshot = None
+        self.last_seq = None
+        self.lost = 0
+        self.bad = 0
+
+    def feed(self, data):
+        """Yield (tick, seq, kind, values) for every complete frame in data."""
+        self.buf += data
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                del self.buf[:-1]
+                return
+            del self.buf[:start]
+            if len(self.buf) < HEADER_LEN:
+                return
+            kind, seq, tick, plen = struct.unpack_from("<BBIB", self.buf, 2)
+            total = HEADER_LEN + plen + 1
+            if kind not in (FRAME_KEY, FRAME_DELTA) or plen > BITMAP_LEN + SNAPSHOT_LEN:
+                del self.buf[:1]
+                continue
+            if len(self.buf) < total:
+                return
+            frame = bytes(self.buf[:total])
+            if sum(frame[2:-1]) & 0xFF != frame[-1]:
+                self.bad += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:total]
+            payload = frame[HEADER_LEN:-1]
+            if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFF:
+                self.lost += (seq - self.last_seq - 1) & 0xFF
+                if kind == FRAME_DELTA:
+                    # A delta against a frame we never saw is meaningless; wait for the next keyframe.
+                    self.snapshot = None
+            self.last_seq = seq
+            if kind == FRAME_KEY:
+                if len(payload) != SNAPSHOT_LEN:
+                    self.bad += 1
+                    continue
+                self.snapshot = bytearray(payload)
+            else:
+                if self.snapshot is None:
+                    continue
+                bitmap, changed = payload[:BITMAP_LEN], iter(payload[BITMAP_LEN:])
+                for i in range(SNAPSHOT_LEN):
+                    if bitmap[i >> 3] & (1 << (i & 7)):
+                        self.snapshot[i] = next(changed)
+            yield tick, seq, kind, unpack(self.snapshot)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    ap.add_argument("--port", help="serial port to read live")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("-o", "--output", help="CSV output (default: stdout)")
+    args = ap.parse_args()
+
+    if args.port:
+        import serial  # pyserial
+        src = serial.Serial(args.port, args.baud, timeout=0.1)
+    elif args.capture:
+        src = open(args.capture, "rb")
+    else:
+        src = sys.stdin.buffer
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(["tick_ms", "seq", "frame"] + [name for name, _ in FIELDS])
+    dec = Decoder()
+    try:
+        while True:
+            data = src.read(256)
+            if not data:
+                if args.port:
+                    continue
+                break
+            for tick, seq, kind, values in dec.feed(data):
+                writer.writerow([tick, seq, "key" if kind == FRAME_KEY else "delta"] + values)
+            out.flush()
+    except KeyboardInterrupt:
+        pass
+    print("lost=%d bad=%d" % (dec.lost, dec.bad), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Convert a TRACE_DUMP capture (see Core/Src/user/trace.c) into Chrome/Perfetto trace JSON.
+
+Usage:
+    trace_to_perfetto.py dump.txt -o trace.json       # saved TRACE_DUMP output
+    trace_to_perfetto.py --port COM5 -o trace.json    # send TRACE_DUMP and read the reply, needs pyserial
+
+Open the result in https://ui.perfetto.dev or chrome://tracing. Tasks and
+interrupts each get their own track; queue/semaphore operations are instant
+events on the track of whoever performed them, and every object gets a
+depth counter track.
+"""
+import argparse
+import json
+import sys
+
+# Must match TRACE_EV_* in Core/Inc/user/trace.h
+EV_TASK_IN, EV_TASK_OUT = 1, 2
+EV_SEND, EV_RECV, EV_SEND_ISR, EV_RECV_ISR = 3, 4, 5, 6
+EV_BLOCK_SEND, EV_BLOCK_RECV, EV_FAIL = 7, 8, 9
+EV_ISR_ENTER, EV_ISR_EXIT = 10, 11
+
+# queueQUEUE_TYPE_* in FreeRTOS queue.h
+OBJ_TYPES = {0: "queue", 1: "mutex", 2: "counting_sem", 3: "binary_sem", 4: "recursive_mutex"}
+# Operation names per object kind: (send, receive)
+OPS = {"queue": ("send", "receive"), "mutex": ("give", "take"), "recursive_mutex": ("give", "take")}
+SEM_OPS = ("give", "take")
+
+# STM32F103xE IRQn values used by the trace hooks (stm32f1xx_it.c, remote.c)
+IRQ_NAMES = {
+    14: "DMA1_CH4 (USART1 TX)", 15: "DMA1_CH5 (USART1 RX)", 16: "DMA1_CH6 (USART2 RX)",
+    17: "DMA1_CH7 (USART2 TX)", 29: "TIM3 (time)", 30: "TIM4 (IR)", 37: "USART1", 38: "USART2",
+    46: "TIM8_CC (PWM)", 50: "TIM5 (delay)", 55: "TIM7 (ctrl)",
+}
+
+PID_TASKS, PID_IRQ, PID_OBJS = 1, 2, 3
+
+
+def parse_dump(lines):
+    """Return (hz, tasks{num: name}, objs{num: (type, name)}, records[(ts, ev, id, arg)])."""
+    hz, n, tasks, objs, records = None, None, {}, {}, []
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("TRACE "):
+            continue
+        parts = line.split()
+        if parts[1] == "DUMP":
+            fields = dict(p.split("=", 1) for p in parts[2:])
+            hz, n = int(fields["hz"]), int(fields["n"])
+            tasks, objs, records = {}, {}, []
+        elif parts[1] == "TASK" and len(parts) >= 4:
+            tasks[int(parts[2])] = " ".join(parts[3:])
+        elif parts[1] == "OBJ" and len(parts) >= 5:
+            kind = OBJ_TYPES.get(int(parts[3]), "queue")
+            name = " ".join(parts[4:])
+            objs[int(parts[2])] = (kind, "%s#%s" % (kind if name == "-" else name, parts[2]))
+        elif parts[1] == "D":
+            for word in parts[2:]:
+                records.append((int(word[0:8], 16), int(word[8:10], 16), int(word[10:12], 16), int(word[12:16], 16)))
+        elif parts[1] == "END":
+            break
+    if hz is None:
+        sys.exit("no TRACE DUMP header found")
+    return hz, tasks, objs, records[:n]
+
+
+def unwrap(records, hz):
+    """Turn 32-bit wrapping cycle stamps into microseconds from the earliest record.
+
+    Stamps are taken before the ring slot is claimed, so neighbours can be slightly out of
+    order; differences are interpreted as signed 32-bit values.
+    """
+    stamps, acc, prev = [], 0, None
+    for ts, _, _, _ in records:
+        if prev is not None:
+            delta = (ts - prev) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            acc += delta
+        prev = ts
+        stamps.append(acc)
+    base = min(stamps, default=0)
+    return [((t - base) * 1e6 / hz, ev, ident, arg) for t, (_, ev, ident, arg) in zip(stamps, records)]
+
+
+def convert(hz, tasks, objs, records):
+    events = []
+
+    def meta(pid, tid, kind, name):
+        events.append({"ph": "M", "pid": pid, "tid": tid, "name": kind, "args": {"name": name}})
+
+    meta(PID_TASKS, 0, "process_name", "Tasks")
+    meta(PID_IRQ, 0, "process_name", "Interrupts")
+    meta(PID_OBJS, 0, "process_name", "Queues/semaphores")
+    for num, name in tasks.items():
+        meta(PID_TASKS, num, "thread_name", "%s (%d)" % (name, num))
+
+    running, task_start = None, 0.0
+    isr_stack, isr_start = [], {}
+    seen_irq = set()
+    end = 0.0
+    for ts, ev, ident, arg in unwrap(records, hz):
+        end = ts
+        if ev == EV_TASK_IN:
+            if running is not None and running != ident:
+                events.append({"ph": "X", "pid": PID_TASKS, "tid": running, "ts": task_start,
+                               "dur": ts - task_start, "name": tasks.get(running, "task %d" % running)})
+            if running != ident:
+                running, task_start = ident, ts
+        elif ev == EV_TASK_OUT:
+            # The same task may be re-selected; the slice is closed on the next different TASK_IN.
+            pass
+        elif ev == EV_ISR_ENTER:
+            isr_stack.append(ident)
+            isr_start[ident] = ts
+            if ident not in seen_irq:
+                seen_irq.add(ident)
+                meta(PID_IRQ, ident, "thread_name", IRQ_NAMES.get(ident, "IRQ %d" % ident))
+        elif ev == EV_ISR_EXIT:
+            start = isr_start.pop(ident, None)
+            if start is not None:
+                events.append({"ph": "X", "pid": PID_IRQ, "tid": ident, "ts": start, "dur": ts - start,
+                               "name": IRQ_NAMES.get(ident, "IRQ %d" % ident)})
+            if ident in isr_stack:
+                isr_stack.remove(ident)
+        else:
+            kind, obj = objs.get(ident, ("queue", "obj#%d" % ident))
+            send, recv = OPS.get(kind, SEM_OPS)
+            name = {EV_SEND: send, EV_SEND_ISR: send + "_isr", EV_RECV: recv, EV_RECV_ISR: recv + "_isr",
+                    EV_BLOCK_SEND: "block_" + send, EV_BLOCK_RECV: "block_" + recv, EV_FAIL: "fail"}.get(ev)
+            if name is None:
+                continue
+            if isr_stack:
+                pid, tid = PID_IRQ, isr_stack[-1]
+            else:
+                pid, tid = PID_TASKS, running if running is not None else 0
+            events.append({"ph": "i", "s": "t", "pid": pid, "tid": tid, "ts": ts,
+                           "name": "%s %s" % (name, obj), "args": {"waiting_before": arg}})
+            # arg is the depth before the operation
+            depth = arg + (1 if ev in (EV_SEND, EV_SEND_ISR) else -1 if ev in (EV_RECV, EV_RECV_ISR) else 0)
+            events.append({"ph": "C", "pid": PID_OBJS, "ts": ts, "name": obj, "args": {"depth": max(depth, 0)}})
+    if running is not None:
+        events.append({"ph": "X", "pid": PID_TASKS, "tid": running, "ts": task_start, "dur": end - task_start,
+                       "name": tasks.get(running, "task %d" % running)})
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def read_port(port, baud, timeout):
+    import serial  # pyserial
+    import time
+    ser = serial.Serial(port, baud, timeout=0.1)
+    ser.reset_input_buffer()
+    ser.write(b"TRACE_DUMP\r\n")
+    lines, buf, deadline = [], bytearray(), time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        buf += ser.read(ser.in_waiting or 1)
+        while b"\r\n" in buf:
+            line, _, rest = bytes(buf).partition(b"\r\n")
+            buf = bytearray(rest)
+            text = line.decode("ascii", "replace")
+            lines.append(text)
+            if text.startswith("TRACE END"):
+                return lines
+            deadline = time.monotonic() + timeout
+    sys.exit("timed out waiting for TRACE END")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("dump", nargs="?", help="saved TRACE_DUMP output (default: stdin)")
+    ap.add_argument("--port", help="serial port: send TRACE_DUMP and read the reply")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--timeout", type=float, default=3.0, help="seconds of silence before giving up")
+    ap.add_argument("-o", "--output", help="JSON output (default: stdout)")
+    args = ap.parse_args()
+
+    if args.port:
+        lines = read_port(args.port, args.baud, args.timeout)
+    else:
+        lines = (open(args.dump, encoding="ascii", errors="replace") if args.dump else sys.stdin).read().splitlines()
+
+    hz, tasks, objs, records = parse_dump(lines)
+    trace = convert(hz, tasks, objs, records)
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out)
+    print("records=%d tasks=%d objs=%d span=%.3fms" % (len(records), len(tasks), len(objs),
+          unwrap(records, hz)[-1][0] / 1000.0 if records else 0.0), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Stream a command script to the board over USART1 with credit-based flow control.
+
+Usage:
+    uart_stream.py --port COM5 script.txt             # one command per line
+    uart_stream.py --port COM5 --window 8 script.txt
+
+The firmware answers every command with exactly one "\\r\\n"-terminated line, in
+order, so each reply returns one credit. Keeping at most --window commands
+unanswered (default UART1_FLOW_WINDOW = 16, see Core/Inc/user/myprintf.h) keeps
+the command queue from overflowing no matter how fast the link is. Run "FLOW"
+afterwards to confirm drop/ovr stayed at zero.
+
+Commands with multi-line replies would return too many credits and are rejected; they are
+listed in MULTI_LINE / MULTI_LINE_PREFIX below (and by --help), which must match the table in
+StartLEDProcessedTaskFunction (Core/Src/user/mytask.c). If TELEMETRY_UART is set to uart1_drv,
+stop the binary telemetry stream (TELEM_OFF) before streaming. Lines starting with "!" are
+unsolicited reports (e.g. stack watermark warnings) and are echoed without returning a credit.
+"""
+import argparse
+import sys
+import time
+
+MULTI_LINE = ("TELEM_STAT", "UART_STAT", "STATS", "STACK", "PERIODS", "TRACE_DUMP", "LAT", "POOL", "POOL_BENCH", "LOCKS", "RAMFUNC", "BOOT", "JOURNAL")
+# 带参数的多行应答命令（按前缀匹配）
+MULTI_LINE_PREFIX = ("BENCH",)
+ASYNC = b"!"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter,
+                                 epilog="multi-line replies (rejected): " +
+                                 ", ".join(MULTI_LINE + tuple(p + "*" for p in MULTI_LINE_PREFIX)))
+    ap.add_argument("script", nargs="?", help="command file (default: stdin)")
+    ap.add_argument("--port", required=True, help="serial port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--window", type=int, default=16, help="max unanswered commands")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait for a reply")
+    ap.add_argument("-q", "--quiet", action="store_true", help="do not echo replies")
+    args = ap.parse_args()
+
+    src = open(args.script) if args.script else sys.stdin
+    cmds = [line.strip() for line in src if line.strip() and not line.startswith("#")]
+    for cmd in cmds:
+        if cmd in MULTI_LINE or cmd.startswith(MULTI_LINE_PREFIX):
+            sys.exit("%s has a multi-line reply and cannot be streamed" % cmd)
+
+    import serial  # pyserial
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    port.reset_input_buffer()
+
+    sent = acked = 0
+    buf = bytearray()
+    start = last = time.monotonic()
+    while acked < len(cmds):
+        while sent < len(cmds) and sent - acked < args.window:
+            port.write(cmds[sent].encode("ascii") + b"\r\n")
+            sent += 1
+        buf += port.read(port.in_waiting or 1)
+        while b"\r\n" in buf:
+            line, _, buf = bytes(buf).partition(b"\r\n")
+            buf = bytearray(buf)
+            if line.startswith(ASYNC):
+                print(line.decode("ascii", "replace"), file=sys.stderr)
+                continue
+            acked += 1
+            last = time.monotonic()
+            if not args.quiet:
+                print(line.decode("ascii", "replace"))
+        if time.monotonic() - last > args.timeout:
+            sys.exit("timeout: %d sent, %d answered" % (sent, acked))
+
+    elapsed = time.monotonic() - start
+    print("%d commands in %.3fs (%.0f cmd/s, window %d)" % (len(cmds), elapsed, len(cmds) / elapsed, args.window),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
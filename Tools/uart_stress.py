@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Stress the USART1 command pipeline: pipelined commands, in-order replies, sustained rate.
+
+Usage:
+    uart_stress.py --port COM5                        # 5000 commands, window 16
+    uart_stress.py --port /tmp/ttyS1 --count 20000 --min-rate 500
+
+Sends a rotating mix of commands whose replies are known (LED_ON, LED_OFF, LED_AUTO and an
+unknown command), keeping at most --window of them unanswered (default UART1_FLOW_WINDOW = 16,
+see Core/Inc/user/myprintf.h). Every reply must be the expected line for the command in the
+same position; a missing, extra or reordered reply fails the run. Afterwards FLOW must show
+drop/ovr/err/trunc at zero.
+
+Prints commands per second and the reply latency (send to reply, including queueing inside
+the window). Exits non-zero on any mismatch, timeout, non-zero FLOW counter or a rate below
+--min-rate. Works on a real serial port or on the host simulation's USART1 pty
+(SIM_USART1_LINK, see README). If TELEMETRY_UART is set to uart1_drv, stop the binary telemetry
+stream (TELEM_OFF) first.
+"""
+import argparse
+import re
+import sys
+import time
+
+MIX = (
+    ("LED_ON", "Now LED ON"),
+    ("LED_OFF", "Now LED OFF"),
+    ("LED_AUTO", "Now LED AUTO"),
+    ("NOP", "Unknown CMD"),
+)
+ASYNC = b"!"
+
+
+def readline(port, buf, deadline):
+    """Next reply line (unsolicited "!" lines are echoed to stderr), None at the deadline."""
+    while True:
+        while b"\r\n" in buf:
+            line, _, rest = bytes(buf).partition(b"\r\n")
+            buf[:] = rest
+            if line.startswith(ASYNC):
+                print(line.decode("ascii", "replace"), file=sys.stderr)
+                continue
+            return line.decode("ascii", "replace")
+        if time.monotonic() > deadline:
+            return None
+        buf += port.read(port.in_waiting or 1)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", required=True, help="serial port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--count", type=int, default=5000, help="commands to send")
+    ap.add_argument("--window", type=int, default=16, help="max unanswered commands")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait for a reply")
+    ap.add_argument("--min-rate", type=float, default=0, help="fail below this many commands per second")
+    args = ap.parse_args()
+
+    import serial  # pyserial
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    port.reset_input_buffer()
+
+    sent_at = []
+    lat = []
+    buf = bytearray()
+    start = time.monotonic()
+    acked = 0
+    while acked < args.count:
+        while len(sent_at) < args.count and len(sent_at) - acked < args.window:
+            port.write(MIX[len(sent_at) % len(MIX)][0].encode("ascii") + b"\r\n")
+            sent_at.append(time.monotonic())
+        line = readline(port, buf, time.monotonic() + args.timeout)
+        if line is None:
+            sys.exit("timeout: %d sent, %d answered" % (len(sent_at), acked))
+        want = MIX[acked % len(MIX)][1]
+        if line != want:
+            sys.exit("reply %d to %s: got %r, want %r" % (acked, MIX[acked % len(MIX)][0], line, want))
+        lat.append(time.monotonic() - sent_at[acked])
+        acked += 1
+    elapsed = time.monotonic() - start
+
+    port.write(b"FLOW\r\n")
+    flow = readline(port, buf, time.monotonic() + args.timeout) or ""
+    print(flow)
+    counters = dict(re.findall(r"(drop|ovr|err|trunc)=(\d+)", flow))
+    lat.sort()
+    rate = args.count / elapsed
+    print("%d commands in %.3fs (%.0f cmd/s, window %d), latency p50=%.1fms p99=%.1fms max=%.1fms" %
+          (args.count, elapsed, rate, args.window, lat[len(lat) // 2] * 1e3, lat[len(lat) * 99 // 100] * 1e3,
+           lat[-1] * 1e3))
+    if len(counters) != 4 or any(v != "0" for v in counters.values()):
+        sys.exit("FLOW counters not zero")
+    if rate < args.min_rate:
+        sys.exit("%.0f cmd/s is below --min-rate %.0f" % (rate, args.min_rate))
+
+
+if __name__ == "__main__":
+    main()
@@ -65,7 +65,8 @@ Reset_Handler:
 /* Call the clock system initialization function.*/
     bl  SystemInit
 
-/* Copy the data segment initializers from flash to SRAM */
+/* Copy the data segment initializers from flash to SRAM
+   (this also copies the .ramfunc code placed inside .data by the linker script) */
   ldr r0, =_sdata
   ldr r1, =_edata
   ldr r2, =_sidata